@@ -0,0 +1,215 @@
+#include "aabb_tree.h"
+#include "body.h"
+#include "collision.h"
+#include "spatial_grid.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Compares the broad phases on a tankz-like scene of mixed-size bodies:
+    window-wide borders, hexagons, powerups and many small trajectory dots.
+    Each strategy finds the colliding pairs every tick, and all of them must
+    agree with the brute-force path of running find_collision on every pair.
+*/
+
+const vector_t BENCH_WINDOW = {.x = 1000, .y = 500};
+const double BENCH_BORDER_WIDTH = 10;
+const double BENCH_SPEED = 100;
+const double BENCH_DT = 0.01;
+const size_t BENCH_TICKS = 50;
+const size_t BENCH_SIZES[] = {100, 250, 500};
+const size_t BENCH_NUM_SIZES = sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0]);
+
+polygon_t *bench_regular_polygon(double radius, size_t sides) {
+  polygon_t *shape = polygon_init(sides);
+  for (size_t i = 0; i < sides; i++) {
+    double angle = 2 * M_PI * i / sides;
+    polygon_add(shape, (vector_t){radius * cos(angle), radius * sin(angle)});
+  }
+  return shape;
+}
+
+polygon_t *bench_rectangle(vector_t min, vector_t max) {
+  polygon_t *shape = polygon_init(4);
+  polygon_add(shape, min);
+  polygon_add(shape, (vector_t){max.x, min.y});
+  polygon_add(shape, max);
+  polygon_add(shape, (vector_t){min.x, max.y});
+  return shape;
+}
+
+double bench_random(double min, double max) {
+  return min + (double)rand() / RAND_MAX * (max - min);
+}
+
+/**
+ * Makes the 4 borders followed by num_bodies randomly placed moving bodies:
+ * mostly radius-1 dots, with some 5-unit powerups and 50-unit hexagons.
+ */
+body_t **make_bodies(size_t num_bodies) {
+  body_t **bodies = malloc(sizeof(body_t *) * (num_bodies + 4));
+  rgb_color_t color = {0, 0, 0};
+  double w = BENCH_WINDOW.x, h = BENCH_WINDOW.y, b = BENCH_BORDER_WIDTH;
+  bodies[0] = body_init_with_polygon(
+      bench_rectangle((vector_t){0, 0}, (vector_t){w, b}), INFINITY, color,
+      NULL, NULL);
+  bodies[1] = body_init_with_polygon(
+      bench_rectangle((vector_t){0, h - b}, (vector_t){w, h}), INFINITY, color,
+      NULL, NULL);
+  bodies[2] = body_init_with_polygon(
+      bench_rectangle((vector_t){0, 0}, (vector_t){b, h}), INFINITY, color,
+      NULL, NULL);
+  bodies[3] = body_init_with_polygon(
+      bench_rectangle((vector_t){w - b, 0}, (vector_t){w, h}), INFINITY, color,
+      NULL, NULL);
+  for (size_t i = 4; i < num_bodies + 4; i++) {
+    polygon_t *shape;
+    if (i % 20 == 0) {
+      shape = bench_regular_polygon(50, 6);
+    } else if (i % 5 == 0) {
+      shape = bench_regular_polygon(5, 12);
+    } else {
+      shape = bench_regular_polygon(1, 12);
+    }
+    body_t *body = body_init_with_polygon(shape, 1, color, NULL, NULL);
+    body_set_centroid(body, (vector_t){bench_random(0, w), bench_random(0, h)});
+    double angle = bench_random(0, 2 * M_PI);
+    body_set_velocity(body, vec_multiply(BENCH_SPEED,
+                                         (vector_t){cos(angle), sin(angle)}));
+    bodies[i] = body;
+  }
+  return bodies;
+}
+
+/**
+ * Moves the non-border bodies, bouncing them off the window's edges.
+ */
+void move_bodies(body_t **bodies, size_t num_bodies) {
+  for (size_t i = 4; i < num_bodies; i++) {
+    body_tick(bodies[i], BENCH_DT);
+    vector_t centroid = body_get_centroid(bodies[i]);
+    vector_t velocity = body_get_velocity(bodies[i]);
+    if (centroid.x < 0 || centroid.x > BENCH_WINDOW.x) {
+      velocity.x = -velocity.x;
+    }
+    if (centroid.y < 0 || centroid.y > BENCH_WINDOW.y) {
+      velocity.y = -velocity.y;
+    }
+    body_set_velocity(bodies[i], velocity);
+  }
+}
+
+bool bodies_collide(body_t *body1, body_t *body2) {
+  polygon_view_t shape1 = body_view_shape(body1);
+  polygon_view_t shape2 = body_view_shape(body2);
+  return find_vertices_collision(shape1.vertices, shape1.size, shape2.vertices,
+                                 shape2.size)
+      .collided;
+}
+
+/**
+ * Counts the candidate pairs a broad phase reports and how many collide.
+ */
+typedef struct {
+  body_t **bodies;
+  size_t candidates;
+  size_t collisions;
+} pair_count_t;
+
+void count_grid_pair(size_t id1, size_t id2, void *aux) {
+  pair_count_t *count = aux;
+  count->candidates++;
+  count->collisions += bodies_collide(count->bodies[id1], count->bodies[id2]);
+}
+
+void count_tree_pair(void *data1, void *data2, void *aux) {
+  pair_count_t *count = aux;
+  count->candidates++;
+  count->collisions += bodies_collide(data1, data2);
+}
+
+typedef enum { BRUTE_FORCE, GRID, TREE } strategy_t;
+
+const char *STRATEGY_NAMES[] = {"brute force", "grid", "aabb tree"};
+
+/**
+ * Runs a strategy for BENCH_TICKS ticks on a fresh copy of the scene.
+ *
+ * @return the total number of collisions found
+ */
+size_t run_strategy(strategy_t strategy, size_t num_bodies, double *seconds,
+                    size_t *candidates) {
+  srand(num_bodies);
+  size_t total = num_bodies + 4;
+  body_t **bodies = make_bodies(num_bodies);
+  spatial_grid_t *grid = spatial_grid_init(10);
+  aabb_tree_t *tree = aabb_tree_init(2);
+  size_t *proxies = malloc(sizeof(size_t) * total);
+  if (strategy == TREE) {
+    for (size_t i = 0; i < total; i++) {
+      proxies[i] = aabb_tree_insert(tree, body_get_bounds(bodies[i]), bodies[i]);
+    }
+  }
+
+  pair_count_t count = {bodies, 0, 0};
+  clock_t start = clock();
+  for (size_t tick = 0; tick < BENCH_TICKS; tick++) {
+    move_bodies(bodies, total);
+    if (strategy == BRUTE_FORCE) {
+      for (size_t i = 0; i < total; i++) {
+        for (size_t j = i + 1; j < total; j++) {
+          count.candidates++;
+          count.collisions += bodies_collide(bodies[i], bodies[j]);
+        }
+      }
+    } else if (strategy == GRID) {
+      spatial_grid_clear(grid);
+      for (size_t i = 0; i < total; i++) {
+        spatial_grid_insert(grid, i, body_get_bounds(bodies[i]));
+      }
+      spatial_grid_pairs(grid, count_grid_pair, &count);
+    } else {
+      for (size_t i = 0; i < total; i++) {
+        aabb_tree_move(tree, proxies[i], body_get_bounds(bodies[i]));
+      }
+      aabb_tree_pairs(tree, count_tree_pair, &count);
+    }
+  }
+  *seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  *candidates = count.candidates;
+
+  for (size_t i = 0; i < total; i++) {
+    body_free(bodies[i]);
+  }
+  free(bodies);
+  free(proxies);
+  spatial_grid_free(grid);
+  aabb_tree_free(tree);
+  return count.collisions;
+}
+
+int main() {
+  printf("%zu ticks per run\n", BENCH_TICKS);
+  printf("%6s  %-12s %10s %12s %10s\n", "bodies", "strategy", "seconds",
+         "candidates", "collisions");
+  for (size_t i = 0; i < BENCH_NUM_SIZES; i++) {
+    size_t expected = 0;
+    for (strategy_t strategy = BRUTE_FORCE; strategy <= TREE; strategy++) {
+      double seconds;
+      size_t candidates;
+      size_t collisions =
+          run_strategy(strategy, BENCH_SIZES[i], &seconds, &candidates);
+      if (strategy == BRUTE_FORCE) {
+        expected = collisions;
+      }
+      // Every broad phase must find exactly the brute-force collisions
+      assert(collisions == expected);
+      printf("%6zu  %-12s %10.4f %12zu %10zu\n", BENCH_SIZES[i],
+             STRATEGY_NAMES[strategy], seconds, candidates, collisions);
+    }
+  }
+}
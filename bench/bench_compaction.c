@@ -0,0 +1,102 @@
+#include "forces.h"
+#include "list.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures removing many elements at once, e.g. a shot clearing a field of
+    tiles or a frame's worth of trajectory dots being reaped.
+    Compares removing marked elements one at a time with list_remove(), which
+    shifts the tail of the list every time, against a single list_filter()
+    pass, then times a scene_tick() that reaps most of a scene.
+*/
+
+const size_t COMPACTION_SIZES[] = {1000, 10000, 50000};
+const size_t COMPACTION_NUM_SIZES =
+    sizeof(COMPACTION_SIZES) / sizeof(COMPACTION_SIZES[0]);
+
+bool keep_odd(void *value, void *aux) { return *(size_t *)value % 2 == 1; }
+
+list_t *make_numbers(size_t size) {
+  list_t *numbers = list_init(size, free);
+  for (size_t i = 0; i < size; i++) {
+    size_t *number = malloc(sizeof(size_t));
+    *number = i;
+    list_add(numbers, number);
+  }
+  return numbers;
+}
+
+double time_remove_loop(size_t size) {
+  list_t *numbers = make_numbers(size);
+  clock_t start = clock();
+  size_t i = 0;
+  while (i < list_size(numbers)) {
+    size_t *number = list_get(numbers, i);
+    if (!keep_odd(number, NULL)) {
+      free(list_remove(numbers, i));
+    } else {
+      i++;
+    }
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  list_free(numbers);
+  return seconds;
+}
+
+double time_filter(size_t size) {
+  list_t *numbers = make_numbers(size);
+  clock_t start = clock();
+  list_filter(numbers, keep_odd, NULL);
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  list_free(numbers);
+  return seconds;
+}
+
+list_t *make_square() {
+  list_t *shape = list_init(4, free);
+  vector_t corners[] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = corners[i];
+    list_add(shape, v);
+  }
+  return shape;
+}
+
+/**
+ * Times the scene_tick() that reaps all but every tenth body of a scene,
+ * along with the drag force on each removed body.
+ */
+double time_scene_reap(size_t size) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = body_init(make_square(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){2 * i, 0});
+    scene_add_body(scene, body);
+    create_drag(scene, 1, body);
+  }
+  for (size_t i = 0; i < size; i++) {
+    if (i % 10 != 0) {
+      scene_remove_body(scene, i);
+    }
+  }
+  clock_t start = clock();
+  scene_tick(scene, 0.01);
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  scene_free(scene);
+  return seconds;
+}
+
+int main() {
+  printf("%8s %14s %14s %14s\n", "elements", "remove loop", "list_filter",
+         "scene reap");
+  for (size_t i = 0; i < COMPACTION_NUM_SIZES; i++) {
+    size_t size = COMPACTION_SIZES[i];
+    printf("%8zu %14.6f %14.6f %14.6f\n", size, time_remove_loop(size),
+           time_filter(size), time_scene_reap(size));
+  }
+}
@@ -0,0 +1,67 @@
+#include "body.h"
+#include "forces.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures N-body gravity, e.g. a galaxy of particles.
+    Compares create_newtonian_gravity() on every pair of bodies with a single
+    create_gravity_field() force at two opening angles.
+    Pairwise gravity is skipped for large scenes, where it has too many forces.
+*/
+
+const size_t GRAVITY_SIZES[] = {100, 1000, 10000};
+const size_t GRAVITY_NUM_SIZES =
+    sizeof(GRAVITY_SIZES) / sizeof(GRAVITY_SIZES[0]);
+const size_t GRAVITY_MAX_PAIRWISE = 1000;
+const size_t GRAVITY_TICKS = 10;
+const double GRAVITY_G = 1;
+
+/**
+ * Times ticking a scene of randomly placed bodies, using pairwise gravity
+ * if theta is negative and a gravity field otherwise.
+ */
+double time_gravity(size_t size, double theta) {
+  srand(size);
+  scene_t *scene = scene_init();
+  if (theta >= 0) {
+    create_gravity_field(scene, GRAVITY_G, theta);
+  }
+  for (size_t i = 0; i < size; i++) {
+    vector_t centroid = {rand() % 100000 / 10.0, rand() % 100000 / 10.0};
+    body_t *body =
+        body_init_circle(1, centroid, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+    scene_add_body(scene, body);
+    if (theta < 0) {
+      for (size_t j = 0; j < i; j++) {
+        create_newtonian_gravity(scene, GRAVITY_G, body,
+                                 scene_get_body(scene, j));
+      }
+    }
+  }
+
+  clock_t start = clock();
+  for (size_t i = 0; i < GRAVITY_TICKS; i++) {
+    scene_tick(scene, 0.01);
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  scene_free(scene);
+  return seconds;
+}
+
+int main() {
+  printf("%8s %14s %14s %14s\n", "bodies", "pairwise", "theta = 0.5",
+         "theta = 1");
+  for (size_t i = 0; i < GRAVITY_NUM_SIZES; i++) {
+    size_t size = GRAVITY_SIZES[i];
+    if (size <= GRAVITY_MAX_PAIRWISE) {
+      printf("%8zu %14.6f", size, time_gravity(size, -1));
+    } else {
+      printf("%8zu %14s", size, "-");
+    }
+    printf(" %14.6f %14.6f\n", time_gravity(size, 0.5), time_gravity(size, 1));
+  }
+}
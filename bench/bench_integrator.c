@@ -0,0 +1,57 @@
+#include "body.h"
+#include "forces.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures integrating a large scene, e.g. a screen full of particles.
+    Each tick applies gravity to every body and then integrates it, either
+    by calling body_tick() on each body or, with scene_enable_body_store(),
+    in one pass over the store's parallel arrays.
+*/
+
+const size_t INTEGRATOR_SIZES[] = {1000, 10000, 100000};
+const size_t INTEGRATOR_NUM_SIZES =
+    sizeof(INTEGRATOR_SIZES) / sizeof(INTEGRATOR_SIZES[0]);
+const size_t INTEGRATOR_TICKS = 100;
+
+void apply_gravity(void *scene) {
+  size_t num_bodies = scene_bodies(scene);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_add_force(scene_get_body(scene, i), (vector_t){0, -9.8});
+  }
+}
+
+double time_ticks(size_t size, bool use_store) {
+  scene_t *scene = scene_init();
+  if (use_store) {
+    scene_enable_body_store(scene);
+  }
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = body_init_circle(1, (vector_t){i, 0}, 1,
+                                    (rgb_color_t){0, 0, 0}, NULL, NULL);
+    body_set_velocity(body, (vector_t){1, i % 7});
+    scene_add_body(scene, body);
+  }
+  scene_add_force_creator(scene, apply_gravity, scene, NULL);
+
+  clock_t start = clock();
+  for (size_t i = 0; i < INTEGRATOR_TICKS; i++) {
+    scene_tick(scene, 0.01);
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  scene_free(scene);
+  return seconds;
+}
+
+int main() {
+  printf("%8s %14s %14s\n", "bodies", "body_tick", "body store");
+  for (size_t i = 0; i < INTEGRATOR_NUM_SIZES; i++) {
+    size_t size = INTEGRATOR_SIZES[i];
+    printf("%8zu %14.6f %14.6f\n", size, time_ticks(size, false),
+           time_ticks(size, true));
+  }
+}
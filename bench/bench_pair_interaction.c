@@ -0,0 +1,95 @@
+#include "body.h"
+#include "forces.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures short-range forces between many particles, e.g. a fluid.
+    Compares one force creator checking every pair of bodies each tick with
+    create_pair_interaction(), which only checks pairs in its Verlet list.
+    Checking every pair is skipped for large scenes.
+*/
+
+const size_t PAIRS_SIZES[] = {1000, 10000, 100000};
+const size_t PAIRS_NUM_SIZES = sizeof(PAIRS_SIZES) / sizeof(PAIRS_SIZES[0]);
+const size_t PAIRS_MAX_ALL = 10000;
+const size_t PAIRS_TICKS = 10;
+const double PAIRS_CUTOFF = 3;
+const double PAIRS_SKIN = 1;
+
+vector_t repel(body_t *body1, body_t *body2, vector_t offset, void *aux) {
+  double dist = vec_norm(offset);
+  if (dist == 0) {
+    return VEC_ZERO;
+  }
+  return vec_multiply(-(PAIRS_CUTOFF - dist) / dist, offset);
+}
+
+void repel_all_pairs(void *scene) {
+  size_t num_bodies = scene_bodies(scene);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body1 = scene_get_body(scene, i);
+    for (size_t j = i + 1; j < num_bodies; j++) {
+      body_t *body2 = scene_get_body(scene, j);
+      vector_t offset =
+          vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+      if (vec_norm(offset) < PAIRS_CUTOFF) {
+        vector_t force = repel(body1, body2, offset, NULL);
+        body_add_force(body1, force);
+        body_add_force(body2, vec_negate(force));
+      }
+    }
+  }
+}
+
+/**
+ * Times ticking a scene of particles at a density of about one per 4 square
+ * units, with every pair checked or with a Verlet list.
+ */
+double time_pairs(size_t size, bool use_verlet) {
+  srand(size);
+  scene_t *scene = scene_init();
+  list_t *group = list_init(size, NULL);
+  int side = (int)sqrt(size * 4.0);
+  for (size_t i = 0; i < size; i++) {
+    vector_t centroid = {rand() % (side * 10) / 10.0,
+                         rand() % (side * 10) / 10.0};
+    body_t *body =
+        body_init_circle(1, centroid, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+    body_set_velocity(body, (vector_t){rand() % 5 - 2, rand() % 5 - 2});
+    scene_add_body(scene, body);
+    list_add(group, body);
+  }
+  if (use_verlet) {
+    create_pair_interaction(scene, group, PAIRS_CUTOFF, PAIRS_SKIN, repel,
+                            NULL, NULL);
+  } else {
+    list_free(group);
+    scene_add_bodies_force_creator(scene, repel_all_pairs, scene, NULL, NULL);
+  }
+
+  clock_t start = clock();
+  for (size_t i = 0; i < PAIRS_TICKS; i++) {
+    scene_tick(scene, 0.01);
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  scene_free(scene);
+  return seconds;
+}
+
+int main() {
+  printf("%8s %14s %14s\n", "bodies", "all pairs", "verlet list");
+  for (size_t i = 0; i < PAIRS_NUM_SIZES; i++) {
+    size_t size = PAIRS_SIZES[i];
+    if (size <= PAIRS_MAX_ALL) {
+      printf("%8zu %14.6f", size, time_pairs(size, false));
+    } else {
+      printf("%8zu %14s", size, "-");
+    }
+    printf(" %14.6f\n", time_pairs(size, true));
+  }
+}
@@ -0,0 +1,62 @@
+#include "forces.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures ticking a large scene on several threads, e.g. a soft body or a
+    cloth made of many springs.
+    Each body hangs from its neighbor by a spring and feels drag, and the
+    scene is ticked with different numbers of threads.
+    Times are wall-clock, since CPU time adds up across threads.
+*/
+
+const size_t PARALLEL_BODIES = 100000;
+const size_t PARALLEL_TICKS = 20;
+const size_t PARALLEL_THREADS[] = {1, 2, 4, 8};
+const size_t PARALLEL_NUM_THREADS =
+    sizeof(PARALLEL_THREADS) / sizeof(PARALLEL_THREADS[0]);
+
+double wall_seconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+double time_ticks(size_t threads, bool use_store) {
+  scene_t *scene = scene_init();
+  scene_set_threads(scene, threads);
+  if (use_store) {
+    scene_enable_body_store(scene);
+  }
+  for (size_t i = 0; i < PARALLEL_BODIES; i++) {
+    body_t *body = body_init_circle(1, (vector_t){3 * i, 0}, 1,
+                                    (rgb_color_t){0, 0, 0}, NULL, NULL);
+    scene_add_body(scene, body);
+    create_drag(scene, 0.1, body);
+    if (i > 0) {
+      create_spring(scene, 2, scene_get_body(scene, i - 1), body);
+    }
+  }
+  // The first tick builds the batches of forces
+  scene_tick(scene, 0.01);
+
+  double start = wall_seconds();
+  for (size_t i = 0; i < PARALLEL_TICKS; i++) {
+    scene_tick(scene, 0.01);
+  }
+  double seconds = wall_seconds() - start;
+  scene_free(scene);
+  return seconds;
+}
+
+int main() {
+  printf("%8s %14s %14s\n", "threads", "bodies", "body store");
+  for (size_t i = 0; i < PARALLEL_NUM_THREADS; i++) {
+    size_t threads = PARALLEL_THREADS[i];
+    printf("%8zu %14.6f %14.6f\n", threads, time_ticks(threads, false),
+           time_ticks(threads, true));
+  }
+}
@@ -0,0 +1,106 @@
+#include "forces.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures whether a scene can be snapshotted every tick, e.g. to keep a
+    ring buffer of the last second for rollback.
+    Each scene is a field of drifting circles with drag, checked for
+    collisions by a grid. Every tick one circle is removed and another
+    added, like a shell replacing a destroyed tile, so restoring has bodies
+    to bring back and to drop. Times an average scene_tick(),
+    scene_snapshot() into a ring of snapshots, and scene_restore() from the
+    oldest one.
+*/
+
+const size_t SNAPSHOT_SIZES[] = {1000, 10000, 50000};
+const size_t SNAPSHOT_NUM_SIZES =
+    sizeof(SNAPSHOT_SIZES) / sizeof(SNAPSHOT_SIZES[0]);
+const size_t SNAPSHOT_RING = 60;
+const size_t SNAPSHOT_TICKS = 120;
+const double SNAPSHOT_DT = 0.01;
+
+void count_contacts(body_t *body1, body_t *body2, collision_event_t event,
+                    vector_t axis, void *aux) {
+  (*(size_t *)aux)++;
+}
+
+/**
+ * Adds the i-th circle of a field side circles wide.
+ */
+void add_snapshot_circle(scene_t *scene, size_t i, size_t side) {
+  vector_t center = {3.0 * (i % side), 3.0 * (i / side)};
+  body_t *body =
+      body_init_circle(1, center, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_set_velocity(body, (vector_t){(double)(i % 7) - 3,
+                                     (double)(i % 5) - 2});
+  body_set_collision_filter(body, 1, 1);
+  scene_add_body(scene, body);
+}
+
+size_t snapshot_side(size_t size) {
+  size_t side = 1;
+  while (side * side < size) {
+    side++;
+  }
+  return side;
+}
+
+scene_t *make_snapshot_scene(size_t size, size_t *contacts) {
+  scene_t *scene = scene_init();
+  scene_enable_grid(scene, 4);
+  size_t side = snapshot_side(size);
+  for (size_t i = 0; i < size; i++) {
+    add_snapshot_circle(scene, i, side);
+  }
+  create_field_drag(scene, 0.1, 0, 0);
+  scene_add_collision_event_handler(scene, 1, 1,
+                                    COLLISION_BEGIN | COLLISION_PERSIST,
+                                    count_contacts, contacts, NULL);
+  return scene;
+}
+
+void time_snapshots(size_t size) {
+  size_t contacts = 0;
+  scene_t *scene = make_snapshot_scene(size, &contacts);
+  scene_snapshot_t *ring[SNAPSHOT_RING];
+  for (size_t i = 0; i < SNAPSHOT_RING; i++) {
+    ring[i] = scene_snapshot_init(scene);
+  }
+
+  size_t side = snapshot_side(size);
+  double tick_seconds = 0;
+  double snapshot_seconds = 0;
+  for (size_t i = 0; i < SNAPSHOT_TICKS; i++) {
+    scene_remove_body(scene, (i * 7919) % size);
+    add_snapshot_circle(scene, i, side);
+    clock_t start = clock();
+    scene_tick(scene, SNAPSHOT_DT);
+    tick_seconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    scene_snapshot(scene, ring[i % SNAPSHOT_RING]);
+    snapshot_seconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+  }
+
+  // The oldest snapshot in the ring is the one after the newest
+  clock_t start = clock();
+  scene_restore(scene, ring[SNAPSHOT_TICKS % SNAPSHOT_RING]);
+  double restore_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%8zu %14.6f %14.6f %14.6f\n", size, tick_seconds / SNAPSHOT_TICKS,
+         snapshot_seconds / SNAPSHOT_TICKS, restore_seconds);
+  for (size_t i = 0; i < SNAPSHOT_RING; i++) {
+    scene_snapshot_free(ring[i]);
+  }
+  scene_free(scene);
+}
+
+int main() {
+  printf("%8s %14s %14s %14s\n", "bodies", "tick", "snapshot", "restore");
+  for (size_t i = 0; i < SNAPSHOT_NUM_SIZES; i++) {
+    time_snapshots(SNAPSHOT_SIZES[i]);
+  }
+}
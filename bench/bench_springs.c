@@ -0,0 +1,72 @@
+#include "body.h"
+#include "forces.h"
+#include "scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Measures a cloth: a square grid of bodies with a spring to each
+    horizontal and vertical neighbor. Compares a create_spring() force per
+    spring with one spring network, using either solver.
+*/
+
+const size_t SPRINGS_SIDES[] = {32, 100, 316};
+const size_t SPRINGS_NUM_SIDES =
+    sizeof(SPRINGS_SIDES) / sizeof(SPRINGS_SIDES[0]);
+const size_t SPRINGS_TICKS = 100;
+const double SPRINGS_K = 100;
+
+typedef enum { USE_CREATE_SPRING, USE_EXPLICIT, USE_IMPLICIT } spring_mode_t;
+
+double time_cloth(size_t side, spring_mode_t mode) {
+  scene_t *scene = scene_init();
+  list_t *group = list_init(side * side, NULL);
+  for (size_t i = 0; i < side * side; i++) {
+    vector_t centroid = {i % side, i / side + (i % 7) * 0.01};
+    body_t *body =
+        body_init_circle(0.1, centroid, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+    scene_add_body(scene, body);
+    list_add(group, body);
+  }
+  spring_network_t *network = NULL;
+  if (mode == USE_CREATE_SPRING) {
+    list_free(group);
+  } else {
+    network = create_spring_network(scene, group, mode == USE_IMPLICIT);
+  }
+  for (size_t i = 0; i < side * side; i++) {
+    size_t neighbors[] = {i % side + 1 < side ? i + 1 : i, i + side};
+    for (size_t j = 0; j < 2; j++) {
+      if (neighbors[j] == i || neighbors[j] >= side * side) {
+        continue;
+      }
+      if (network == NULL) {
+        create_spring(scene, SPRINGS_K, scene_get_body(scene, i),
+                      scene_get_body(scene, neighbors[j]));
+      } else {
+        spring_network_add(network, i, neighbors[j], SPRINGS_K, 1, 0);
+      }
+    }
+  }
+
+  clock_t start = clock();
+  for (size_t i = 0; i < SPRINGS_TICKS; i++) {
+    scene_tick(scene, 0.001);
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  scene_free(scene);
+  return seconds;
+}
+
+int main() {
+  printf("%8s %14s %14s %14s\n", "bodies", "create_spring", "explicit",
+         "implicit");
+  for (size_t i = 0; i < SPRINGS_NUM_SIDES; i++) {
+    size_t side = SPRINGS_SIDES[i];
+    printf("%8zu %14.6f %14.6f %14.6f\n", side * side,
+           time_cloth(side, USE_CREATE_SPRING), time_cloth(side, USE_EXPLICIT),
+           time_cloth(side, USE_IMPLICIT));
+  }
+}
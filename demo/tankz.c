@@ -2,6 +2,8 @@
 #include "forces.h"
 #include "list.h"
 #include "player.h"
+#include "polygon.h"
+#include "rng.h"
 #include "scene.h"
 #include "sdl_wrapper.h"
 #include "state.h"
@@ -25,7 +27,12 @@ const vector_t CENTER = {.x = 500, .y = 250};
 
 // General constants
 const size_t ARBITRARY_MASS = 1;
-const size_t CIRCLE_POINTS = 40;
+
+// Physics timing constants
+const double PHYSICS_STEP = 1.0 / 120;
+const size_t MAX_PHYSICS_STEPS = 8;
+const double SLEEP_SPEED = 1;
+const double SLEEP_DELAY = 0.5;
 
 // Landscape constants
 const double HEXAGON_RADIUS = 50;
@@ -71,8 +78,19 @@ const vector_t HEALTH_BAR_1_POS = {30, 30};
 const vector_t HEALTH_BAR_2_POS = {870, 30};
 const rgb_color_t HEALTH_BAR_COLOR = {1, 0.75, 0.8};
 
+// Collision categories (see body_set_collision_filter())
+const uint32_t PLAYER_CATEGORY = 1 << 0;
+const uint32_t SHOT_CATEGORY = 1 << 1;
+const uint32_t LANDSCAPE_CATEGORY = 1 << 2;
+const uint32_t POWERUP_CATEGORY = 1 << 3;
+
 struct state {
   scene_t *scene;
+  body_handle_t players[2];
+  // The landscape colors, from darkest to lightest
+  list_t *landscape_colors;
+  // Draws the game's random numbers; the scene is seeded with the same seed
+  rng_t rng;
   double powerup_spawn_delay;
   size_t active_player;
   vector_t aim_center;
@@ -108,11 +126,13 @@ typedef struct {
   body_type_t type;
   size_t health;
   powerup_type_t powerup;
+  // The player who fired a shot
+  size_t owner;
 } body_info_t;
 
 /**
  * Creates body info based on given body type
- * To be passed to body_init_with_info with free as its freer.
+ * To be passed to body_init_with_polygon with free as its freer.
  */
 body_info_t *create_general_info(body_type_t body_type) {
   body_info_t *info = malloc(sizeof(body_info_t));
@@ -122,7 +142,7 @@ body_info_t *create_general_info(body_type_t body_type) {
 
 /**
  * Creates Player body info based on given health
- * To be passed to body_init_with_info with free as its freer.
+ * To be passed to body_init_with_polygon with free as its freer.
  */
 body_info_t *create_player_info(size_t health) {
   body_info_t *info = malloc(sizeof(body_info_t));
@@ -133,7 +153,7 @@ body_info_t *create_player_info(size_t health) {
 
 /**
  * Creates Powerup body info based on given powerup type.
- * To be passed to body_init_with_info with free as its freer.
+ * To be passed to body_init_with_polygon with free as its freer.
  */
 body_info_t *create_powerup_info(powerup_type_t powerup_type,
                                  body_type_t body_type) {
@@ -144,57 +164,21 @@ body_info_t *create_powerup_info(powerup_type_t powerup_type,
 }
 
 /**
- * Generates Circle vertices list given radius of Circle and center coordinates
- * (vector_t) of Circle.
- */
-list_t *make_circle(double radius, vector_t center) {
-  list_t *circle = list_init(CIRCLE_POINTS, free);
-  double arc_angle = TWO_PI / CIRCLE_POINTS;
-  assert(circle != NULL);
-
-  for (size_t i = 0; i < CIRCLE_POINTS; ++i) {
-    // Calculate polar coordinates relative to center
-    double angle = i * arc_angle;
-
-    // Calculate cartesian coordinates relative to (0, 0)
-    double x = cos(angle) * radius + center.x;
-    double y = sin(angle) * radius + center.y;
-
-    // Create and add vertex
-    vector_t *vertex = malloc(sizeof(vector_t));
-    vertex->x = x;
-    vertex->y = y;
-    list_add(circle, vertex);
-  }
-
-  return circle;
-}
-
-/**
- * Generates Rectangle vertices list given length and height of Rectangle,
+ * Generates Rectangle vertices polygon given length and height of Rectangle,
  * and center coordinates (vector_t) of Rectangle.
- * Returns list_t of vertices of Rectangle.
+ * Returns polygon_t of vertices of Rectangle.
  */
-list_t *make_rectangle(double length, double height, vector_t center) {
-  vector_t *bl = malloc(sizeof(vector_t));
-  vector_t *br = malloc(sizeof(vector_t));
-  vector_t *tr = malloc(sizeof(vector_t));
-  vector_t *tl = malloc(sizeof(vector_t));
-
+polygon_t *make_rectangle(double length, double height, vector_t center) {
   vector_t tr_disp = {length / 2, height / 2};
   vector_t tl_disp = {-1 * length / 2, height / 2};
-  *bl = (vector_t)vec_subtract(center, tr_disp);
-  *br = (vector_t)vec_subtract(center, tl_disp);
-  *tr = (vector_t)vec_add(center, tr_disp);
-  *tl = (vector_t)vec_add(center, tl_disp);
 
-  list_t *vertices = list_init(4, free);
+  polygon_t *vertices = polygon_init(4);
   assert(vertices != NULL);
 
-  list_add(vertices, bl);
-  list_add(vertices, br);
-  list_add(vertices, tr);
-  list_add(vertices, tl);
+  polygon_add(vertices, vec_subtract(center, tr_disp));
+  polygon_add(vertices, vec_subtract(center, tl_disp));
+  polygon_add(vertices, vec_add(center, tr_disp));
+  polygon_add(vertices, vec_add(center, tl_disp));
 
   return vertices;
 }
@@ -203,9 +187,9 @@ list_t *make_rectangle(double length, double height, vector_t center) {
  * Returns a hexagon. Relative to the center, vertices are spaced at equal
  * angles.
  */
-list_t *make_hexagon(double radius, vector_t center) {
+polygon_t *make_hexagon(double radius, vector_t center) {
   double vertex_angle = TWO_PI / HEXAGON_POINTS;
-  list_t *vertices = list_init(HEXAGON_POINTS, free);
+  polygon_t *vertices = polygon_init(HEXAGON_POINTS);
   assert(vertices != NULL);
 
   for (size_t i = 0; i < HEXAGON_POINTS; ++i) {
@@ -216,11 +200,8 @@ list_t *make_hexagon(double radius, vector_t center) {
     double x = cos(angle) * radius + center.x;
     double y = sin(angle) * radius + center.y;
 
-    // Create and add vertex
-    vector_t *vertex = malloc(sizeof(vector_t));
-    vertex->x = x;
-    vertex->y = y;
-    list_add(vertices, vertex);
+    // Add vertex
+    polygon_add(vertices, (vector_t){x, y});
   }
   return vertices;
 }
@@ -241,6 +222,15 @@ list_t *get_bodies_by_type(state_t *state, body_type_t searching) {
   return bodies;
 }
 
+/**
+ * Returns the given player's body (0 for player 1, 1 for player 2).
+ */
+body_t *get_player(state_t *state, size_t player) {
+  body_t *body = scene_get_body_by_handle(state->scene, state->players[player]);
+  assert(body != NULL);
+  return body;
+}
+
 /**
  * Returns whether two colors are equal.
  */
@@ -278,9 +268,9 @@ list_t *landscape_colors_list() {
  */
 void create_shield(scene_t *scene, body_t *player) {
   vector_t center = body_get_centroid(player);
-  list_t *vertices = make_circle(SHIELD_RADIUS, center);
-  body_t *sheild = body_init_with_info(vertices, ARBITRARY_MASS, SHIELD_COLOR,
-                                       create_general_info(SHIELD_BODY), free);
+  body_t *sheild =
+      body_init_circle(SHIELD_RADIUS, center, ARBITRARY_MASS, SHIELD_COLOR,
+                       create_general_info(SHIELD_BODY), free);
   scene_add_body(scene, sheild);
 }
 
@@ -318,10 +308,12 @@ void handle_player_health_display(state_t *state, body_t *player,
   for (size_t i = num_chunks; i < health; ++i) {
     vector_t chunk_center = {health_bar_pos.x + chunk_length * i,
                              health_bar_pos.y};
-    list_t *chunk_verts =
+    polygon_t *chunk_verts =
         make_rectangle(chunk_length, HEALTH_BAR_HEIGHT, chunk_center);
-    body_t *chunk = body_init_with_info(chunk_verts, INFINITY, HEALTH_BAR_COLOR,
-                                        create_general_info(health_type), free);
+    body_t *chunk =
+        body_init_with_polygon(chunk_verts, INFINITY, HEALTH_BAR_COLOR,
+                               create_general_info(health_type), free);
+    body_set_kind(chunk, BODY_STATIC);
     scene_add_body(state->scene, chunk);
   }
 }
@@ -330,18 +322,32 @@ void handle_player_health_display(state_t *state, body_t *player,
  * Updates health bars for both players.
  */
 void handle_health_display(state_t *state) {
-  list_t *players = get_bodies_by_type(state, PLAYER);
-  handle_player_health_display(state, list_get(players, 0), HEALTH1,
+  handle_player_health_display(state, get_player(state, 0), HEALTH1,
                                HEALTH_BAR_1_POS);
-  handle_player_health_display(state, list_get(players, 1), HEALTH2,
+  handle_player_health_display(state, get_player(state, 1), HEALTH2,
                                HEALTH_BAR_2_POS);
 }
 
 /**
- * Event handler for a shell colliding with a player.
+ * Event handler for shell collisions from all-or-nothing shot
+ */
+void apply_all_or_nothing_shot(body_t *body1, body_t *body2, vector_t axis,
+                               void *aux) {}
+
+/**
+ * Event handler for a shell colliding with a player other than its shooter.
  */
 void apply_shot_player_collision(body_t *shell, body_t *player, vector_t axis,
                                  void *aux) {
+  state_t *state = aux;
+  body_info_t shell_info = *(body_info_t *)body_get_info(shell);
+  if (get_player(state, shell_info.owner) == player) {
+    return;
+  }
+  if (shell_info.powerup == ALL_OR_NOTHING) {
+    apply_all_or_nothing_shot(shell, player, axis, aux);
+    return;
+  }
   body_info_t *player_info_ptr = (body_info_t *)body_get_info(player);
   player_info_ptr->health--;
   body_add_impulse(player, vec_multiply(1 / body_get_mass(player),
@@ -349,28 +355,12 @@ void apply_shot_player_collision(body_t *shell, body_t *player, vector_t axis,
   body_remove(shell);
 }
 
-/**
- * Creates a collision handler between a shell and a player.
- */
-void create_shot_player_collision(scene_t *scene, body_t *shell,
-                                  body_t *player) {
-  list_t *aux_bodies = list_init(2, (free_func_t)body_free);
-  list_add(aux_bodies, shell);
-  list_add(aux_bodies, player);
-
-  list_t *consts = list_init(0, free);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
-
-  create_collision(scene, shell, player,
-                   (collision_handler_t)apply_shot_player_collision, aux,
-                   const_body_aux_free);
-}
-
 /**
  * Event handler for a player moving into a powerup.
  */
-void apply_player_powerup_collision(scene_t *scene, body_t *player,
-                                    body_t *powerup, vector_t axis, void *aux) {
+void apply_player_powerup_collision(body_t *player, body_t *powerup,
+                                    vector_t axis, void *aux) {
+  state_t *state = aux;
   // get powerup type info
   body_info_t powerup_info = *(body_info_t *)body_get_info(powerup);
   // get player info
@@ -390,7 +380,7 @@ void apply_player_powerup_collision(scene_t *scene, body_t *player,
   case SHIELD:
     // HANDLE SHEILD CREATION
     player_info.powerup = SHIELD;
-    create_shield(scene, player);
+    create_shield(state->scene, player);
     break;
   case ALL_OR_NOTHING:
     // HANDLE ALL OR NOTHING
@@ -404,45 +394,8 @@ void apply_player_powerup_collision(scene_t *scene, body_t *player,
 }
 
 /**
- * Creates a collision handler between a player and a powerup.
+ * Event handler for a player moving into a raised landscape tile.
  */
-void create_powerup_player_collision(scene_t *scene, body_t *player,
-                                     body_t *powerup) {
-  list_t *aux_bodies = list_init(2, (free_func_t)body_free);
-  list_add(aux_bodies, player);
-  list_add(aux_bodies, powerup);
-
-  list_t *consts = list_init(0, free);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
-
-  create_collision(scene, player, powerup,
-                   (collision_handler_t)apply_player_powerup_collision, aux,
-                   const_body_aux_free);
-}
-
-/**
- * Event handler for shell collisions from all-or-nothing shot
- */
-void apply_all_or_nothing_shot(body_t *body1, body_t *body2, vector_t axis,
-                               void *aux) {}
-
-/**
- * Creates a collision handler for all-or-nothing shots between the shell and
- * player.
- */
-void create_all_or_nothing_shot(scene_t *scene, body_t *body1, body_t *body2) {
-  list_t *aux_bodies = list_init(2, (free_func_t)body_free);
-  list_add(aux_bodies, body1);
-  list_add(aux_bodies, body2);
-
-  list_t *consts = list_init(0, free);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
-
-  create_collision(scene, body1, body2,
-                   (collision_handler_t)apply_all_or_nothing_shot, aux,
-                   const_body_aux_free);
-}
-
 void apply_player_landscape_collision(body_t *body1, body_t *body2,
                                       vector_t axis, void *aux) {
 
@@ -463,34 +416,47 @@ void apply_player_landscape_collision(body_t *body1, body_t *body2,
   body_set_centroid(body2, new_center);
 }
 
-void create_player_landscape_collision(scene_t *scene, body_t *body1,
-                                       body_t *body2) {
-  list_t *aux_bodies = list_init(2, (free_func_t)body_free);
-  list_add(aux_bodies, body1);
-  list_add(aux_bodies, body2);
-
-  list_t *consts = list_init(0, free);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
+/**
+ * Event handler for a shell hitting a raised landscape tile, which lightens
+ * the tile until it is destroyed.
+ */
+void apply_shot_landscape_collision(body_t *shell, body_t *tile, vector_t axis,
+                                    void *aux) {
+  body_remove(shell);
+  list_t *colors = ((state_t *)aux)->landscape_colors;
+  rgb_color_t tile_color = body_get_color(tile);
+  for (size_t i = 0; i + 1 < list_size(colors); i++) {
+    if (colors_are_equal(tile_color, *(rgb_color_t *)list_get(colors, i))) {
+      body_set_color(tile, *(rgb_color_t *)list_get(colors, i + 1));
+      return;
+    }
+  }
+  body_remove(tile);
+}
 
-  create_collision(scene, body1, body2,
-                   (collision_handler_t)apply_player_landscape_collision, aux,
-                   const_body_aux_free);
+/**
+ * Event handler for two shells hitting each other.
+ */
+void apply_shot_shot_collision(body_t *shell1, body_t *shell2, vector_t axis,
+                               void *aux) {
+  body_remove(shell1);
+  body_remove(shell2);
 }
 
 /**
  * Generates a random center coordinate to generate a Powerup at depending on
  * maximum x value (used to generate both left and right powerups).
  */
-vector_t random_loc() {
-  return (vector_t){.x = (double)rand() / RAND_MAX * WINDOW.x,
-                    .y = ((double)rand() / RAND_MAX * WINDOW.y)};
+vector_t random_loc(state_t *state) {
+  return (vector_t){.x = rng_next_range(&state->rng, 0, WINDOW.x),
+                    .y = rng_next_range(&state->rng, 0, WINDOW.y)};
 }
 
 /**
- * Generates a random index between 0 and given range.
+ * Generates a random index from 0 up to, but not including, the given range.
  */
-size_t random_index(size_t range) {
-  return (size_t)((double)rand() / RAND_MAX * range);
+size_t random_index(state_t *state, size_t range) {
+  return rng_next_index(&state->rng, range);
 }
 
 /**
@@ -499,7 +465,7 @@ size_t random_index(size_t range) {
  */
 void handle_powerup_spawning(state_t *state) {
   if (state->powerup_spawn_delay <= 0) {
-    size_t rand_index = random_index(4);
+    size_t rand_index = random_index(state, 4);
 
     powerup_type_t powerup_type;
     switch (rand_index) {
@@ -515,20 +481,15 @@ void handle_powerup_spawning(state_t *state) {
       powerup_type = ALL_OR_NOTHING;
     }
 
-    vector_t loc = random_loc();
+    vector_t loc = random_loc(state);
     body_type_t body_type = (loc.x < WINDOW.x / 2) ? POWERUP1 : POWERUP2;
-    body_t *powerup = body_init_with_info(
-        make_circle(POWERUP_RADIUS, loc), ARBITRARY_MASS, POWERUP_COLOR,
+    body_t *powerup = body_init_circle(
+        POWERUP_RADIUS, loc, ARBITRARY_MASS, POWERUP_COLOR,
         create_powerup_info(powerup_type, body_type), free);
+    body_set_kind(powerup, BODY_STATIC);
+    body_set_collision_filter(powerup, POWERUP_CATEGORY, PLAYER_CATEGORY);
     scene_add_body(state->scene, powerup);
-
-    // Create collision for both players
-    list_t *players = get_bodies_by_type(state, PLAYER);
-    body_t *player1 = list_get(players, 0);
-    body_t *player2 = list_get(players, 1);
-    create_powerup_player_collision(state->scene, player1, powerup);
-    create_powerup_player_collision(state->scene, player2, powerup);
-    state->powerup_spawn_delay = SPAWN_DELAY * (double)rand() / RAND_MAX;
+    state->powerup_spawn_delay = rng_next_range(&state->rng, 0, SPAWN_DELAY);
   }
 }
 
@@ -553,8 +514,7 @@ void make_landscape(state_t *state) {
   size_t num_cols = WINDOW.x / width;
   size_t num_rows = (WINDOW.y / (0.5 * height)) + 1;
 
-  // Make color list
-  list_t *color_list = landscape_colors_list();
+  list_t *color_list = state->landscape_colors;
 
   // Generate hexagons in rows
   vector_t next = top_left_hexagon;
@@ -564,20 +524,24 @@ void make_landscape(state_t *state) {
     for (size_t j = 0; j < num_cols; j++) {
 
       // initialize bricks, and set them to proper location
-      list_t *vertices = make_hexagon(HEXAGON_RADIUS, VEC_ZERO);
+      polygon_t *vertices = make_hexagon(HEXAGON_RADIUS, VEC_ZERO);
       body_t *hexagon =
-          body_init_with_info(vertices, ARBITRARY_MASS, COLOR_WHITE,
-                              create_general_info(LANDSCAPE), free);
+          body_init_with_polygon(vertices, ARBITRARY_MASS, COLOR_WHITE,
+                                 create_general_info(LANDSCAPE), free);
+      body_set_kind(hexagon, BODY_STATIC);
       vector_t current_coord_add = vec_multiply((double)j, spacing_next_space);
       vector_t current_coord = vec_add(next, current_coord_add);
       body_set_centroid(hexagon, current_coord);
 
       // TODO: Fix buggy implementation of colors
       if (current_coord.x > LEFT_BOUNDARY && current_coord.x < RIGHT_BOUNDARY) {
-        size_t random_color_index = random_index(3);
+        size_t random_color_index = random_index(state, 3);
         rgb_color_t random_green =
             *(rgb_color_t *)list_get(color_list, random_color_index);
         body_set_color(hexagon, random_green);
+        // Only raised tiles block players and shots
+        body_set_collision_filter(hexagon, LANDSCAPE_CATEGORY,
+                                  PLAYER_CATEGORY | SHOT_CATEGORY);
       }
 
       scene_add_body(state->scene, hexagon);
@@ -592,8 +556,6 @@ void make_landscape(state_t *state) {
     next.x = restart.x;
     next.y = next.y + spacing_next_row.y;
   }
-
-  list_free(color_list);
 }
 
 void make_border(state_t *state) {
@@ -602,53 +564,56 @@ void make_border(state_t *state) {
   vector_t right_loc = {WINDOW.x, CENTER.y};
   vector_t left_loc = {0, CENTER.y};
 
-  list_t *border_top_vert = make_rectangle(WINDOW.x, BORDER_WIDTH, top_loc);
+  polygon_t *border_top_vert = make_rectangle(WINDOW.x, BORDER_WIDTH, top_loc);
   body_t *border_top =
-      body_init_with_info(border_top_vert, ARBITRARY_MASS, PLAYER1_COLOR,
-                          create_general_info(BORDER), free);
+      body_init_with_polygon(border_top_vert, ARBITRARY_MASS, PLAYER1_COLOR,
+                             create_general_info(BORDER), free);
+  body_set_kind(border_top, BODY_STATIC);
   scene_add_body(state->scene, border_top);
 
-  list_t *border_bot_vert = make_rectangle(WINDOW.x, BORDER_WIDTH, bot_loc);
+  polygon_t *border_bot_vert = make_rectangle(WINDOW.x, BORDER_WIDTH, bot_loc);
   body_t *border_bot =
-      body_init_with_info(border_bot_vert, ARBITRARY_MASS, PLAYER1_COLOR,
-                          create_general_info(BORDER), free);
+      body_init_with_polygon(border_bot_vert, ARBITRARY_MASS, PLAYER1_COLOR,
+                             create_general_info(BORDER), free);
+  body_set_kind(border_bot, BODY_STATIC);
   scene_add_body(state->scene, border_bot);
 
-  list_t *border_left_vert = make_rectangle(BORDER_WIDTH, WINDOW.y, left_loc);
+  polygon_t *border_left_vert = make_rectangle(BORDER_WIDTH, WINDOW.y, left_loc);
   body_t *border_left =
-      body_init_with_info(border_left_vert, ARBITRARY_MASS, PLAYER1_COLOR,
-                          create_general_info(BORDER), free);
+      body_init_with_polygon(border_left_vert, ARBITRARY_MASS, PLAYER1_COLOR,
+                             create_general_info(BORDER), free);
+  body_set_kind(border_left, BODY_STATIC);
   scene_add_body(state->scene, border_left);
 
-  list_t *border_right_vert = make_rectangle(BORDER_WIDTH, WINDOW.y, right_loc);
+  polygon_t *border_right_vert = make_rectangle(BORDER_WIDTH, WINDOW.y, right_loc);
   body_t *border_right =
-      body_init_with_info(border_right_vert, ARBITRARY_MASS, PLAYER1_COLOR,
-                          create_general_info(BORDER), free);
+      body_init_with_polygon(border_right_vert, ARBITRARY_MASS, PLAYER1_COLOR,
+                             create_general_info(BORDER), free);
+  body_set_kind(border_right, BODY_STATIC);
   scene_add_body(state->scene, border_right);
 }
 
 void make_players(state_t *state) {
-  list_t *vertices = make_hexagon(PLAYER_SIZE, PLAYER1_CENTER);
+  polygon_t *vertices = make_hexagon(PLAYER_SIZE, PLAYER1_CENTER);
   body_t *player1 =
-      body_init_with_info(vertices, PLAYER_MASS, PLAYER1_COLOR,
-                          create_player_info(INITIAL_HEALTH), free);
-  scene_add_body(state->scene, player1);
-  create_drag(state->scene, DRAG_COEFF, player1);
+      body_init_with_polygon(vertices, PLAYER_MASS, PLAYER1_COLOR,
+                             create_player_info(INITIAL_HEALTH), free);
+  body_set_collision_filter(player1, PLAYER_CATEGORY, UINT32_MAX);
+  state->players[0] = scene_add_body(state->scene, player1);
 
-  list_t *vertices1 = make_hexagon(PLAYER_SIZE, PLAYER2_CENTER);
+  polygon_t *vertices1 = make_hexagon(PLAYER_SIZE, PLAYER2_CENTER);
   body_t *player2 =
-      body_init_with_info(vertices1, PLAYER_MASS, PLAYER2_COLOR,
-                          create_player_info(INITIAL_HEALTH), free);
-  scene_add_body(state->scene, player2);
-  create_drag(state->scene, DRAG_COEFF, player2);
+      body_init_with_polygon(vertices1, PLAYER_MASS, PLAYER2_COLOR,
+                             create_player_info(INITIAL_HEALTH), free);
+  body_set_collision_filter(player2, PLAYER_CATEGORY, UINT32_MAX);
+  state->players[1] = scene_add_body(state->scene, player2);
+  create_field_drag(state->scene, DRAG_COEFF, 0, PLAYER_CATEGORY);
 }
 
 void turn_reset(state_t *state) {
   list_t *borders = get_bodies_by_type(state, BORDER);
   rgb_color_t curr_border_color;
 
-  list_t *players = get_bodies_by_type(state, PLAYER);
-
   if (state->active_player == 0) {
     state->active_player = 1;
     curr_border_color = PLAYER2_COLOR;
@@ -665,7 +630,7 @@ void turn_reset(state_t *state) {
 
   // increase shot count if extra shot powerup
   // TODO: Debug
-  body_t *player = list_get(players, state->active_player);
+  body_t *player = get_player(state, state->active_player);
   body_info_t player_info = *(body_info_t *)body_get_info(player);
   if (player_info.powerup == EXTRA_SHOT) {
     state->shots_left += 1;
@@ -676,9 +641,7 @@ void turn_reset(state_t *state) {
 }
 
 void trajectory_dots(state_t *state) {
-  list_t *players = get_bodies_by_type(state, PLAYER);
-  body_t *player =
-      state->active_player == 1 ? list_get(players, 1) : list_get(players, 0);
+  body_t *player = get_player(state, state->active_player);
 
   // get aim center
   vector_t end_point = state->aim_center;
@@ -698,57 +661,37 @@ void trajectory_dots(state_t *state) {
 
   vector_t circle_coord = center_pt;
   for (size_t i = 0; i <= 10; i++) {
-    list_t *circle = make_circle(1, circle_coord);
-    body_t *dot = body_init_with_info(circle, 1, COLOR_BLACK,
-                                      create_general_info(TRAJECTORY), free);
-    body_set_centroid(dot, circle_coord);
+    body_t *dot = body_init_circle(1, circle_coord, 1, COLOR_BLACK,
+                                   create_general_info(TRAJECTORY), free);
     scene_add_body(state->scene, dot);
     circle_coord = vec_add(circle_coord, increment);
   }
-  make_circle(1, end_point);
 }
 
 void shoot(body_t *shooting_body, state_t *state) {
-  list_t *players = get_bodies_by_type(state, PLAYER);
-  body_t *player = (body_t *)list_get(players, (state->active_player + 1) % 2);
+  body_t *player = get_player(state, (state->active_player + 1) % 2);
   body_info_t player_info = *(body_info_t *)body_get_info(player);
 
   vector_t center = body_get_centroid(shooting_body);
   rgb_color_t color = body_get_color(shooting_body);
 
-  list_t *vertices = make_circle(10, center);
-  body_t *shot = body_init_with_info(vertices, INFINITY, color,
-                                     create_general_info(BULLET), free);
+  body_info_t *shot_info = create_general_info(BULLET);
+  shot_info->owner = state->active_player;
+  // All-or-nothing shots are handled differently when they hit the player
+  shot_info->powerup =
+      player_info.powerup == ALL_OR_NOTHING ? ALL_OR_NOTHING : NONE;
+  body_t *shot = body_init_circle(10, center, INFINITY, color, shot_info, free);
+  body_set_kind(shot, BODY_KINEMATIC);
+  body_set_collision_filter(shot, SHOT_CATEGORY, UINT32_MAX);
 
   body_set_velocity(shot, vec_subtract(state->aim_center, center));
 
-  // Add health decrement/recoil collision or ALL OR NOTHING COLLISION
-  if (player_info.powerup == ALL_OR_NOTHING) {
-    create_all_or_nothing_shot(state->scene, shot, player);
-  } else {
-    create_shot_player_collision(state->scene, shot, player);
-  }
-
-  // Add destructive collisions between shot and all existing invaders
-  for (size_t i = 0; i < scene_bodies(state->scene); ++i) {
-    body_t *body = scene_get_body(state->scene, i);
-    body_info_t info = *(body_info_t *)body_get_info(body);
-    if (info.type == BULLET || info.type == LANDSCAPE) {
-      if (colors_are_equal(body_get_color(body), COLOR_WHITE) == 0) {
-        create_color_increment_collision(state->scene, shot, body,
-                                         landscape_colors_list(),
-                                         (free_func_t)list_free);
-      }
-    }
-  }
   create_random_impulse(state->scene, IMPULSE_PROBABILITY, IMPULSE_MAX, shot);
   scene_add_body(state->scene, shot);
 }
 
 void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
-  list_t *players = get_bodies_by_type(state, PLAYER);
-  body_t *player =
-      state->active_player == 1 ? list_get(players, 1) : list_get(players, 0);
+  body_t *player = get_player(state, state->active_player);
 
   if (type == KEY_PRESSED) {
     switch (key) {
@@ -807,16 +750,15 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
 
 void end_screen(state_t *state) {
   sdl_clear();
-  list_t *window = make_rectangle(WINDOW.x, WINDOW.y, CENTER);
-  body_t *background = body_init_with_info(
+  polygon_t *window = make_rectangle(WINDOW.x, WINDOW.y, CENTER);
+  body_t *background = body_init_with_polygon(
       window, PLAYER_MASS, COLOR_WHITE, create_general_info(BACKGROUND), free);
   scene_add_body(state->scene, background);
-  list_t *players = get_bodies_by_type(state, PLAYER);
 
   body_info_t player1_info =
-      *(body_info_t *)body_get_info(list_get(players, 0));
+      *(body_info_t *)body_get_info(get_player(state, 0));
   body_info_t player2_info =
-      *(body_info_t *)body_get_info(list_get(players, 1));
+      *(body_info_t *)body_get_info(get_player(state, 1));
   /*if (body_is_removed(list_get(players, 0))) {
     draw_text(50, (size_t)CENTER.x - 125, (size_t)CENTER.y - 60, 200, 80,
               "Player 2 has won!");
@@ -838,9 +780,8 @@ void end_screen(state_t *state) {
 
 bool handle_end_screen(state_t *state) {
   time_t countdown = state->countdown;
-  list_t *players = get_bodies_by_type(state, PLAYER);
-  body_t *player1 = list_get(players, 0);
-  body_t *player2 = list_get(players, 1);
+  body_t *player1 = get_player(state, 0);
+  body_t *player2 = get_player(state, 1);
   body_info_t info1 = *(body_info_t *)body_get_info(player1);
   body_info_t info2 = *(body_info_t *)body_get_info(player2);
   if (info1.health <= 0 || info2.health <= 0 || countdown <= 0) {
@@ -851,7 +792,7 @@ bool handle_end_screen(state_t *state) {
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  uint64_t seed = time(NULL);
 
   vector_t min = {.x = 0, .y = 0};
   vector_t max = WINDOW;
@@ -860,11 +801,21 @@ state_t *emscripten_init() {
 
   state_t *state = malloc(sizeof(state_t));
   scene_t *scene = scene_init();
+  // Only check collisions between bodies in neighboring hexagon-sized cells
+  scene_enable_grid(scene, 2 * HEXAGON_RADIUS);
+  // Simulate at a steady rate however fast frames are drawn
+  scene_set_fixed_step(scene, PHYSICS_STEP, MAX_PHYSICS_STEPS);
+  // Stop simulating bodies that have come to rest until something hits them
+  scene_enable_sleeping(scene, SLEEP_SPEED, SLEEP_DELAY);
+  // Seed the shots' random impulses and the game's own random numbers alike
+  scene_set_seed(scene, seed);
+  state->rng = rng_init(seed, 0);
   state->active_player = 0;
   state->scene = scene;
   state->aim_center = CENTER;
   state->shots_left = BASE_SHOT_COUNT;
   state->game_over = false;
+  state->landscape_colors = landscape_colors_list();
 
   // ORDER MATTERS HERE:
   // make_background(state); // TODO: Do we even need or want a background
@@ -873,20 +824,17 @@ state_t *emscripten_init() {
   make_players(state);
   make_border(state);
 
-  // Get players for landscape collision
-  list_t *players = get_bodies_by_type(state, PLAYER);
-  list_t *hexagons = get_bodies_by_type(state, LANDSCAPE);
-
-  body_t *player1 = (body_t *)list_get(players, 0);
-  body_t *player2 = (body_t *)list_get(players, 1);
-
-  for (size_t i = 0; i < list_size(hexagons); i++) {
-    body_t *hexagon = (body_t *)list_get(hexagons, i);
-    if (colors_are_equal(body_get_color(hexagon), COLOR_WHITE) == 0) {
-      create_player_landscape_collision(state->scene, hexagon, player1);
-      create_player_landscape_collision(state->scene, hexagon, player2);
-    }
-  }
+  // Register every kind of collision once, by category
+  scene_add_collision_handler(scene, SHOT_CATEGORY, PLAYER_CATEGORY,
+                              apply_shot_player_collision, state, NULL);
+  scene_add_collision_handler(scene, SHOT_CATEGORY, LANDSCAPE_CATEGORY,
+                              apply_shot_landscape_collision, state, NULL);
+  scene_add_collision_handler(scene, SHOT_CATEGORY, SHOT_CATEGORY,
+                              apply_shot_shot_collision, NULL, NULL);
+  scene_add_collision_handler(scene, PLAYER_CATEGORY, POWERUP_CATEGORY,
+                              apply_player_powerup_collision, state, NULL);
+  scene_add_collision_handler(scene, LANDSCAPE_CATEGORY, PLAYER_CATEGORY,
+                              apply_player_landscape_collision, NULL, NULL);
 
   time_t countdown = 300000;
   state->countdown = countdown;
@@ -913,7 +861,7 @@ void emscripten_main(state_t *state) {
       body_remove(body);
     }
   }
-  scene_tick(scene, dt);
+  scene_advance(scene, dt);
   trajectory_dots(state);
   handle_powerup_spawning(state);
   handle_health_display(state);
@@ -925,5 +873,6 @@ void emscripten_main(state_t *state) {
 
 void emscripten_free(state_t *state) {
   scene_free(state->scene);
+  list_free(state->landscape_colors);
   free(state);
 }
\ No newline at end of file
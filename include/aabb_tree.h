@@ -0,0 +1,138 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include "polygon.h"
+#include <stddef.h>
+
+/**
+ * A dynamic bounding volume hierarchy over axis-aligned bounding boxes.
+ * Each box is a leaf of a balanced binary tree whose internal nodes bound
+ * their children, so overlap, pair and ray queries skip whole subtrees.
+ * Unlike a spatial_grid_t, the tree adapts to boxes of very different sizes.
+ *
+ * Leaves store a "fat" box enlarged by a margin, so a box that moves a little
+ * is only reinserted once it leaves its fat box.
+ * Boxes are referred to by the proxy id returned from aabb_tree_insert().
+ */
+typedef struct aabb_tree aabb_tree_t;
+
+/**
+ * A function called for each pair of overlapping boxes in a tree.
+ *
+ * @param data1 the data the first box was inserted with
+ * @param data2 the data the second box was inserted with
+ * @param aux the auxiliary value passed to aabb_tree_pairs()
+ */
+typedef void (*tree_pair_handler_t)(void *data1, void *data2, void *aux);
+
+/**
+ * A function called for each box found by a query on a tree.
+ *
+ * @param data the data the box was inserted with
+ * @param aux the auxiliary value passed to the query
+ */
+typedef void (*tree_query_handler_t)(void *data, void *aux);
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the margin is non-negative.
+ *
+ * @param margin how far to enlarge each box in every direction, so that small
+ *   movements do not change the tree
+ * @return a pointer to the newly allocated tree
+ */
+aabb_tree_t *aabb_tree_init(double margin);
+
+/**
+ * Releases the memory allocated for a tree. The data is never freed.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_free(aabb_tree_t *tree);
+
+/**
+ * Gets the number of boxes in a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the number of boxes inserted and not removed
+ */
+size_t aabb_tree_size(aabb_tree_t *tree);
+
+/**
+ * Inserts a box into a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param bounds the box to insert
+ * @param data a value passed back to handlers, e.g. a body
+ * @return the proxy id of the box, valid until it is removed
+ */
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t bounds, void *data);
+
+/**
+ * Removes a box from a tree.
+ * Asserts that the proxy id refers to a box in the tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param proxy the id returned when the box was inserted
+ */
+void aabb_tree_remove(aabb_tree_t *tree, size_t proxy);
+
+/**
+ * Updates the box of a proxy after it moves.
+ * The tree is only restructured if the box leaves its fat box.
+ * Asserts that the proxy id refers to a box in the tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param proxy the id returned when the box was inserted
+ * @param bounds the new box
+ * @return whether the box had to be reinserted
+ */
+bool aabb_tree_move(aabb_tree_t *tree, size_t proxy, aabb_t bounds);
+
+/**
+ * Gets the data a box was inserted with.
+ * Asserts that the proxy id refers to a box in the tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param proxy the id returned when the box was inserted
+ * @return the box's data
+ */
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t proxy);
+
+/**
+ * Calls a handler once for every pair of boxes in a tree that overlap.
+ * Boxes are compared exactly, not by their fat boxes.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param handler the function to call on each overlapping pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void aabb_tree_pairs(aabb_tree_t *tree, tree_pair_handler_t handler,
+                     void *aux);
+
+/**
+ * Calls a handler once for every box in a tree that overlaps a query box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param bounds the box to look for overlaps with
+ * @param handler the function to call on each overlapping box
+ * @param aux an auxiliary value to pass to the handler
+ */
+void aabb_tree_query(aabb_tree_t *tree, aabb_t bounds,
+                     tree_query_handler_t handler, void *aux);
+
+/**
+ * Calls a handler once for every box in a tree that a line segment passes
+ * through, e.g. to find what a shot from start to end could hit.
+ * The boxes are not reported in any particular order along the segment.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param handler the function to call on each box hit
+ * @param aux an auxiliary value to pass to the handler
+ */
+void aabb_tree_raycast(aabb_tree_t *tree, vector_t start, vector_t end,
+                       tree_query_handler_t handler, void *aux);
+
+#endif // #ifndef __AABB_TREE_H__
@@ -0,0 +1,78 @@
+#ifndef __BARNES_HUT_H__
+#define __BARNES_HUT_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A Barnes-Hut quadtree over point masses, for approximating the
+ * gravitational field of many bodies.
+ * Each node stores the total mass and center of mass of the points inside
+ * its square, so a query can treat a whole distant node as a single point.
+ * Finding the field at every point costs roughly O(points * log(points))
+ * instead of O(points ** 2).
+ *
+ * The tree is meant to be rebuilt every tick. Rebuilding reuses the memory
+ * from earlier builds, so it only grows with the largest number of points.
+ */
+typedef struct barnes_hut barnes_hut_t;
+
+/**
+ * Allocates memory for an empty tree.
+ *
+ * @return a pointer to the newly allocated tree
+ */
+barnes_hut_t *barnes_hut_init(void);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ */
+void barnes_hut_free(barnes_hut_t *tree);
+
+/**
+ * Gets the number of points in a tree.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @return the number of points passed to the last barnes_hut_build()
+ */
+size_t barnes_hut_size(barnes_hut_t *tree);
+
+/**
+ * Replaces the points in a tree.
+ * The points are copied, so the arrays may be reused afterwards.
+ * Asserts that every mass is non-negative.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @param positions the position of each point
+ * @param masses the mass of each point
+ * @param count the number of points
+ */
+void barnes_hut_build(barnes_hut_t *tree, const vector_t *positions,
+                      const double *masses, size_t count);
+
+/**
+ * Computes the gravitational field of the points in a tree at a position,
+ * i.e. the sum of mass / distance ** 2 toward each point.
+ * Multiply by G and the mass of a body there to get the force on it.
+ *
+ * Nodes whose width divided by their distance is less than theta are
+ * approximated by their center of mass, so 0 gives the exact sum and larger
+ * values are faster but less accurate. 0.5 is a common choice.
+ * Like create_newtonian_gravity(), points (or approximated nodes) closer
+ * than min_dist contribute nothing, since the field blows up near them.
+ * Asserts that theta is non-negative.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @param position where to compute the field
+ * @param self the index of a point to leave out, e.g. the body the field
+ *   acts on, or at least barnes_hut_size() to leave out nothing
+ * @param theta the opening angle
+ * @param min_dist the distance below which contributions are skipped
+ * @return the field at the position
+ */
+vector_t barnes_hut_field(barnes_hut_t *tree, vector_t position, size_t self,
+                          double theta, double min_dist);
+
+#endif // #ifndef __BARNES_HUT_H__
@@ -3,8 +3,10 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -14,6 +16,25 @@
  */
 typedef struct body body_t;
 
+/**
+ * Structure-of-arrays storage for the state body_tick() updates.
+ * A body attached to a store keeps its centroid, velocity, force and impulse
+ * in the store's parallel arrays instead of inside the body, so
+ * body_store_tick() can integrate every attached body in one tight loop.
+ * Attached bodies are still used through their body_t pointers as usual.
+ */
+typedef struct body_store body_store_t;
+
+/**
+ * How a body moves.
+ * Dynamic bodies are moved by the forces and impulses applied to them.
+ * Kinematic bodies move with their velocity but ignore forces and impulses,
+ * as if their mass were infinite, e.g. a shot that flies straight.
+ * Static bodies never move on their own, e.g. walls and scenery:
+ * they are never integrated, and their bounds are computed only once.
+ */
+typedef enum { BODY_DYNAMIC, BODY_KINEMATIC, BODY_STATIC } body_kind_t;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -36,6 +57,43 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color);
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer);
 
+/**
+ * Allocates memory for a body whose shape is a contiguous polygon.
+ * Acts like body_init_with_info(), but takes ownership of a polygon_t
+ * instead of a list of vectors, so no per-vertex copies are made.
+ * body_init_with_info() converts its list and calls this function.
+ *
+ * @param shape the polygon describing the initial shape of the body
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_polygon(polygon_t *shape, double mass,
+                               rgb_color_t color, void *info,
+                               free_func_t info_freer);
+
+/**
+ * Allocates memory for a body whose shape is an exact circle.
+ * Collisions with circles are computed from the center and radius,
+ * which is much cheaper than approximating the circle with a polygon.
+ * The circle is only approximated by vertices if they are asked for,
+ * e.g. by body_view_shape(). Otherwise acts like body_init_with_info().
+ * Asserts that the radius is positive.
+ *
+ * @param radius the radius of the circle
+ * @param center the initial centroid of the body
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle(double radius, vector_t center, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -46,12 +104,49 @@ void body_free(body_t *body);
 /**
  * Gets the current shape of a body.
  * Returns a newly allocated vector list, which must be list_free()d.
+ * Prefer body_view_shape() unless the caller needs its own copy.
  *
  * @param body a pointer to a body returned from body_init()
  * @return the polygon describing the body's current position
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets a borrowed, read-only view of the current shape of a body.
+ * Unlike body_get_shape() and body_get_polygon(), this does not allocate.
+ * The vertices belong to the body: they must not be modified or freed,
+ * and they may change or be recomputed once the body is moved or rotated,
+ * so take a fresh view after that. The view is invalid after body_free().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a view of the vertices describing the body's current position
+ */
+polygon_view_t body_view_shape(body_t *body);
+
+/**
+ * Gets a borrowed, read-only view of the unit normals of a body's edges
+ * at its current rotation (see vertices_edge_normals()).
+ * Normal i is perpendicular to the edge from vertex i to vertex i + 1 of
+ * body_view_shape(). The normals are computed once when the body is created
+ * and only rotated again after the body rotates; the same rules as
+ * body_view_shape() apply to the view.
+ * Circle bodies have no edges, so their view is empty.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a view of the body's edge normals, one per vertex
+ */
+polygon_view_t body_view_normals(body_t *body);
+
+/**
+ * Gets the current shape of a body as a contiguous polygon.
+ * Returns a newly allocated polygon, which must be polygon_free()d.
+ * This is cheaper than body_get_shape(), which allocates every vertex.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+polygon_t *body_get_polygon(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -63,6 +158,92 @@ list_t *body_get_shape(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Gets an axis-aligned box that contains a body in any orientation.
+ * The box is a square around the centroid sized by the farthest vertex,
+ * so it is computed in O(1) without updating the body's vertices.
+ * It is meant for broad-phase culling, not as the tightest possible box.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a box containing every vertex of the body
+ */
+aabb_t body_get_bounds(body_t *body);
+
+/**
+ * Returns whether a body was created with body_init_circle().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is an exact circle
+ */
+bool body_is_circle(body_t *body);
+
+/**
+ * Gets the radius of a circle body, or for a polygon body the distance from
+ * its centroid to its farthest vertex.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's radius
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Gets how a body moves. New bodies are dynamic.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's kind
+ */
+body_kind_t body_get_kind(body_t *body);
+
+/**
+ * Changes how a body moves (see body_kind_t).
+ * Making a body kinematic or static drops the forces and impulses applied to
+ * it this tick, and making it static also stops it.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param kind the body's new kind
+ */
+void body_set_kind(body_t *body, body_kind_t kind);
+
+/**
+ * Sets the collision categories a body belongs to and the categories it
+ * collides with, as bit sets of up to 32 categories.
+ * A scene only tests two bodies for collision (see
+ * scene_add_collision_handler()) if each one's category shares a bit with the
+ * other's mask. New bodies are in no category, so they never collide,
+ * and have a mask of every category.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param category the categories the body belongs to
+ * @param mask the categories the body collides with
+ */
+void body_set_collision_filter(body_t *body, uint32_t category, uint32_t mask);
+
+/**
+ * Gets the collision categories a body belongs to.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's category bits
+ */
+uint32_t body_get_collision_category(body_t *body);
+
+/**
+ * Gets the collision categories a body collides with.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's mask bits
+ */
+uint32_t body_get_collision_mask(body_t *body);
+
+/**
+ * Gets how much a body's velocity changes per unit of impulse.
+ * This is 0 for bodies that forces cannot move: bodies with infinite mass,
+ * and kinematic and static bodies.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return 1 / the body's mass, or 0 if forces do not move it
+ */
+double body_get_inverse_mass(body_t *body);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -79,6 +260,37 @@ vector_t body_get_velocity(body_t *body);
  */
 double body_get_rotation(body_t *body);
 
+/**
+ * Remembers a body's current centroid and rotation as its previous transform,
+ * e.g. right before a fixed-size physics step (see scene_advance()).
+ * A new body's previous transform is its initial one.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_save_transform(body_t *body);
+
+/**
+ * Blends a body's previous centroid (see body_save_transform()) with its
+ * current one, e.g. to draw it between two physics steps.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far to go from the previous centroid (0)
+ *   to the current one (1)
+ * @return the blended centroid
+ */
+vector_t body_get_interpolated_centroid(body_t *body, double alpha);
+
+/**
+ * Blends a body's previous rotation (see body_save_transform()) with its
+ * current one, like body_get_interpolated_centroid().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far to go from the previous rotation (0)
+ *   to the current one (1)
+ * @return the blended rotation angle in radians
+ */
+double body_get_interpolated_rotation(body_t *body, double alpha);
+
 /**
  * Gets the mass of a body.
  *
@@ -106,6 +318,8 @@ void *body_get_info(body_t *body);
 /**
  * Translates a body to a new position.
  * The position is specified by the position of the body's center of mass.
+ * This is O(1): the body's vertices are only recomputed the next time
+ * its shape is requested.
  *
  * @param body a pointer to a body returned from body_init()
  * @param x the body's new centroid
@@ -114,6 +328,7 @@ void body_set_centroid(body_t *body, vector_t x);
 
 /**
  * Changes a body's velocity (the time-derivative of its position).
+ * Static bodies always have zero velocity, so this does nothing to them.
  *
  * @param body a pointer to a body returned from body_init()
  * @param v the body's new velocity
@@ -124,6 +339,7 @@ void body_set_velocity(body_t *body, vector_t v);
  * Changes a body's orientation in the plane.
  * The body is rotated about its center of mass.
  * Note that the angle is *absolute*, not relative to the current orientation.
+ * Like body_set_centroid(), the vertices are updated lazily.
  *
  * @param body a pointer to a body returned from body_init()
  * @param angle the body's new angle in radians. Positive is counterclockwise.
@@ -136,6 +352,7 @@ void body_set_color(body_t *body, rgb_color_t color);
  * Applies a force to a body over the current tick.
  * If multiple forces are applied in the same tick, they should be added.
  * Should not change the body's position or velocity; see body_tick().
+ * Does nothing to kinematic and static bodies.
  *
  * @param body a pointer to a body returned from body_init()
  * @param force the force vector to apply
@@ -148,12 +365,29 @@ void body_add_force(body_t *body, vector_t force);
  * which is useful for modeling collisions.
  * If multiple impulses are applied in the same tick, they should be added.
  * Should not change the body's position or velocity; see body_tick().
+ * Does nothing to kinematic and static bodies.
  *
  * @param body a pointer to a body returned from body_init()
  * @param impulse the impulse vector to apply
  */
 void body_add_impulse(body_t *body, vector_t impulse);
 
+/**
+ * Gets the total force applied to a body so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the forces passed to body_add_force() this tick
+ */
+vector_t body_get_force(body_t *body);
+
+/**
+ * Gets the total impulse applied to a body so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the impulses passed to body_add_impulse() this tick
+ */
+vector_t body_get_impulse(body_t *body);
+
 /**
  * Updates the body after a given time interval has elapsed.
  * Sets acceleration and velocity according to the forces and impulses
@@ -161,6 +395,7 @@ void body_add_impulse(body_t *body, vector_t impulse);
  * The body should be translated at the *average* of the velocities before
  * and after the tick.
  * Resets the forces and impulses accumulated on the body.
+ * A sleeping or static body does not move (see body_sleep()).
  *
  * @param body the body to tick
  * @param dt the number of seconds elapsed since the last tick
@@ -186,4 +421,164 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * Puts a body to sleep: it stops moving and body_tick() skips it until it is
+ * woken. Scenes also skip force creators whose bodies are all asleep.
+ * Usually called by the scene (see scene_enable_sleeping()).
+ * Only dynamic bodies sleep; this does nothing to other kinds of bodies.
+ *
+ * @param body the body to put to sleep
+ */
+void body_sleep(body_t *body);
+
+/**
+ * Wakes a sleeping body and resets its rest time.
+ * body_set_centroid(), body_set_rotation() and body_set_velocity() wake the
+ * body automatically.
+ *
+ * @param body the body to wake
+ */
+void body_wake(body_t *body);
+
+/**
+ * Returns whether a body is asleep, see body_sleep().
+ *
+ * @param body the body to check
+ * @return whether the body is asleep
+ */
+bool body_is_sleeping(body_t *body);
+
+/**
+ * Gets how long a body has been moving slowly enough to fall asleep.
+ * Scenes track this, see scene_enable_sleeping().
+ *
+ * @param body the body to check
+ * @return the body's rest time, in seconds
+ */
+double body_get_rest_time(body_t *body);
+
+/**
+ * Sets how long a body has been moving slowly enough to fall asleep.
+ *
+ * @param body the body to update
+ * @param rest_time the body's new rest time, in seconds
+ */
+void body_set_rest_time(body_t *body, double rest_time);
+
+/**
+ * Everything about a body that can change once it is created, except its
+ * info, which the body does not know how to copy.
+ * It is plain data, so it can be copied with memcpy().
+ * See body_save_state().
+ */
+typedef struct body_state {
+  vector_t centroid;
+  vector_t velocity;
+  vector_t force;
+  vector_t impulse;
+  double rotation;
+  vector_t previous_centroid;
+  double previous_rotation;
+  double rest_time;
+  rgb_color_t color;
+  body_kind_t kind;
+  uint32_t category;
+  uint32_t mask;
+  bool is_removed;
+  bool is_sleeping;
+} body_state_t;
+
+/**
+ * Saves a body's state, e.g. so a scene snapshot can put it back later.
+ * A body's shape never changes, so it is not saved.
+ *
+ * @param body the body to save
+ * @param state where to save the state
+ */
+void body_save_state(body_t *body, body_state_t *state);
+
+/**
+ * Puts back a body's state from body_save_state(), as if nothing had
+ * happened to the body since.
+ *
+ * @param body the body to restore
+ * @param state a state saved from the same body
+ */
+void body_restore_state(body_t *body, const body_state_t *state);
+
+/**
+ * Allocates memory for an empty body store.
+ *
+ * @return a pointer to the newly allocated store
+ */
+body_store_t *body_store_init();
+
+/**
+ * Detaches every body from a store and releases the store's memory.
+ * The bodies themselves are not freed.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_free(body_store_t *store);
+
+/**
+ * Gets the number of bodies attached to a store.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @return the number of attached bodies
+ */
+size_t body_store_size(body_store_t *store);
+
+/**
+ * Gets the number of bodies attached to a store that are not static.
+ * The store keeps them in slots [0, body_store_num_moving()), ahead of the
+ * static bodies, moving bodies between slots when their kind changes.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @return the number of attached dynamic and kinematic bodies
+ */
+size_t body_store_num_moving(body_store_t *store);
+
+/**
+ * Moves a body's centroid, velocity, force and impulse into a store.
+ * Asserts that the body is not already attached to a store.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param body the body to attach
+ */
+void body_store_attach(body_store_t *store, body_t *body);
+
+/**
+ * Moves a body's state out of the store it is attached to.
+ * Another body may take over its slot in the store.
+ * body_free() detaches the body automatically.
+ * Asserts that the body is attached to a store.
+ *
+ * @param body the body to detach
+ */
+void body_store_detach(body_t *body);
+
+/**
+ * Ticks every body attached to a store, exactly as body_tick() would.
+ * Static bodies never move, so only the slots of the other bodies are
+ * visited.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_tick(body_store_t *store, double dt);
+
+/**
+ * Ticks the bodies in slots [start, end) of a store, exactly as body_tick()
+ * would. Ranges that do not overlap can be ticked at the same time.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot to tick
+ * @param end one past the last slot to tick, at most
+ *   body_store_num_moving()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_tick_range(body_store_t *store, size_t start, size_t end,
+                           double dt);
+
 #endif // #ifndef __BODY_H__
@@ -1,6 +1,7 @@
 #ifndef __COLLISION_H__
 #define __COLLISION_H__
 
+#include "body.h"
 #include "list.h"
 #include "vector.h"
 #include <stdbool.h>
@@ -21,6 +22,18 @@ typedef struct {
   vector_t axis;
 } collision_info_t;
 
+/**
+ * Remembers the axis that last separated a pair of shapes (or, if they
+ * collided, the axis they overlapped least on) so the next test of the same
+ * pair can try it first. Pairs rarely move much between ticks, so most
+ * separated pairs are rejected after a single projection.
+ * Start with has_axis false; the collision functions fill it in.
+ */
+typedef struct {
+  bool has_axis;
+  vector_t axis;
+} separating_axis_cache_t;
+
 /**
  * Computes the status of the collision between two convex polygons.
  * The shapes are given as lists of vertices in counterclockwise order.
@@ -34,4 +47,90 @@ typedef struct {
  */
 collision_info_t find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Computes the status of the collision between two convex polygons
+ * given as contiguous vertex arrays, e.g. from polygon_vertices().
+ * Behaves exactly like find_collision().
+ *
+ * @param shape1 the vertices of the first shape
+ * @param size1 the number of vertices in the first shape
+ * @param shape2 the vertices of the second shape
+ * @param size2 the number of vertices in the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis.
+ */
+collision_info_t find_vertices_collision(const vector_t *shape1, size_t size1,
+                                         const vector_t *shape2, size_t size2);
+
+/**
+ * Computes the status of the collision between two convex polygons
+ * whose unit edge normals are already known (see vertices_edge_normals()),
+ * e.g. cached by a body. Behaves exactly like find_vertices_collision(),
+ * but never allocates and does no square roots.
+ *
+ * @param shape1 the vertices of the first shape
+ * @param normals1 the unit normals of the first shape's edges
+ * @param size1 the number of vertices in the first shape
+ * @param shape2 the vertices of the second shape
+ * @param normals2 the unit normals of the second shape's edges
+ * @param size2 the number of vertices in the second shape
+ * @param cache if non-NULL, the pair's separating axis cache,
+ *   which is tried first and then updated
+ * @return whether the shapes are colliding, and if so, the collision axis.
+ */
+collision_info_t find_normals_collision(const vector_t *shape1,
+                                        const vector_t *normals1, size_t size1,
+                                        const vector_t *shape2,
+                                        const vector_t *normals2, size_t size2,
+                                        separating_axis_cache_t *cache);
+
+/**
+ * Computes the status of the collision between two circles.
+ *
+ * @param center1 the center of the first circle
+ * @param radius1 the radius of the first circle
+ * @param center2 the center of the second circle
+ * @param radius2 the radius of the second circle
+ * @return whether the circles are colliding, and if so, the unit axis
+ * from the first circle's center towards the second's.
+ */
+collision_info_t find_circles_collision(vector_t center1, double radius1,
+                                        vector_t center2, double radius2);
+
+/**
+ * Computes the status of the collision between a circle and a convex polygon
+ * whose unit edge normals are known (see vertices_edge_normals()).
+ * Only the polygon's normals and the axis from its closest vertex to the
+ * circle's center need to be tested.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param shape the vertices of the polygon
+ * @param normals the unit normals of the polygon's edges
+ * @param size the number of vertices in the polygon
+ * @param cache if non-NULL, the pair's separating axis cache,
+ *   which is tried first and then updated
+ * @return whether the shapes are colliding, and if so, the collision axis,
+ * pointing from the circle towards the polygon.
+ */
+collision_info_t find_circle_polygon_collision(vector_t center, double radius,
+                                               const vector_t *shape,
+                                               const vector_t *normals,
+                                               size_t size,
+                                               separating_axis_cache_t *cache);
+
+/**
+ * Computes the status of the collision between two bodies, using the exact
+ * circle routines for circle bodies and the cached edge normals of polygon
+ * bodies (see body_view_normals()).
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param cache if non-NULL, the pair's separating axis cache, which is only
+ *   used if one of the bodies is a polygon
+ * @return whether the bodies are colliding, and if so, the collision axis,
+ * pointing from body1 towards body2.
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2,
+                                     separating_axis_cache_t *cache);
+
 #endif // #ifndef __COLLISION_H__
@@ -11,17 +11,6 @@ typedef struct const_body_aux {
   free_func_t freer;
 } const_body_aux_t;
 
-/**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux);
-
 // TODO (added for forces to work in tankz demo)
 void const_body_aux_free(void *aux);
 
@@ -45,6 +34,128 @@ const_body_aux_t *const_body_aux_init(list_t *consts, list_t *bodies);
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
+/**
+ * Adds a force creator to a scene that applies gravity between every pair of
+ * bodies in it, including bodies added later.
+ * Unlike calling create_newtonian_gravity() on every pair, which adds
+ * O(bodies ** 2) force creators, this adds one force creator that rebuilds a
+ * Barnes-Hut quadtree (see barnes_hut.h) over the bodies each tick and
+ * approximates distant groups of bodies by their center of mass.
+ * Bodies with infinite mass are left out. Static and kinematic bodies
+ * still attract the others, but are not moved themselves.
+ * As in create_newtonian_gravity(), no force is applied between bodies
+ * (or groups of bodies) closer than the same minimum distance.
+ * Asserts that theta is non-negative.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the Barnes-Hut opening angle; 0 computes every pair exactly,
+ *   larger values are faster but less accurate (0.5 is a common choice)
+ */
+void create_gravity_field(scene_t *scene, double G, double theta);
+
+/**
+ * A short-range force between two bodies, e.g. repulsion or cohesion between
+ * particles, computed by create_pair_interaction().
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param offset the vector from body1's centroid to body2's centroid,
+ *   which is always shorter than the interaction's cutoff
+ * @param aux the auxiliary value passed to create_pair_interaction()
+ * @return the force on body1; body2 gets the opposite force
+ */
+typedef vector_t (*pair_kernel_t)(body_t *body1, body_t *body2,
+                                  vector_t offset, void *aux);
+
+/**
+ * Adds a force creator to a scene that applies a short-range force between
+ * every pair of bodies in a group whose centroids are closer than a cutoff.
+ * Unlike adding a force creator for every pair, the force keeps a Verlet
+ * list of the pairs within cutoff + skin of each other, found with a
+ * spatial_grid_t. The list is only rebuilt once some body has moved more
+ * than skin / 2 since it was built, or the group has changed, so a tick
+ * costs O(bodies + pairs in the list) rather than O(bodies ** 2).
+ * A larger skin rebuilds less often but checks more pairs each tick.
+ * Removing a body drops it from the group, see
+ * scene_add_group_force_creator().
+ * Asserts that cutoff is positive and skin is non-negative.
+ *
+ * @param scene the scene containing the bodies
+ * @param bodies the bodies that interact with each other.
+ *   This list does not own the bodies, so its freer should be NULL.
+ *   The scene takes over the list, so it must not be used afterwards.
+ * @param cutoff the distance at which bodies stop interacting
+ * @param skin how much further than the cutoff to look for neighbors
+ * @param kernel the function computing the force between a pair of bodies
+ * @param aux an auxiliary value to pass to kernel
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void create_pair_interaction(scene_t *scene, list_t *bodies, double cutoff,
+                             double skin, pair_kernel_t kernel, void *aux,
+                             free_func_t freer);
+
+/**
+ * A network of springs between bodies, e.g. a cloth, rope or soft body,
+ * created by create_spring_network().
+ * All the springs live in one array and are applied in one loop,
+ * instead of one create_spring() force creator (and its allocations) each.
+ */
+typedef struct spring_network spring_network_t;
+
+/**
+ * Adds a force creator to a scene that applies every spring in a network.
+ * Each spring pulls its two bodies toward its rest length with Hooke's-Law
+ * force k * stretch, and damps their relative velocity along it.
+ *
+ * The explicit solver adds each spring's force, like create_spring().
+ * With a stiff network (large k / mass * dt ** 2), that overshoots and blows
+ * up, so the implicit solver instead applies the impulse from a backward
+ * Euler step of each spring in turn (using scene_get_tick_dt()), updating
+ * the velocities as it goes. It loses some energy to numerical damping but
+ * stays stable at much larger time steps.
+ *
+ * Removing a body drops it and its springs from the network,
+ * see scene_add_group_force_creator().
+ *
+ * @param scene the scene containing the bodies
+ * @param bodies the bodies the springs connect.
+ *   This list does not own the bodies, so its freer should be NULL.
+ *   The scene takes over the list, so it must not be used afterwards.
+ * @param implicit whether to use the implicit solver
+ * @return the network, which is freed along with the scene
+ *   or with its last body
+ */
+spring_network_t *create_spring_network(scene_t *scene, list_t *bodies,
+                                        bool implicit);
+
+/**
+ * Adds a spring to a network.
+ * Restoring a snapshot taken before the spring was added drops it again.
+ * Asserts that the bodies are different and in the network,
+ * and that k and damping are non-negative.
+ *
+ * @param network a network returned from create_spring_network()
+ * @param body1 the index of the first body in the network's bodies.
+ *   Bodies after a removed body move down one index once it is dropped,
+ *   and back up if a snapshot restores it (see scene_restore()).
+ * @param body2 the index of the second body in the network's bodies
+ * @param k the Hooke's constant for the spring
+ * @param rest_length the distance between the bodies' centroids at which the
+ *   spring applies no force
+ * @param damping the force per unit of relative velocity along the spring
+ */
+void spring_network_add(spring_network_t *network, size_t body1, size_t body2,
+                        double k, double rest_length, double damping);
+
+/**
+ * Gets the number of springs in a network.
+ *
+ * @param network a network returned from create_spring_network()
+ * @return the number of springs whose bodies are both still in the network
+ */
+size_t spring_network_size(spring_network_t *network);
+
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
  * The force creator will be called each tick
@@ -71,9 +182,75 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
  */
 void create_drag(scene_t *scene, double gamma, body_t *body);
 
+/**
+ * A wind or current, e.g. for create_wind_field().
+ *
+ * @param position where to sample the field
+ * @param aux the auxiliary value passed to create_wind_field()
+ * @return the velocity of the air (or water) at the position
+ */
+typedef vector_t (*vector_field_t)(vector_t position, void *aux);
+
+/**
+ * Adds a force creator to a scene that gives every selected body the same
+ * acceleration, e.g. gravity near the ground, in one pass over the bodies.
+ * Unlike a force creator per body, this adds one force creator however many
+ * bodies there are, and selects bodies added later too.
+ *
+ * Field forces (this, create_field_drag() and create_wind_field()) only
+ * act on dynamic bodies with finite mass that are awake, see body_kind_t and
+ * scene_enable_sleeping(). They select bodies by collision category (see
+ * body_set_collision_filter()): a body is selected if its category shares a
+ * bit with categories, or every body is if categories is 0.
+ *
+ * @param scene the scene containing the bodies
+ * @param acceleration the acceleration of each body
+ * @param categories the collision categories of the bodies to act on,
+ *   or 0 for every body
+ */
+void create_uniform_gravity(scene_t *scene, vector_t acceleration,
+                            uint32_t categories);
+
+/**
+ * Adds a field force to a scene that slows down every selected body, see
+ * create_uniform_gravity().
+ * The force on a body with velocity v is -(linear + quadratic * |v|) * v,
+ * so linear drag is create_drag() applied to every body.
+ * Asserts that both coefficients are non-negative.
+ *
+ * @param scene the scene containing the bodies
+ * @param linear the drag force per unit of speed
+ * @param quadratic the drag force per unit of speed squared
+ * @param categories the collision categories of the bodies to act on,
+ *   or 0 for every body
+ */
+void create_field_drag(scene_t *scene, double linear, double quadratic,
+                       uint32_t categories);
+
+/**
+ * Adds a field force to a scene that pushes every selected body along with
+ * a wind, see create_uniform_gravity().
+ * The force on a body with velocity v at a point where the wind blows at w
+ * is gamma * (w - v), so a body drifts with the wind and a still wind is
+ * just linear drag.
+ * Asserts that gamma is non-negative.
+ *
+ * @param scene the scene containing the bodies
+ * @param wind the wind velocity at each point
+ * @param gamma the force per unit of speed relative to the wind
+ * @param aux an auxiliary value to pass to wind
+ * @param freer if non-NULL, a function to call in order to free aux
+ * @param categories the collision categories of the bodies to act on,
+ *   or 0 for every body
+ */
+void create_wind_field(scene_t *scene, vector_field_t wind, double gamma,
+                       void *aux, free_func_t freer, uint32_t categories);
+
 /**
  * Adds a force creator to a scene that randomly applies an impulse to
  * a body each tick.
+ * The random numbers come from the scene's seed (see scene_set_seed()),
+ * so the same seed gives the same impulses on every run.
  *
  * @param scene the scene containing the bodies
  * @param probability the probability the random impule
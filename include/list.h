@@ -1,6 +1,7 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -16,6 +17,12 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * A function that decides whether list_filter() keeps an element.
+ * Takes in the element and an auxiliary value.
+ */
+typedef bool (*list_keep_func_t)(void *object, void *aux);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -75,4 +82,31 @@ void *list_remove(list_t *list, size_t index);
  */
 void list_add(list_t *list, void *value);
 
+/**
+ * Sorts the elements of a list in place, like qsort().
+ * The comparison function is passed pointers to two elements of the list,
+ * i.e. each argument is really a void** (or body_t**, etc.).
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param compare returns a negative number, 0, or a positive number
+ *   if the first element belongs before, with, or after the second
+ */
+void list_sort(list_t *list, int (*compare)(const void *, const void *));
+
+/**
+ * Removes every element of a list that keep() rejects, in a single pass.
+ * The kept elements stay in their original order. Rejected elements are
+ * freed with the list's freer, if it has one.
+ * Unlike calling list_remove() on each rejected element, this takes O(n) time
+ * no matter how many elements are removed.
+ * keep() is called exactly once per element, in order, so it may also do any
+ * cleanup a rejected element needs before it is freed.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param keep returns whether to keep an element
+ * @param aux an auxiliary value to pass to keep()
+ * @return the number of elements removed
+ */
+size_t list_filter(list_t *list, list_keep_func_t keep, void *aux);
+
 #endif // #ifndef __LIST_H__
@@ -0,0 +1,75 @@
+#ifndef __PAIR_TABLE_H__
+#define __PAIR_TABLE_H__
+
+#include "list.h"
+#include <stddef.h>
+
+/**
+ * A hash table keyed by an unordered pair of pointers, e.g. two bodies.
+ * The pair (a, b) is the same key as (b, a).
+ * Each key maps to one non-NULL value of any pointer type.
+ * The table automatically grows when more capacity is needed.
+ */
+typedef struct pair_table pair_table_t;
+
+/**
+ * Allocates memory for an empty pair table.
+ *
+ * @param initial_size the number of pairs to allocate space for
+ * @param freer if non-NULL, a function to call on the values still in the
+ *   table in pair_table_free()
+ * @return a pointer to the newly allocated table
+ */
+pair_table_t *pair_table_init(size_t initial_size, free_func_t freer);
+
+/**
+ * Releases the memory allocated for a pair table and, if it has a freer,
+ * the values it contains. The keys are never freed.
+ *
+ * @param table a pointer to a table returned from pair_table_init()
+ */
+void pair_table_free(pair_table_t *table);
+
+/**
+ * Gets the number of pairs stored in a pair table.
+ *
+ * @param table a pointer to a table returned from pair_table_init()
+ * @return the number of pairs
+ */
+size_t pair_table_size(pair_table_t *table);
+
+/**
+ * Gets the value stored for a pair.
+ *
+ * @param table a pointer to a table returned from pair_table_init()
+ * @param first one pointer of the pair
+ * @param second the other pointer of the pair
+ * @return the value for the pair, or NULL if the pair is not in the table
+ */
+void *pair_table_get(pair_table_t *table, const void *first,
+                     const void *second);
+
+/**
+ * Stores a value for a pair, replacing (but not freeing) any existing value.
+ * Asserts that the keys and the value are non-NULL.
+ *
+ * @param table a pointer to a table returned from pair_table_init()
+ * @param first one pointer of the pair
+ * @param second the other pointer of the pair
+ * @param value the value to store
+ */
+void pair_table_put(pair_table_t *table, const void *first, const void *second,
+                    void *value);
+
+/**
+ * Removes a pair from a pair table and returns its value without freeing it.
+ *
+ * @param table a pointer to a table returned from pair_table_init()
+ * @param first one pointer of the pair
+ * @param second the other pointer of the pair
+ * @return the removed value, or NULL if the pair was not in the table
+ */
+void *pair_table_remove(pair_table_t *table, const void *first,
+                        const void *second);
+
+#endif // #ifndef __PAIR_TABLE_H__
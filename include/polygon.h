@@ -9,6 +9,185 @@ typedef struct {
   double max;
 } range_t;
 
+/**
+ * An axis-aligned bounding box, spanning min.x to max.x and min.y to max.y.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * A polygon whose vertices are stored contiguously in a single growable array.
+ * Unlike a list_t of individually allocated vector_t*, walking the vertices of
+ * a polygon_t touches one block of memory and needs no allocation per vertex.
+ * The list_t-based functions below are kept as adapters for existing callers.
+ */
+typedef struct polygon polygon_t;
+
+/**
+ * A borrowed, read-only view of a contiguous vertex array,
+ * e.g. the vertices of a polygon_t or of a body's current shape.
+ * The view does not own the vertices, so it is never freed,
+ * and it is only valid for as long as the owner documents.
+ */
+typedef struct {
+  const vector_t *vertices;
+  size_t size;
+} polygon_view_t;
+
+/**
+ * Allocates memory for a new polygon with space for the given number of
+ * vertices. The polygon initially has no vertices.
+ *
+ * @param initial_size the number of vertices to allocate space for
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_init(size_t initial_size);
+
+/**
+ * Allocates a polygon holding a copy of the vertices in a list.
+ * The list is not modified or freed.
+ *
+ * @param vertices a list of vector_t* describing the polygon
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_from_list(list_t *vertices);
+
+/**
+ * Allocates a list holding a copy of the vertices of a polygon.
+ * The list owns its vertices, so it must be list_free()d.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a newly allocated list of vector_t*
+ */
+list_t *polygon_to_list(polygon_t *polygon);
+
+/**
+ * Allocates a polygon holding a copy of the vertices of another polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the newly allocated copy
+ */
+polygon_t *polygon_copy(polygon_t *polygon);
+
+/**
+ * Releases the memory allocated for a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ */
+void polygon_free(polygon_t *polygon);
+
+/**
+ * Gets the number of vertices in a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the number of vertices
+ */
+size_t polygon_size(polygon_t *polygon);
+
+/**
+ * Gets the contiguous vertex array of a polygon.
+ * The pointer stays valid until the next polygon_add() or polygon_free().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the first of polygon_size() vertices
+ */
+vector_t *polygon_vertices(polygon_t *polygon);
+
+/**
+ * Gets a read-only view of the vertices of a polygon.
+ * The view is valid until the next polygon_add() or polygon_free().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a view of the polygon's vertices
+ */
+polygon_view_t polygon_view(polygon_t *polygon);
+
+/**
+ * Gets the vertex at a given index in a polygon.
+ * Asserts that the index is valid.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param index an index in the polygon (the first vertex is at 0)
+ * @return the vertex at the given index
+ */
+vector_t polygon_get(polygon_t *polygon, size_t index);
+
+/**
+ * Appends a vertex to the end of a polygon, growing its array if needed.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param vertex the vertex to add
+ */
+void polygon_add(polygon_t *polygon, vector_t vertex);
+
+/**
+ * Computes the area of the polygon described by a vertex array.
+ * See polygon_area().
+ *
+ * @param vertices the vertices of the polygon, counterclockwise
+ * @param size the number of vertices
+ * @return the area of the polygon
+ */
+double vertices_area(const vector_t *vertices, size_t size);
+
+/**
+ * Computes the center of mass of the polygon described by a vertex array.
+ * See polygon_centroid().
+ *
+ * @param vertices the vertices of the polygon, counterclockwise
+ * @param size the number of vertices
+ * @return the centroid of the polygon
+ */
+vector_t vertices_centroid(const vector_t *vertices, size_t size);
+
+/**
+ * Translates every vertex in a vertex array by a given vector.
+ *
+ * @param vertices the vertices to translate
+ * @param size the number of vertices
+ * @param translation the vector to add to each vertex
+ */
+void vertices_translate(vector_t *vertices, size_t size, vector_t translation);
+
+/**
+ * Rotates every vertex in a vertex array by a given angle about a point.
+ *
+ * @param vertices the vertices to rotate
+ * @param size the number of vertices
+ * @param angle the angle to rotate by, in radians (positive is
+ * counterclockwise)
+ * @param point the point to rotate around
+ */
+void vertices_rotate(vector_t *vertices, size_t size, double angle,
+                     vector_t point);
+
+/**
+ * Computes a unit normal to every edge of a vertex array, where edge i runs
+ * from vertex i to vertex i + 1 (wrapping around).
+ * These are the separating axes to test for a convex polygon.
+ *
+ * @param vertices the vertices of the polygon, in counterclockwise order
+ * @param size the number of vertices
+ * @param normals an array with room for size vectors to write the normals into
+ */
+void vertices_edge_normals(const vector_t *vertices, size_t size,
+                           vector_t *normals);
+
+/**
+ * Computes the range occupied by the projection of a vertex array onto an
+ * axis. See polygon_proj().
+ *
+ * @param vertices the vertices to project
+ * @param size the number of vertices
+ * @param axis the axis onto which to project the vertices
+ * @param normalize whether to normalize the axis
+ * @return the range of the scalar projection of the vertices onto the axis
+ */
+range_t vertices_proj(const vector_t *vertices, size_t size, vector_t axis,
+                      bool normalize);
+
 /**
  * Computes the area of a polygon.
  * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
@@ -63,4 +242,32 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point);
  */
 range_t polygon_proj(list_t *polygon, vector_t axis, bool normalize);
 
+/**
+ * Computes the smallest axis-aligned box containing every vertex in an array.
+ *
+ * @param vertices the vertices to bound
+ * @param size the number of vertices
+ * @return the bounding box of the vertices
+ */
+aabb_t vertices_bounds(const vector_t *vertices, size_t size);
+
+/**
+ * Returns whether two axis-aligned boxes overlap (touching counts).
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether the boxes share at least one point
+ */
+bool aabb_overlap(aabb_t box1, aabb_t box2);
+
+/**
+ * Returns whether a line segment passes through an axis-aligned box.
+ *
+ * @param box the box
+ * @param start one end of the segment
+ * @param end the other end of the segment
+ * @return whether any point of the segment lies in the box
+ */
+bool aabb_segment_overlap(aabb_t box, vector_t start, vector_t end);
+
 #endif // #ifndef __POLYGON_H__
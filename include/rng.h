@@ -0,0 +1,97 @@
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Counter-based random numbers (the Philox4x32-10 generator).
+ * Unlike rand(), there is no hidden state: a random number is a pure function
+ * of a seed, a stream and a counter, so the same three always give the same
+ * number and different ones give independent numbers. This makes random
+ * forces reproducible from a seed and safe to draw from any thread.
+ *
+ * Streams separate independent users of one seed, e.g. one stream per body
+ * or per force, and counters pick a number within a stream, e.g. the tick.
+ */
+
+/**
+ * A sequence of random numbers from one stream.
+ * Each draw uses the current counter and then increments it, so copying an
+ * rng_t replays its numbers, and setting counter jumps to any point.
+ */
+typedef struct rng {
+  uint64_t seed;
+  uint64_t stream;
+  uint64_t counter;
+} rng_t;
+
+/**
+ * Gets 64 random bits for a seed, stream and counter.
+ *
+ * @param seed the seed, e.g. a scene's seed
+ * @param stream which independent stream to draw from
+ * @param counter which number in the stream to draw
+ * @return the random bits
+ */
+uint64_t rng_bits(uint64_t seed, uint64_t stream, uint64_t counter);
+
+/**
+ * Gets a random number in [0, 1) for a seed, stream and counter.
+ * The number is a multiple of 2 ** -53, so every double in [0, 1) with that
+ * spacing is equally likely.
+ *
+ * @param seed the seed, e.g. a scene's seed
+ * @param stream which independent stream to draw from
+ * @param counter which number in the stream to draw
+ * @return the random number
+ */
+double rng_uniform(uint64_t seed, uint64_t stream, uint64_t counter);
+
+/**
+ * Starts a sequence of random numbers at the beginning of a stream.
+ *
+ * @param seed the seed
+ * @param stream which independent stream to draw from
+ * @return the sequence, with its counter at 0
+ */
+rng_t rng_init(uint64_t seed, uint64_t stream);
+
+/**
+ * Draws the next 64 random bits from a sequence.
+ *
+ * @param rng a pointer to a sequence returned from rng_init()
+ * @return the random bits
+ */
+uint64_t rng_next(rng_t *rng);
+
+/**
+ * Draws the next random number in [0, 1) from a sequence.
+ *
+ * @param rng a pointer to a sequence returned from rng_init()
+ * @return the random number
+ */
+double rng_next_double(rng_t *rng);
+
+/**
+ * Draws the next random number in [min, max) from a sequence.
+ * Asserts that min <= max.
+ *
+ * @param rng a pointer to a sequence returned from rng_init()
+ * @param min the smallest number that can be drawn
+ * @param max the bound the numbers stay below
+ * @return the random number
+ */
+double rng_next_range(rng_t *rng, double min, double max);
+
+/**
+ * Draws the next random index in [0, n) from a sequence.
+ * Asserts that n is positive.
+ *
+ * @param rng a pointer to a sequence returned from rng_init()
+ * @param n the number of possible indices
+ * @return the random index
+ */
+size_t rng_next_index(rng_t *rng, size_t n);
+
+#endif // #ifndef __RNG_H__
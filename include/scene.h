@@ -3,6 +3,8 @@
 
 #include "body.h"
 #include "list.h"
+#include "slot_map.h"
+#include <stdint.h>
 
 /**
  * A collection of bodies and force creators.
@@ -11,6 +13,18 @@
  */
 typedef struct scene scene_t;
 
+/**
+ * A saved copy of a scene's state, see scene_snapshot().
+ */
+typedef struct scene_snapshot scene_snapshot_t;
+
+/**
+ * A stable reference to a body in a scene.
+ * Body indices shift whenever a body before them is removed, but a handle
+ * keeps referring to its body, and becomes stale once the body is removed.
+ */
+typedef slot_handle_t body_handle_t;
+
 /**
  * A function which adds some forces or impulses to bodies,
  * e.g. from collisions, gravity, or spring forces.
@@ -18,6 +32,72 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * The bodies and constants of a built-in force, e.g. a spring or drag,
+ * stored inline so adding one allocates nothing.
+ * See scene_add_force_record().
+ */
+typedef struct force_record {
+  body_t *body1;
+  // The second body, or NULL for a force on one body
+  body_t *body2;
+  // The force's constants, e.g. a spring's k. Their meaning is up to the
+  // force's kernel.
+  double constants[2];
+  // Set by scene_add_force_record() to a number no other record in the
+  // scene has, so a kernel can give each record its own random stream
+  uint64_t stream;
+} force_record_t;
+
+/**
+ * A function which applies one kind of built-in force for every record of
+ * that kind in a scene, e.g. every spring, in a single loop.
+ * It should skip records whose bodies are idle (see force_record_is_idle()).
+ *
+ * @param scene the scene being ticked, e.g. for scene_get_seed()
+ * @param records the scene's records of this kind
+ * @param count the number of records
+ */
+typedef void (*force_kernel_t)(scene_t *scene, force_record_t *records,
+                               size_t count);
+
+/**
+ * A function called when two bodies start colliding.
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value registered with the handler
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                    void *aux);
+
+/**
+ * The kinds of contact events a scene reports to collision event handlers.
+ * They are bits, so a handler can ask for several kinds at once.
+ */
+typedef enum {
+  /** The bodies started touching this tick */
+  COLLISION_BEGIN = 1 << 0,
+  /** The bodies were already touching and still are */
+  COLLISION_PERSIST = 1 << 1,
+  /** The bodies stopped touching this tick */
+  COLLISION_END = 1 << 2
+} collision_event_t;
+
+/**
+ * A function called for a contact event between two bodies.
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param event the kind of event
+ * @param axis a unit vector pointing from body1 towards body2 that the bodies
+ *   are colliding in. For COLLISION_END, the last axis they collided in.
+ * @param aux the auxiliary value registered with the handler
+ */
+typedef void (*collision_event_handler_t)(body_t *body1, body_t *body2,
+                                          collision_event_t event,
+                                          vector_t axis, void *aux);
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -53,13 +133,36 @@ size_t scene_bodies(scene_t *scene);
  */
 body_t *scene_get_body(scene_t *scene, size_t index);
 
+/**
+ * Gets the handle of the body at a given index in a scene.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the body in the scene (starting at 0)
+ * @return the handle returned when the body was added
+ */
+body_handle_t scene_get_handle(scene_t *scene, size_t index);
+
+/**
+ * Looks up a body by its handle in O(1).
+ * Unlike an index, a handle keeps referring to the same body as other bodies
+ * are added and removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from scene_add_body()
+ * @return the body, or NULL if it has been removed from the scene
+ *   (bodies marked for removal are removed at the end of scene_tick())
+ */
+body_t *scene_get_body_by_handle(scene_t *scene, body_handle_t handle);
+
 /**
  * Adds a body to a scene.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to the body to add to the scene
+ * @return a handle to the body, see scene_get_body_by_handle()
  */
-void scene_add_body(scene_t *scene, body_t *body);
+body_handle_t scene_add_body(scene_t *scene, body_t *body);
 
 /**
  * @deprecated Use body_remove() instead
@@ -72,6 +175,15 @@ void scene_add_body(scene_t *scene, body_t *body);
  */
 void scene_remove_body(scene_t *scene, size_t index);
 
+/**
+ * Marks the body a handle refers to for removal, like scene_remove_body().
+ * Does nothing if the body has already been removed from the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from scene_add_body()
+ */
+void scene_remove_body_by_handle(scene_t *scene, body_handle_t handle);
+
 /**
  * @deprecated Use scene_add_bodies_force_creator() instead
  * so the scene knows which bodies the force creator depends on
@@ -99,16 +211,399 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a built-in force to a scene as a compact record, instead of a force
+ * creator with its own aux and list of bodies.
+ * Records are kept in one array per kernel, and each tick every kernel is
+ * called once on all of its records, before any force creator runs.
+ * Like a force creator from scene_add_bodies_force_creator(), a record is
+ * removed along with either of its bodies, and links its bodies into one
+ * island for sleeping (see scene_enable_sleeping()). A removed record's
+ * place is taken by the last record of its kind, so kernels should not
+ * depend on the order of their records.
+ * Kernels always run on the calling thread, see scene_set_threads().
+ * Asserts that the record's first body is non-NULL.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function that applies this kind of force
+ * @param record the force's bodies and constants, which are copied
+ *   (its stream is overwritten)
+ */
+void scene_add_force_record(scene_t *scene, force_kernel_t kernel,
+                            force_record_t record);
+
+/**
+ * Returns whether all of a force record's bodies are asleep or static,
+ * so applying it could not move them.
+ *
+ * @param record a record passed to a force_kernel_t
+ * @return whether the kernel should skip the record
+ */
+bool force_record_is_idle(force_record_t *record);
+
+/**
+ * Adds a force creator that is safe to run at the same time as force
+ * creators acting on other bodies, see scene_set_threads().
+ * It must only read and write its own bodies and aux, e.g. a spring or drag.
+ * Otherwise acts like scene_add_bodies_force_creator().
+ * Asserts that bodies is non-NULL.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies the force creator acts on
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_parallel_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies,
+                                      free_func_t freer);
+
+/**
+ * Makes snapshots of a scene save part of a force creator's aux, so
+ * scene_restore() puts it back, e.g. whether a collision's bodies were
+ * already touching. The state is copied byte for byte, so it must not
+ * hold pointers to memory the force creator frees or reallocates.
+ * Asserts that a force creator in the scene was added with this aux.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param aux the aux the force creator was added with
+ * @param state the part of the force creator's state to save
+ * @param size the number of bytes to save
+ */
+void scene_add_force_state(scene_t *scene, void *aux, void *state,
+                           size_t size);
+
+/**
+ * Adds a force creator that acts on a changing group of bodies, e.g.
+ * short-range forces between particles.
+ * Unlike scene_add_bodies_force_creator(), removing one of the bodies does
+ * not remove the force creator. The body is dropped from bodies at the end
+ * of the tick it is removed in, and the force creator is only removed along
+ * with the last of its bodies.
+ * A group does not link its bodies into one island for sleeping (see
+ * scene_enable_sleeping()); the forces it applies still wake the bodies.
+ * Asserts that bodies is non-NULL.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called.
+ *   It may keep a pointer to bodies in order to read the current group,
+ *   but must not change or free the list.
+ * @param bodies the list of bodies in the group.
+ *   This list does not own the bodies, so its freer should be NULL.
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_group_force_creator(scene_t *scene, force_creator_t forcer,
+                                   void *aux, list_t *bodies,
+                                   free_func_t freer);
+
+/**
+ * Adds a contact force creator to a scene, e.g. a collision check.
+ * A contact force only does anything while its first two bodies touch.
+ * Without a broad phase it behaves exactly like
+ * scene_add_bodies_force_creator(). With a broad phase enabled (see
+ * scene_enable_grid() and scene_enable_aabb_tree()), forcer is only called on
+ * ticks where the bounding boxes of the first two bodies overlap, and
+ * separator (if non-NULL) is called once on the first tick they stop
+ * overlapping, so the force can reset any "currently touching" state it keeps
+ * in aux.
+ * Asserts that bodies contains at least two bodies.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param separator a function to call with aux when the bodies stop being
+ *   candidates for contact, or NULL
+ * @param aux an auxiliary value to pass to forcer and separator
+ * @param bodies the list of bodies affected by the force creator,
+ *   starting with the two bodies whose contact it checks
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_contact_force_creator(scene_t *scene, force_creator_t forcer,
+                                     force_creator_t separator, void *aux,
+                                     list_t *bodies, free_func_t freer);
+
+/**
+ * Registers a collision handler for every pair of bodies in two collision
+ * categories (see body_set_collision_filter()), instead of adding a
+ * collision force for each pair of bodies.
+ * Each tick, the scene tests the pairs of bodies whose filters let them
+ * collide and whose bounding boxes overlap (every such pair, without a broad
+ * phase), and calls the handler once when a pair starts colliding, like
+ * create_collision(). body1 is always the body in category1.
+ * Pairs of static bodies are never tested.
+ *
+ * Every pair is tested before any handler runs, on the scene's threads if it
+ * has several (see scene_set_threads()), so handlers never see a
+ * half-finished tick. The events are then dispatched in a deterministic
+ * order: pairs in the order the broad phase found them, then ended contacts.
+ * For each event, handlers run in the order they were registered.
+ * Events for a body that an earlier handler removed are skipped.
+ * Asserts that both categories are non-zero.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 the categories the first body must be in, e.g. shots
+ * @param category2 the categories the second body must be in, e.g. walls
+ * @param handler the function to call when two such bodies collide
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_handler(scene_t *scene, uint32_t category1,
+                                 uint32_t category2,
+                                 collision_handler_t handler, void *aux,
+                                 free_func_t freer);
+
+/**
+ * Registers a handler for contact events between every pair of bodies in two
+ * collision categories. Acts like scene_add_collision_handler(), but the
+ * handler is called for each of the given kinds of event, e.g. to notice
+ * when two bodies stop touching.
+ * No event is reported for a pair once one of its bodies is removed.
+ * Asserts that both categories and events are non-zero.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 the categories the first body must be in
+ * @param category2 the categories the second body must be in
+ * @param events the kinds of events to report, e.g.
+ *   COLLISION_BEGIN | COLLISION_END
+ * @param handler the function to call on each event
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_event_handler(scene_t *scene, uint32_t category1,
+                                       uint32_t category2, uint32_t events,
+                                       collision_event_handler_t handler,
+                                       void *aux, free_func_t freer);
+
+/**
+ * Enables a uniform spatial hash grid broad phase for a scene's contact
+ * forces and collision handlers. Each tick, the bodies' bounding boxes are
+ * bucketed into square cells and only bodies that share a cell are checked.
+ * Replaces any broad phase that was already enabled.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param cell_size the width of a grid cell, ideally about the size of a
+ *   typical body
+ */
+void scene_enable_grid(scene_t *scene, double cell_size);
+
+/**
+ * Enables a dynamic AABB tree broad phase for a scene's contact forces and
+ * collision handlers.
+ * Each body's bounding box is kept in a bounding volume hierarchy, which
+ * is updated as bodies move, are added and are removed. Unlike a grid,
+ * this works well when body sizes vary widely (e.g. borders and bullets).
+ * Replaces any broad phase that was already enabled.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param margin how far a body can move before its tree node is updated
+ */
+void scene_enable_aabb_tree(scene_t *scene, double margin);
+
+/**
+ * Disables a scene's broad phase, so every contact force runs every tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_disable_broad_phase(scene_t *scene);
+
+/**
+ * Switches a scene to structure-of-arrays body storage: every body in the
+ * scene, and every body added later, is attached to a body_store_t, and
+ * scene_tick() integrates them all in one vectorizable loop instead of
+ * calling body_tick() on each. Bodies move exactly as they would otherwise.
+ * Does nothing if the scene already uses a body store.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_enable_body_store(scene_t *scene);
+
+/**
+ * Sets how many threads scene_tick() uses.
+ * With more than one thread, the force creators added with
+ * scene_add_parallel_force_creator() are grouped into batches of forces on
+ * disjoint bodies, and each batch is spread across the threads. Every other
+ * force creator runs alone, in the order it was added, and bodies are ticked
+ * in parallel.
+ * Batching may change the order a body's forces are added up in, so bodies
+ * can move slightly differently (by rounding) than with one thread, but they
+ * move exactly the same for any number of threads above one.
+ * Under Emscripten, everything still runs on one thread.
+ * Asserts that num_threads is positive.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param num_threads the number of threads to use; 1 ticks serially
+ */
+void scene_set_threads(scene_t *scene, size_t num_threads);
+
 /**
  * Executes a tick of a given scene over a small time interval.
  * This requires executing all the force creators
  * and then ticking each body (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
+ * Force creators whose bodies are all static (see body_kind_t) are skipped,
+ * since nothing they do could move the bodies.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * Gets the time step of the tick in progress, so force creators that need
+ * it (e.g. to integrate stiff forces stably) can read it while they run.
+ * Between ticks, this is the time step of the last tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the dt passed to the current or last scene_tick(), or 0 if the
+ *   scene has never been ticked
+ */
+double scene_get_tick_dt(scene_t *scene);
+
+/**
+ * Gets the number of the tick in progress, so random forces can draw
+ * different numbers each tick. Between ticks, this is the number of ticks
+ * so far.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return 1 during the first scene_tick(), 2 during the second, and so on
+ */
+size_t scene_get_tick(scene_t *scene);
+
+/**
+ * Sets the seed of a scene's random numbers, e.g. for create_random_impulse().
+ * Random forces draw from rng_bits() keyed by the seed, the force and the
+ * tick, so two scenes built the same way with the same seed evolve the same
+ * way, whatever threads they tick on. The seed starts at 0.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param seed the new seed
+ */
+void scene_set_seed(scene_t *scene, uint64_t seed);
+
+/**
+ * Gets the seed of a scene's random numbers, see scene_set_seed().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the seed
+ */
+uint64_t scene_get_seed(scene_t *scene);
+
+/**
+ * Lets bodies in a scene fall asleep once they come to rest, so scene_tick()
+ * skips integrating them and skips force creators (including collision
+ * checks) whose bodies are all asleep.
+ * Bodies are grouped into islands linked by non-contact force creators,
+ * e.g. springs. An island falls asleep once all its bodies have moved slower
+ * than max_speed for delay seconds, and wakes as soon as a force or impulse
+ * (e.g. from a collision) would move any of its bodies.
+ * Bodies with infinite mass are never part of a bigger island.
+ * Asserts that max_speed and delay are non-negative.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param max_speed the speed a body must stay under to count as resting
+ * @param delay how long a body must rest before it can fall asleep, in seconds
+ */
+void scene_enable_sleeping(scene_t *scene, double max_speed, double delay);
+
+/**
+ * Stops bodies in a scene from falling asleep, and wakes every body.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_disable_sleeping(scene_t *scene);
+
+/**
+ * Makes scene_advance() simulate in fixed-size steps, so the simulation
+ * behaves the same at any frame rate.
+ * Asserts that step is non-negative and, if it is positive, that
+ * max_substeps is positive.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param step the number of seconds each scene_tick() simulates,
+ *   or 0 to tick by the whole frame time instead
+ * @param max_substeps the most steps to take in one scene_advance(), so a
+ *   slow frame cannot make the next one slower still
+ */
+void scene_set_fixed_step(scene_t *scene, double step, size_t max_substeps);
+
+/**
+ * Advances a scene by the time elapsed since the last frame.
+ * With a fixed step (see scene_set_fixed_step()), the time is added to an
+ * accumulator and scene_tick() is called once per whole step in it, up to
+ * the maximum number of substeps; any time beyond that is dropped.
+ * Each body's transform is saved before every step, so it can be drawn
+ * between the last two steps (see scene_get_interpolation()).
+ * Without a fixed step, this just calls scene_tick() once.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the time elapsed since the last frame, in seconds
+ * @return the number of times scene_tick() was called
+ */
+size_t scene_advance(scene_t *scene, double dt);
+
+/**
+ * Gets how far the time simulated by scene_advance() lags behind the time
+ * passed to it, as a fraction of a step. Drawing each body at
+ * body_get_interpolated_centroid() with this fraction makes motion smooth
+ * even when frames and steps do not line up.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a fraction in [0, 1), or 1 if the scene has no fixed step
+ */
+double scene_get_interpolation(scene_t *scene);
+
+/**
+ * Allocates memory for an empty snapshot of a scene.
+ * A snapshot's memory is reused each time it is taken, so keeping a ring
+ * buffer of snapshots (e.g. one per tick) only allocates while it fills up.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a pointer to the newly allocated snapshot
+ */
+scene_snapshot_t *scene_snapshot_init(scene_t *scene);
+
+/**
+ * Releases the memory allocated for a snapshot, along with any removed
+ * bodies and forces only it could restore. The scene is otherwise
+ * unaffected. May be called before or after the scene is freed.
+ *
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot_init()
+ */
+void scene_snapshot_free(scene_snapshot_t *snapshot);
+
+/**
+ * Saves the state of a scene into a snapshot, replacing what it held.
+ * This is which bodies, forces and force records the scene has, every
+ * body's state (see body_save_state()) and handle, the bodies of group
+ * forces, the contact state of each pair of bodies, the state of force
+ * creators registered with scene_add_force_state(), and the scene's tick
+ * and accumulated time. Bodies' info and other force creators' aux are not
+ * saved.
+ * While a snapshot is held, bodies and forces removed from the scene are
+ * not freed until no snapshot can restore them.
+ * Asserts that the snapshot was made for this scene.
+ * Should be called between ticks.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot_init()
+ */
+void scene_snapshot(scene_t *scene, scene_snapshot_t *snapshot);
+
+/**
+ * Puts a scene back into the state saved in a snapshot, e.g. to replay or
+ * undo the ticks since. Bodies and forces added since the snapshot was
+ * taken are removed, and those removed since are put back with the same
+ * handles, along with their force records. The scene then evolves as it
+ * did after the snapshot was taken, as long as it is ticked and changed
+ * the same way. With an AABB tree, contact events that happen on the same
+ * tick may be reported in a different order.
+ * Asserts that the snapshot was taken of this scene.
+ * Should be called between ticks.
+ *
+ * @param scene a pointer to the scene the snapshot was taken of
+ * @param snapshot a snapshot passed to scene_snapshot()
+ */
+void scene_restore(scene_t *scene, scene_snapshot_t *snapshot);
+
 #endif // #ifndef __SCENE_H__
@@ -3,6 +3,7 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -86,6 +87,27 @@ void display_clock(size_t countdown);
  */
 void sdl_draw_polygon(list_t *points, rgb_color_t color);
 
+/**
+ * Draws a polygon from a contiguous array of vertices and a color,
+ * e.g. a view returned by body_view_shape().
+ * Does not allocate unless the polygon is larger than any drawn before.
+ *
+ * @param vertices the vertices of the polygon
+ * @param n the number of vertices
+ * @param color the color used to fill in the polygon
+ */
+void sdl_draw_vertices(const vector_t *vertices, size_t n, rgb_color_t color);
+
+/**
+ * Draws a filled circle, e.g. a body created with body_init_circle().
+ * The circle is rasterized at draw time, so it stays round at any scale.
+ *
+ * @param center the center of the circle in scene coordinates
+ * @param radius the radius of the circle in scene units
+ * @param color the color used to fill in the circle
+ */
+void sdl_draw_circle(vector_t center, double radius, rgb_color_t color);
+
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
@@ -94,6 +116,8 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
+ * With a fixed step, bodies are drawn between their last two transforms
+ * according to scene_get_interpolation().
  * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
  * so those functions should not be called directly.
  *
@@ -0,0 +1,88 @@
+#ifndef __SLOT_MAP_H__
+#define __SLOT_MAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A map from generational handles to pointers.
+ * Inserting, looking up and removing are all O(1). Each slot has a
+ * generation that is bumped whenever its value is removed, so a handle to a
+ * removed value stays detectably stale even after its slot is reused.
+ */
+typedef struct slot_map slot_map_t;
+
+/**
+ * A reference to a value in a slot map.
+ * The zero handle {0, 0} never refers to a value, so it can be used as
+ * "no value".
+ */
+typedef struct slot_handle {
+  size_t index;
+  size_t generation;
+} slot_handle_t;
+
+/**
+ * Allocates memory for an empty slot map.
+ *
+ * @param initial_size the number of values to allocate space for
+ * @return a pointer to the newly allocated slot map
+ */
+slot_map_t *slot_map_init(size_t initial_size);
+
+/**
+ * Releases the memory allocated for a slot map. The values are never freed.
+ *
+ * @param map a pointer to a slot map returned from slot_map_init()
+ */
+void slot_map_free(slot_map_t *map);
+
+/**
+ * Gets the number of values in a slot map.
+ *
+ * @param map a pointer to a slot map returned from slot_map_init()
+ * @return the number of values inserted and not removed
+ */
+size_t slot_map_size(slot_map_t *map);
+
+/**
+ * Inserts a value into a slot map, reusing a free slot if there is one.
+ * Asserts that the value is not NULL.
+ *
+ * @param map a pointer to a slot map returned from slot_map_init()
+ * @param value the value to insert
+ * @return a handle to the value, valid until it is removed
+ */
+slot_handle_t slot_map_insert(slot_map_t *map, void *value);
+
+/**
+ * Looks up the value a handle refers to.
+ *
+ * @param map a pointer to a slot map returned from slot_map_init()
+ * @param handle a handle returned from slot_map_insert()
+ * @return the value, or NULL if it has been removed
+ */
+void *slot_map_get(slot_map_t *map, slot_handle_t handle);
+
+/**
+ * Removes the value a handle refers to, invalidating every copy of the handle.
+ * Does nothing if the value has already been removed.
+ *
+ * @param map a pointer to a slot map returned from slot_map_init()
+ * @param handle a handle returned from slot_map_insert()
+ * @return the removed value, or NULL if it had already been removed
+ */
+void *slot_map_remove(slot_map_t *map, slot_handle_t handle);
+
+/**
+ * Makes one slot map an exact copy of another, including which handles are
+ * stale and which slots will be reused next, so a copy taken earlier can
+ * later put a map back the way it was.
+ * Reuses the destination's memory when it is large enough.
+ *
+ * @param dest a pointer to the slot map to overwrite
+ * @param src a pointer to the slot map to copy
+ */
+void slot_map_copy(slot_map_t *dest, slot_map_t *src);
+
+#endif // #ifndef __SLOT_MAP_H__
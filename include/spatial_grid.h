@@ -0,0 +1,100 @@
+#ifndef __SPATIAL_GRID_H__
+#define __SPATIAL_GRID_H__
+
+#include "polygon.h"
+#include <stddef.h>
+
+/**
+ * A uniform spatial hash grid over axis-aligned bounding boxes.
+ * Each box is inserted into every square cell it touches, and only boxes that
+ * share a cell are ever compared, so finding overlapping pairs costs roughly
+ * O(boxes) instead of O(boxes ** 2) when boxes are no bigger than a few cells.
+ * Cells are hashed, so the grid is unbounded and only occupied cells use
+ * memory. The grid is meant to be cleared and refilled every tick.
+ */
+typedef struct spatial_grid spatial_grid_t;
+
+/**
+ * A function called for each pair of overlapping boxes in a grid.
+ *
+ * @param id1 the id the first box was inserted with
+ * @param id2 the id the second box was inserted with
+ * @param aux the auxiliary value passed to spatial_grid_pairs()
+ */
+typedef void (*grid_pair_handler_t)(size_t id1, size_t id2, void *aux);
+
+/**
+ * A function called for each box overlapping a query box.
+ *
+ * @param id the id the box was inserted with
+ * @param aux the auxiliary value passed to spatial_grid_query()
+ */
+typedef void (*grid_query_handler_t)(size_t id, void *aux);
+
+/**
+ * Allocates memory for an empty grid.
+ * Asserts that the cell size is positive.
+ *
+ * @param cell_size the width and height of each cell. A good choice is about
+ *   the size of the typical box inserted into the grid.
+ * @return a pointer to the newly allocated grid
+ */
+spatial_grid_t *spatial_grid_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a grid.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ */
+void spatial_grid_free(spatial_grid_t *grid);
+
+/**
+ * Removes every box from a grid, keeping its memory for reuse.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ */
+void spatial_grid_clear(spatial_grid_t *grid);
+
+/**
+ * Gets the number of boxes inserted since the grid was last cleared.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @return the number of boxes in the grid
+ */
+size_t spatial_grid_size(spatial_grid_t *grid);
+
+/**
+ * Inserts a box into a grid.
+ * Boxes covering a huge number of cells are kept in a separate list
+ * and compared against every other box instead.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param id an identifier passed back to handlers, e.g. a body index
+ * @param bounds the box to insert
+ */
+void spatial_grid_insert(spatial_grid_t *grid, size_t id, aabb_t bounds);
+
+/**
+ * Calls a handler once for every pair of boxes in a grid that overlap.
+ * Pairs are reported in a deterministic order that depends only on
+ * the order the boxes were inserted in.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param handler the function to call on each overlapping pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_grid_pairs(spatial_grid_t *grid, grid_pair_handler_t handler,
+                        void *aux);
+
+/**
+ * Calls a handler once for every box in a grid that overlaps a query box.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param bounds the box to look for overlaps with
+ * @param handler the function to call on each overlapping box
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_grid_query(spatial_grid_t *grid, aabb_t bounds,
+                        grid_query_handler_t handler, void *aux);
+
+#endif // #ifndef __SPATIAL_GRID_H__
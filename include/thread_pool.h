@@ -0,0 +1,67 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of worker threads that run parallel loops.
+ * Each loop is split into chunks that are dealt out evenly to the threads.
+ * A thread that finishes its own chunks steals chunks from the others, so
+ * uneven chunks still keep every thread busy.
+ *
+ * The thread calling thread_pool_for() works on the loop too.
+ * Under Emscripten, where threads are unavailable, loops run serially.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * A function that runs part of a parallel loop.
+ *
+ * @param aux the auxiliary value passed to thread_pool_for()
+ * @param start the first iteration to run
+ * @param end one past the last iteration to run
+ */
+typedef void (*pool_task_t)(void *aux, size_t start, size_t end);
+
+/**
+ * Allocates a thread pool and starts its threads.
+ * Asserts that num_threads is positive.
+ *
+ * @param num_threads the number of threads that run each loop,
+ *   counting the thread that calls thread_pool_for()
+ * @return a pointer to the newly allocated pool
+ */
+thread_pool_t *thread_pool_init(size_t num_threads);
+
+/**
+ * Stops a pool's threads and releases its memory.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+/**
+ * Gets the number of threads that run each of a pool's loops.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @return the number of threads, including the calling thread
+ */
+size_t thread_pool_threads(thread_pool_t *pool);
+
+/**
+ * Runs the iterations [0, count) of a loop across a pool's threads and waits
+ * for all of them to finish. The task is called on chunks of at most grain
+ * consecutive iterations, in no particular order, so it must be safe to run
+ * different chunks at the same time.
+ * Asserts that grain is positive.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @param count the number of iterations
+ * @param grain the largest number of iterations to give a thread at once
+ * @param task the function to run on each chunk
+ * @param aux an auxiliary value to pass to the task
+ */
+void thread_pool_for(thread_pool_t *pool, size_t count, size_t grain,
+                     pool_task_t task, void *aux);
+
+#endif // #ifndef __THREAD_POOL_H__
@@ -0,0 +1,419 @@
+#include "aabb_tree.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The number of nodes a tree allocates space for at first.
+ */
+const size_t TREE_INITIAL_NODES = 16;
+
+/**
+ * Stands in for a missing node, e.g. the parent of the root.
+ */
+const size_t TREE_NULL_NODE = SIZE_MAX;
+
+/**
+ * A node of the tree, either a leaf holding one box or an internal node
+ * whose fat box bounds both of its children.
+ * Unused nodes have a height of -1 and are chained through parent.
+ */
+typedef struct tree_node {
+  aabb_t fat;
+  // The exact box, only meaningful for leaves
+  aabb_t bounds;
+  void *data;
+  size_t parent;
+  size_t left;
+  size_t right;
+  // 0 for leaves, otherwise 1 more than the taller child
+  int height;
+} tree_node_t;
+
+struct aabb_tree {
+  double margin;
+  tree_node_t *nodes;
+  size_t capacity;
+  size_t root;
+  size_t free_list;
+  size_t size;
+};
+
+aabb_t aabb_union(aabb_t box1, aabb_t box2) {
+  return (aabb_t){{fmin(box1.min.x, box2.min.x), fmin(box1.min.y, box2.min.y)},
+                  {fmax(box1.max.x, box2.max.x), fmax(box1.max.y, box2.max.y)}};
+}
+
+/**
+ * The cost of a box when choosing where to insert, as in the surface area
+ * heuristic. In 2D, the chance of a random ray hitting a box grows with its
+ * perimeter.
+ */
+double aabb_perimeter(aabb_t box) {
+  return 2 * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
+
+bool aabb_contains(aabb_t outer, aabb_t inner) {
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+         inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+/**
+ * Adds the nodes in [start, end) to the front of the free list.
+ */
+void tree_free_nodes(aabb_tree_t *tree, size_t start, size_t end) {
+  for (size_t i = end; i > start; i--) {
+    tree->nodes[i - 1].height = -1;
+    tree->nodes[i - 1].parent = tree->free_list;
+    tree->free_list = i - 1;
+  }
+}
+
+aabb_tree_t *aabb_tree_init(double margin) {
+  assert(margin >= 0);
+
+  aabb_tree_t *tree = malloc(sizeof(aabb_tree_t));
+  assert(tree != NULL);
+  tree->margin = margin;
+  tree->nodes = malloc(sizeof(tree_node_t) * TREE_INITIAL_NODES);
+  assert(tree->nodes != NULL);
+  tree->capacity = TREE_INITIAL_NODES;
+  tree->root = TREE_NULL_NODE;
+  tree->free_list = TREE_NULL_NODE;
+  tree->size = 0;
+  tree_free_nodes(tree, 0, TREE_INITIAL_NODES);
+  return tree;
+}
+
+void aabb_tree_free(aabb_tree_t *tree) {
+  free(tree->nodes);
+  free(tree);
+}
+
+size_t aabb_tree_size(aabb_tree_t *tree) { return tree->size; }
+
+/**
+ * Takes a node off the free list, growing the node array if it is empty.
+ * Since this may move the nodes, pointers to nodes must not be held across it.
+ */
+size_t tree_allocate_node(aabb_tree_t *tree) {
+  if (tree->free_list == TREE_NULL_NODE) {
+    size_t old_capacity = tree->capacity;
+    tree->capacity *= 2;
+    tree->nodes = realloc(tree->nodes, sizeof(tree_node_t) * tree->capacity);
+    assert(tree->nodes != NULL);
+    tree_free_nodes(tree, old_capacity, tree->capacity);
+  }
+  size_t node = tree->free_list;
+  tree->free_list = tree->nodes[node].parent;
+  tree->nodes[node].parent = TREE_NULL_NODE;
+  tree->nodes[node].left = TREE_NULL_NODE;
+  tree->nodes[node].right = TREE_NULL_NODE;
+  tree->nodes[node].data = NULL;
+  tree->nodes[node].height = 0;
+  return node;
+}
+
+void tree_release_node(aabb_tree_t *tree, size_t node) {
+  tree_free_nodes(tree, node, node + 1);
+}
+
+bool tree_is_leaf(aabb_tree_t *tree, size_t node) {
+  return tree->nodes[node].left == TREE_NULL_NODE;
+}
+
+/**
+ * Replaces the child of parent that was old_child with new_child,
+ * or makes new_child the root if parent is missing.
+ */
+void tree_replace_child(aabb_tree_t *tree, size_t parent, size_t old_child,
+                        size_t new_child) {
+  if (parent == TREE_NULL_NODE) {
+    tree->root = new_child;
+  } else if (tree->nodes[parent].left == old_child) {
+    tree->nodes[parent].left = new_child;
+  } else {
+    tree->nodes[parent].right = new_child;
+  }
+}
+
+/**
+ * Recomputes an internal node's height and fat box from its children.
+ */
+void tree_refit(aabb_tree_t *tree, size_t node) {
+  tree_node_t *n = &tree->nodes[node];
+  tree_node_t *left = &tree->nodes[n->left];
+  tree_node_t *right = &tree->nodes[n->right];
+  n->height = 1 + (left->height > right->height ? left->height : right->height);
+  n->fat = aabb_union(left->fat, right->fat);
+}
+
+/**
+ * Rotates the taller grandchild of a node up into its place if the node's
+ * children differ in height by more than 1.
+ *
+ * @return the node now at the original node's position
+ */
+size_t tree_balance(aabb_tree_t *tree, size_t a) {
+  tree_node_t *nodes = tree->nodes;
+  if (tree_is_leaf(tree, a) || nodes[a].height < 2) {
+    return a;
+  }
+
+  size_t b = nodes[a].left;
+  size_t c = nodes[a].right;
+  int balance = nodes[c].height - nodes[b].height;
+  if (balance > 1 || balance < -1) {
+    // Rotate the taller child "up" above a; the short side stays under a
+    size_t up = balance > 1 ? c : b;
+    size_t f = nodes[up].left;
+    size_t g = nodes[up].right;
+    // The taller of up's children stays with it; the other moves to a
+    size_t stays = nodes[f].height > nodes[g].height ? f : g;
+    size_t moves = stays == f ? g : f;
+
+    nodes[up].parent = nodes[a].parent;
+    tree_replace_child(tree, nodes[a].parent, a, up);
+    nodes[a].parent = up;
+    nodes[moves].parent = a;
+    if (balance > 1) {
+      nodes[a].right = moves;
+      nodes[up].left = a;
+      nodes[up].right = stays;
+    } else {
+      nodes[a].left = moves;
+      nodes[up].left = stays;
+      nodes[up].right = a;
+    }
+    tree_refit(tree, a);
+    tree_refit(tree, up);
+    return up;
+  }
+  return a;
+}
+
+/**
+ * Refits and rebalances every ancestor of a node, from the bottom up.
+ */
+void tree_fix_upwards(aabb_tree_t *tree, size_t node) {
+  while (node != TREE_NULL_NODE) {
+    node = tree_balance(tree, node);
+    tree_refit(tree, node);
+    node = tree->nodes[node].parent;
+  }
+}
+
+/**
+ * Links a leaf into the tree next to the sibling that increases the total
+ * perimeter of the internal nodes the least.
+ */
+void tree_insert_leaf(aabb_tree_t *tree, size_t leaf) {
+  if (tree->root == TREE_NULL_NODE) {
+    tree->root = leaf;
+    tree->nodes[leaf].parent = TREE_NULL_NODE;
+    return;
+  }
+
+  aabb_t box = tree->nodes[leaf].fat;
+  size_t index = tree->root;
+  while (!tree_is_leaf(tree, index)) {
+    tree_node_t *node = &tree->nodes[index];
+    double combined = aabb_perimeter(aabb_union(node->fat, box));
+    // Cost of making a new parent of this node and the leaf
+    double cost = 2 * combined;
+    // Cost every ancestor pays for growing to include the leaf
+    double inherited = 2 * (combined - aabb_perimeter(node->fat));
+
+    double child_costs[2];
+    size_t children[2] = {node->left, node->right};
+    for (size_t i = 0; i < 2; i++) {
+      tree_node_t *child = &tree->nodes[children[i]];
+      double grown = aabb_perimeter(aabb_union(child->fat, box));
+      child_costs[i] = inherited + (tree_is_leaf(tree, children[i])
+                                        ? grown
+                                        : grown - aabb_perimeter(child->fat));
+    }
+    if (cost < child_costs[0] && cost < child_costs[1]) {
+      break;
+    }
+    index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+  }
+
+  size_t sibling = index;
+  size_t old_parent = tree->nodes[sibling].parent;
+  size_t new_parent = tree_allocate_node(tree);
+  tree_node_t *parent = &tree->nodes[new_parent];
+  parent->parent = old_parent;
+  parent->left = sibling;
+  parent->right = leaf;
+  tree_replace_child(tree, old_parent, sibling, new_parent);
+  tree->nodes[sibling].parent = new_parent;
+  tree->nodes[leaf].parent = new_parent;
+  tree_fix_upwards(tree, new_parent);
+}
+
+/**
+ * Unlinks a leaf from the tree, replacing its parent with its sibling.
+ */
+void tree_remove_leaf(aabb_tree_t *tree, size_t leaf) {
+  if (leaf == tree->root) {
+    tree->root = TREE_NULL_NODE;
+    return;
+  }
+
+  size_t parent = tree->nodes[leaf].parent;
+  size_t grandparent = tree->nodes[parent].parent;
+  size_t sibling = tree->nodes[parent].left == leaf
+                       ? tree->nodes[parent].right
+                       : tree->nodes[parent].left;
+  tree_replace_child(tree, grandparent, parent, sibling);
+  tree->nodes[sibling].parent = grandparent;
+  tree_release_node(tree, parent);
+  tree_fix_upwards(tree, grandparent);
+}
+
+aabb_t tree_fatten(aabb_tree_t *tree, aabb_t bounds) {
+  vector_t margin = {tree->margin, tree->margin};
+  return (aabb_t){vec_subtract(bounds.min, margin),
+                  vec_add(bounds.max, margin)};
+}
+
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t bounds, void *data) {
+  size_t leaf = tree_allocate_node(tree);
+  tree->nodes[leaf].bounds = bounds;
+  tree->nodes[leaf].fat = tree_fatten(tree, bounds);
+  tree->nodes[leaf].data = data;
+  tree_insert_leaf(tree, leaf);
+  tree->size++;
+  return leaf;
+}
+
+void tree_assert_proxy(aabb_tree_t *tree, size_t proxy) {
+  assert(proxy < tree->capacity);
+  assert(tree->nodes[proxy].height == 0);
+}
+
+void aabb_tree_remove(aabb_tree_t *tree, size_t proxy) {
+  tree_assert_proxy(tree, proxy);
+  tree_remove_leaf(tree, proxy);
+  tree_release_node(tree, proxy);
+  tree->size--;
+}
+
+bool aabb_tree_move(aabb_tree_t *tree, size_t proxy, aabb_t bounds) {
+  tree_assert_proxy(tree, proxy);
+  tree->nodes[proxy].bounds = bounds;
+  if (aabb_contains(tree->nodes[proxy].fat, bounds)) {
+    return false;
+  }
+
+  tree_remove_leaf(tree, proxy);
+  tree->nodes[proxy].fat = tree_fatten(tree, bounds);
+  tree_insert_leaf(tree, proxy);
+  return true;
+}
+
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t proxy) {
+  tree_assert_proxy(tree, proxy);
+  return tree->nodes[proxy].data;
+}
+
+/**
+ * Reports every overlapping pair with one box under node1 and one under node2.
+ * Descends into the larger of the two subtrees first, so small boxes are not
+ * compared with every leaf under a large internal node.
+ */
+void tree_pairs_between(aabb_tree_t *tree, size_t node1, size_t node2,
+                        tree_pair_handler_t handler, void *aux) {
+  tree_node_t *n1 = &tree->nodes[node1];
+  tree_node_t *n2 = &tree->nodes[node2];
+  if (!aabb_overlap(n1->fat, n2->fat)) {
+    return;
+  }
+
+  bool leaf1 = tree_is_leaf(tree, node1);
+  bool leaf2 = tree_is_leaf(tree, node2);
+  if (leaf1 && leaf2) {
+    if (aabb_overlap(n1->bounds, n2->bounds)) {
+      handler(n1->data, n2->data, aux);
+    }
+  } else if (leaf1 ||
+             (!leaf2 && aabb_perimeter(n2->fat) > aabb_perimeter(n1->fat))) {
+    tree_pairs_between(tree, node1, n2->left, handler, aux);
+    tree_pairs_between(tree, node1, n2->right, handler, aux);
+  } else {
+    tree_pairs_between(tree, n1->left, node2, handler, aux);
+    tree_pairs_between(tree, n1->right, node2, handler, aux);
+  }
+}
+
+/**
+ * Reports every overlapping pair of boxes under a node.
+ */
+void tree_pairs_within(aabb_tree_t *tree, size_t node,
+                       tree_pair_handler_t handler, void *aux) {
+  if (tree_is_leaf(tree, node)) {
+    return;
+  }
+  size_t left = tree->nodes[node].left;
+  size_t right = tree->nodes[node].right;
+  tree_pairs_within(tree, left, handler, aux);
+  tree_pairs_within(tree, right, handler, aux);
+  tree_pairs_between(tree, left, right, handler, aux);
+}
+
+void aabb_tree_pairs(aabb_tree_t *tree, tree_pair_handler_t handler,
+                     void *aux) {
+  if (tree->root != TREE_NULL_NODE) {
+    tree_pairs_within(tree, tree->root, handler, aux);
+  }
+}
+
+void tree_query(aabb_tree_t *tree, size_t node, aabb_t bounds,
+                tree_query_handler_t handler, void *aux) {
+  tree_node_t *n = &tree->nodes[node];
+  if (!aabb_overlap(n->fat, bounds)) {
+    return;
+  }
+  if (tree_is_leaf(tree, node)) {
+    if (aabb_overlap(n->bounds, bounds)) {
+      handler(n->data, aux);
+    }
+    return;
+  }
+  tree_query(tree, n->left, bounds, handler, aux);
+  tree_query(tree, n->right, bounds, handler, aux);
+}
+
+void aabb_tree_query(aabb_tree_t *tree, aabb_t bounds,
+                     tree_query_handler_t handler, void *aux) {
+  if (tree->root != TREE_NULL_NODE) {
+    tree_query(tree, tree->root, bounds, handler, aux);
+  }
+}
+
+void tree_raycast(aabb_tree_t *tree, size_t node, vector_t start,
+                  vector_t end, tree_query_handler_t handler, void *aux) {
+  tree_node_t *n = &tree->nodes[node];
+  if (!aabb_segment_overlap(n->fat, start, end)) {
+    return;
+  }
+  if (tree_is_leaf(tree, node)) {
+    if (aabb_segment_overlap(n->bounds, start, end)) {
+      handler(n->data, aux);
+    }
+    return;
+  }
+  tree_raycast(tree, n->left, start, end, handler, aux);
+  tree_raycast(tree, n->right, start, end, handler, aux);
+}
+
+void aabb_tree_raycast(aabb_tree_t *tree, vector_t start, vector_t end,
+                       tree_query_handler_t handler, void *aux) {
+  if (tree->root != TREE_NULL_NODE) {
+    tree_raycast(tree, tree->root, start, end, handler, aux);
+  }
+}
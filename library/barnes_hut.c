@@ -0,0 +1,287 @@
+#include "barnes_hut.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Nodes with at most this many points are not split any further.
+ */
+const size_t BH_LEAF_SIZE = 4;
+
+/**
+ * Nodes this deep are never split, so points at the same position
+ * cannot make the tree infinitely deep.
+ */
+const size_t BH_MAX_DEPTH = 32;
+
+/**
+ * Marks a leaf, which has no children.
+ */
+const size_t BH_NO_CHILDREN = SIZE_MAX;
+
+/**
+ * A square of the tree. Its four children are stored next to each other,
+ * starting at first_child, in the order (low x, low y), (high x, low y),
+ * (low x, high y), (high x, high y).
+ * The node's points are order[start] to order[start + count - 1].
+ */
+typedef struct bh_node {
+  vector_t min;
+  double size;
+  double mass;
+  vector_t center_of_mass;
+  size_t first_child;
+  size_t start;
+  size_t count;
+} bh_node_t;
+
+struct barnes_hut {
+  vector_t *positions;
+  double *masses;
+  // Point indices, grouped so every node's points are contiguous
+  size_t *order;
+  size_t num_points;
+  size_t points_capacity;
+
+  bh_node_t *nodes;
+  size_t num_nodes;
+  size_t nodes_capacity;
+};
+
+/**
+ * Grows a dynamic array so it can hold at least needed elements.
+ */
+void *bh_reserve(void *array, size_t *capacity, size_t needed,
+                 size_t elem_size) {
+  if (needed <= *capacity) {
+    return array;
+  }
+  size_t new_capacity = *capacity == 0 ? 8 : *capacity;
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  array = realloc(array, elem_size * new_capacity);
+  assert(array != NULL);
+  *capacity = new_capacity;
+  return array;
+}
+
+barnes_hut_t *barnes_hut_init(void) {
+  barnes_hut_t *tree = malloc(sizeof(barnes_hut_t));
+  assert(tree != NULL);
+  tree->positions = NULL;
+  tree->masses = NULL;
+  tree->order = NULL;
+  tree->num_points = 0;
+  tree->points_capacity = 0;
+  tree->nodes = NULL;
+  tree->num_nodes = 0;
+  tree->nodes_capacity = 0;
+  return tree;
+}
+
+void barnes_hut_free(barnes_hut_t *tree) {
+  free(tree->positions);
+  free(tree->masses);
+  free(tree->order);
+  free(tree->nodes);
+  free(tree);
+}
+
+size_t barnes_hut_size(barnes_hut_t *tree) { return tree->num_points; }
+
+/**
+ * Appends a leaf node covering a square and returns its index.
+ */
+size_t bh_add_node(barnes_hut_t *tree, vector_t min, double size,
+                   size_t start, size_t count) {
+  tree->nodes = bh_reserve(tree->nodes, &tree->nodes_capacity,
+                           tree->num_nodes + 1, sizeof(bh_node_t));
+  tree->nodes[tree->num_nodes] = (bh_node_t){
+      min, size, 0, min, BH_NO_CHILDREN, start, count};
+  return tree->num_nodes++;
+}
+
+/**
+ * Reorders order[start] to order[end - 1] so the points below the split
+ * come first, and returns the index of the first point above it.
+ */
+size_t bh_partition(barnes_hut_t *tree, size_t start, size_t end,
+                    bool by_x, double split) {
+  size_t low = start;
+  for (size_t i = start; i < end; i++) {
+    vector_t position = tree->positions[tree->order[i]];
+    if ((by_x ? position.x : position.y) < split) {
+      size_t swap = tree->order[i];
+      tree->order[i] = tree->order[low];
+      tree->order[low] = swap;
+      low++;
+    }
+  }
+  return low;
+}
+
+/**
+ * Splits a node into quadrants if it has too many points,
+ * then fills in its mass and center of mass.
+ */
+void bh_build_node(barnes_hut_t *tree, size_t index, size_t depth) {
+  bh_node_t node = tree->nodes[index];
+  size_t end = node.start + node.count;
+
+  if (node.count > BH_LEAF_SIZE && depth < BH_MAX_DEPTH) {
+    double half = node.size / 2;
+    vector_t mid = {node.min.x + half, node.min.y + half};
+    size_t split_y = bh_partition(tree, node.start, end, false, mid.y);
+    size_t split_low_x = bh_partition(tree, node.start, split_y, true, mid.x);
+    size_t split_high_x = bh_partition(tree, split_y, end, true, mid.x);
+    size_t bounds[5] = {node.start, split_low_x, split_y, split_high_x, end};
+
+    size_t first_child = tree->num_nodes;
+    for (size_t i = 0; i < 4; i++) {
+      vector_t min = {i % 2 == 0 ? node.min.x : mid.x,
+                      i < 2 ? node.min.y : mid.y};
+      bh_add_node(tree, min, half, bounds[i], bounds[i + 1] - bounds[i]);
+    }
+    tree->nodes[index].first_child = first_child;
+
+    double mass = 0;
+    vector_t moment = VEC_ZERO;
+    for (size_t i = 0; i < 4; i++) {
+      bh_build_node(tree, first_child + i, depth + 1);
+      bh_node_t *child = &tree->nodes[first_child + i];
+      mass += child->mass;
+      moment = vec_add(moment, vec_multiply(child->mass,
+                                            child->center_of_mass));
+    }
+    tree->nodes[index].mass = mass;
+    if (mass > 0) {
+      tree->nodes[index].center_of_mass = vec_multiply(1 / mass, moment);
+    }
+    return;
+  }
+
+  double mass = 0;
+  vector_t moment = VEC_ZERO;
+  for (size_t i = node.start; i < end; i++) {
+    size_t point = tree->order[i];
+    mass += tree->masses[point];
+    moment = vec_add(moment, vec_multiply(tree->masses[point],
+                                          tree->positions[point]));
+  }
+  tree->nodes[index].mass = mass;
+  if (mass > 0) {
+    tree->nodes[index].center_of_mass = vec_multiply(1 / mass, moment);
+  }
+}
+
+void barnes_hut_build(barnes_hut_t *tree, const vector_t *positions,
+                      const double *masses, size_t count) {
+  // The point arrays share one capacity, so each grows from the old one
+  size_t capacity = tree->points_capacity;
+  tree->positions =
+      bh_reserve(tree->positions, &capacity, count, sizeof(vector_t));
+  capacity = tree->points_capacity;
+  tree->masses = bh_reserve(tree->masses, &capacity, count, sizeof(double));
+  capacity = tree->points_capacity;
+  tree->order = bh_reserve(tree->order, &capacity, count, sizeof(size_t));
+  tree->points_capacity = capacity;
+
+  vector_t min = {INFINITY, INFINITY};
+  vector_t max = {-INFINITY, -INFINITY};
+  for (size_t i = 0; i < count; i++) {
+    assert(masses[i] >= 0);
+    tree->positions[i] = positions[i];
+    tree->masses[i] = masses[i];
+    tree->order[i] = i;
+    min = (vector_t){fmin(min.x, positions[i].x), fmin(min.y, positions[i].y)};
+    max = (vector_t){fmax(max.x, positions[i].x), fmax(max.y, positions[i].y)};
+  }
+  tree->num_points = count;
+  tree->num_nodes = 0;
+  if (count == 0) {
+    return;
+  }
+
+  // Widen the root square slightly so the largest points fall strictly
+  // inside it rather than on its upper edges
+  double size = fmax(max.x - min.x, max.y - min.y);
+  size = size > 0 ? size * (1 + 1e-9) : 1;
+  size_t root = bh_add_node(tree, min, size, 0, count);
+  bh_build_node(tree, root, 0);
+}
+
+/**
+ * Returns whether a position lies inside a node's square.
+ */
+bool bh_contains(bh_node_t *node, vector_t position) {
+  return position.x >= node->min.x && position.x < node->min.x + node->size &&
+         position.y >= node->min.y && position.y < node->min.y + node->size;
+}
+
+/**
+ * Adds the field of a point mass at a position to *field.
+ */
+void bh_add_field(vector_t *field, vector_t position, vector_t source,
+                  double mass, double min_dist) {
+  vector_t offset = vec_subtract(source, position);
+  double dist = vec_norm(offset);
+  if (dist < min_dist || dist == 0) {
+    return;
+  }
+  *field = vec_add(*field, vec_multiply(mass / (dist * dist * dist), offset));
+}
+
+/**
+ * Adds the field of the points under a node to *field, opening the node
+ * into its children when it is too close to approximate.
+ */
+void bh_accumulate(barnes_hut_t *tree, size_t index, vector_t position,
+                   size_t self, double theta, double min_dist,
+                   vector_t *field) {
+  bh_node_t *node = &tree->nodes[index];
+  if (node->mass == 0) {
+    return;
+  }
+
+  if (node->first_child == BH_NO_CHILDREN) {
+    size_t end = node->start + node->count;
+    for (size_t i = node->start; i < end; i++) {
+      size_t point = tree->order[i];
+      if (point != self) {
+        bh_add_field(field, position, tree->positions[point],
+                     tree->masses[point], min_dist);
+      }
+    }
+    return;
+  }
+
+  // A node holding the position or the left-out point is always opened,
+  // so neither is ever counted as part of an approximation
+  double dist = vec_dist(node->center_of_mass, position);
+  bool holds_self =
+      self < tree->num_points && bh_contains(node, tree->positions[self]);
+  if (node->size < theta * dist && !holds_self &&
+      !bh_contains(node, position)) {
+    bh_add_field(field, position, node->center_of_mass, node->mass,
+                 min_dist);
+    return;
+  }
+  for (size_t i = 0; i < 4; i++) {
+    bh_accumulate(tree, node->first_child + i, position, self, theta,
+                  min_dist, field);
+  }
+}
+
+vector_t barnes_hut_field(barnes_hut_t *tree, vector_t position, size_t self,
+                          double theta, double min_dist) {
+  assert(theta >= 0);
+  vector_t field = VEC_ZERO;
+  if (tree->num_nodes > 0) {
+    bh_accumulate(tree, 0, position, self, theta, min_dist, &field);
+  }
+  return field;
+}
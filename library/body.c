@@ -4,14 +4,58 @@
 #include "polygon.h"
 #include "vector.h"
 
+#include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+/**
+ * The number of vertices a circle body's shape is approximated with
+ * when someone asks for its vertices (see body_view_shape()).
+ */
+const size_t CIRCLE_SHAPE_POINTS = 40;
+
+/**
+ * The shape is kept in body-local coordinates (relative to the centroid, at
+ * rotation 0). World-space vertices are only computed when someone asks for
+ * them, so moving or rotating a body is O(1) instead of O(vertices).
+ * The unit edge normals used by collision checks are cached the same way,
+ * but only depend on the rotation, so moving a body leaves them valid.
+ *
+ * Circle bodies are exact: collisions use only the centroid and radius, and
+ * the shape and normals stay NULL until someone asks for the vertices.
+ *
+ * While a body is attached to a body_store_t, its centroid, velocity, force
+ * and impulse live in the store's arrays at index slot, and the copies here
+ * are stale until it is detached.
+ */
 struct body {
-  list_t *shape;
+  bool is_circle;
+  polygon_t *shape;
+  polygon_t *world_shape;
+  // Set when the rotation changes. Moves are detected by comparing the
+  // centroid with world_centroid, since a store moves bodies behind our back.
+  bool world_shape_dirty;
+  vector_t world_centroid;
+  polygon_t *normals;
+  polygon_t *world_normals;
+  bool world_normals_dirty;
+  body_kind_t kind;
+  // See body_set_collision_filter()
+  uint32_t category;
+  uint32_t mask;
+  // Bounds cached while the body is static, until it is moved
+  aabb_t bounds;
+  bool bounds_valid;
+  // The distance from the centroid to the farthest vertex,
+  // or the radius of a circle body
+  double radius;
   double mass;
   double rotation;
+  // The transform when body_save_transform() was last called
+  vector_t previous_centroid;
+  double previous_rotation;
   rgb_color_t color;
   vector_t centroid;
   vector_t velocity;
@@ -20,6 +64,41 @@ struct body {
   void *info;
   free_func_t info_freer;
   bool is_removed;
+  bool is_sleeping;
+  // How long the body has been moving slowly enough to sleep
+  double rest_time;
+  body_store_t *store;
+  size_t slot;
+};
+
+/**
+ * The number of slots a body store starts with.
+ */
+const size_t STORE_INITIAL_CAPACITY = 8;
+
+/**
+ * Each array holds one coordinate of one quantity for every attached body,
+ * so the integrator reads and writes memory sequentially.
+ * Inverse masses are stored so the integrator never divides;
+ * an infinite mass has an inverse mass of 0.
+ */
+struct body_store {
+  double *x;
+  double *y;
+  double *vx;
+  double *vy;
+  double *fx;
+  double *fy;
+  double *jx;
+  double *jy;
+  double *inv_mass;
+  // The body attached at each slot, so a moved slot can update its body
+  body_t **bodies;
+  size_t size;
+  size_t capacity;
+  // Slots [0, num_moving) hold the dynamic and kinematic bodies, and the
+  // static bodies come after them, so ticking skips the static ones
+  size_t num_moving;
 };
 
 body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
@@ -28,54 +107,323 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
 
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer) {
-  vector_t centroid = polygon_centroid(shape);
-  double rotation = 0;
+  polygon_t *polygon = polygon_from_list(shape);
+  list_free(shape);
+  return body_init_with_polygon(polygon, mass, color, info, info_freer);
+}
 
+/**
+ * Allocates a body at rest and fills in everything but its shape.
+ */
+body_t *body_alloc(vector_t centroid, double mass, rgb_color_t color,
+                   void *info, free_func_t info_freer) {
   body_t *body = malloc(sizeof(body_t));
-  body->shape = shape;
+  assert(body != NULL);
   body->mass = mass;
   body->color = color;
   body->centroid = centroid;
   body->velocity = VEC_ZERO;
   body->force = VEC_ZERO;
   body->impulse = VEC_ZERO;
-  body->rotation = rotation;
+  body->rotation = 0;
+  body->previous_centroid = centroid;
+  body->previous_rotation = 0;
+  body->kind = BODY_DYNAMIC;
+  body->category = 0;
+  body->mask = UINT32_MAX;
+  body->bounds_valid = false;
   body->is_removed = false;
+  body->is_sleeping = false;
+  body->rest_time = 0;
+  body->store = NULL;
+  body->slot = 0;
 
   body->info = info;
   body->info_freer = info_freer;
+  return body;
+}
+
+body_t *body_init_with_polygon(polygon_t *shape, double mass,
+                               rgb_color_t color, void *info,
+                               free_func_t info_freer) {
+  vector_t centroid =
+      vertices_centroid(polygon_vertices(shape), polygon_size(shape));
 
+  // Both copies start out in world space; the local one is then recentered
+  body_t *body = body_alloc(centroid, mass, color, info, info_freer);
+  body->is_circle = false;
+  body->world_shape = polygon_copy(shape);
+  body->world_shape_dirty = false;
+  body->world_centroid = centroid;
+  vertices_translate(polygon_vertices(shape), polygon_size(shape),
+                     vec_negate(centroid));
+  body->shape = shape;
+  body->normals = polygon_copy(shape);
+  vertices_edge_normals(polygon_vertices(shape), polygon_size(shape),
+                        polygon_vertices(body->normals));
+  body->world_normals = polygon_copy(body->normals);
+  body->world_normals_dirty = false;
+  body->radius = 0;
+  for (size_t i = 0; i < polygon_size(shape); ++i) {
+    body->radius = fmax(body->radius, vec_norm(polygon_vertices(shape)[i]));
+  }
+  return body;
+}
+
+body_t *body_init_circle(double radius, vector_t center, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer) {
+  assert(radius > 0);
+
+  body_t *body = body_alloc(center, mass, color, info, info_freer);
+  body->is_circle = true;
+  body->radius = radius;
+  body->shape = NULL;
+  body->world_shape = NULL;
+  body->world_shape_dirty = true;
+  body->normals = NULL;
+  body->world_normals = NULL;
+  body->world_normals_dirty = false;
   return body;
 }
 
 void body_free(body_t *body) {
-  list_free(body->shape);
+  if (body->store != NULL) {
+    body_store_detach(body);
+  }
+  if (body->shape != NULL) {
+    polygon_free(body->shape);
+    polygon_free(body->world_shape);
+  }
+  if (body->normals != NULL) {
+    polygon_free(body->normals);
+    polygon_free(body->world_normals);
+  }
   if (body->info_freer != NULL) {
     body->info_freer(body->info);
   }
   free(body);
 }
 
-list_t *body_get_shape(body_t *body) {
-  list_t *shape = body->shape;
-  size_t size = list_size(shape);
-  list_t *shape_copy = list_init(size, free);
+/**
+ * Recomputes the world-space vertices from the local shape if the body has
+ * moved or rotated since they were last computed.
+ */
+void body_update_world_shape(body_t *body) {
+  vector_t centroid = body_get_centroid(body);
+  if (!body->world_shape_dirty && centroid.x == body->world_centroid.x &&
+      centroid.y == body->world_centroid.y) {
+    return;
+  }
+
+  // Circles are only tessellated the first time their vertices are needed
+  if (body->shape == NULL) {
+    body->shape = polygon_init(CIRCLE_SHAPE_POINTS);
+    for (size_t i = 0; i < CIRCLE_SHAPE_POINTS; ++i) {
+      double angle = 2 * M_PI * i / CIRCLE_SHAPE_POINTS;
+      polygon_add(body->shape, (vector_t){body->radius * cos(angle),
+                                          body->radius * sin(angle)});
+    }
+    body->world_shape = polygon_copy(body->shape);
+  }
+
+  size_t size = polygon_size(body->shape);
+  vector_t *local = polygon_vertices(body->shape);
+  vector_t *world = polygon_vertices(body->world_shape);
+  double cos_angle = cos(body->rotation);
+  double sin_angle = sin(body->rotation);
   for (size_t i = 0; i < size; ++i) {
-    vector_t *vtx = list_get(shape, i);
-    vector_t *vtx_cpy = malloc(sizeof(vector_t));
-    vtx_cpy->x = vtx->x;
-    vtx_cpy->y = vtx->y;
-    list_add(shape_copy, vtx_cpy);
+    world[i].x = local[i].x * cos_angle - local[i].y * sin_angle + centroid.x;
+    world[i].y = local[i].x * sin_angle + local[i].y * cos_angle + centroid.y;
+  }
+  body->world_shape_dirty = false;
+  body->world_centroid = centroid;
+}
+
+polygon_view_t body_view_shape(body_t *body) {
+  body_update_world_shape(body);
+  return polygon_view(body->world_shape);
+}
+
+polygon_view_t body_view_normals(body_t *body) {
+  if (body->is_circle) {
+    return (polygon_view_t){NULL, 0};
+  }
+  if (body->world_normals_dirty) {
+    size_t size = polygon_size(body->normals);
+    vector_t *local = polygon_vertices(body->normals);
+    vector_t *world = polygon_vertices(body->world_normals);
+    double cos_angle = cos(body->rotation);
+    double sin_angle = sin(body->rotation);
+    for (size_t i = 0; i < size; ++i) {
+      world[i].x = local[i].x * cos_angle - local[i].y * sin_angle;
+      world[i].y = local[i].x * sin_angle + local[i].y * cos_angle;
+    }
+    body->world_normals_dirty = false;
+  }
+  return polygon_view(body->world_normals);
+}
+
+list_t *body_get_shape(body_t *body) {
+  body_update_world_shape(body);
+  return polygon_to_list(body->world_shape);
+}
+
+polygon_t *body_get_polygon(body_t *body) {
+  body_update_world_shape(body);
+  return polygon_copy(body->world_shape);
+}
+
+vector_t body_get_centroid(body_t *body) {
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    return (vector_t){store->x[body->slot], store->y[body->slot]};
   }
-  return shape_copy;
+  return body->centroid;
+}
+
+bool body_is_circle(body_t *body) { return body->is_circle; }
+
+double body_get_radius(body_t *body) { return body->radius; }
+
+aabb_t body_get_bounds(body_t *body) {
+  if (body->bounds_valid) {
+    return body->bounds;
+  }
+  vector_t centroid = body_get_centroid(body);
+  vector_t extent = {body->radius, body->radius};
+  aabb_t bounds = {vec_subtract(centroid, extent), vec_add(centroid, extent)};
+  if (body->kind == BODY_STATIC) {
+    body->bounds = bounds;
+    body->bounds_valid = true;
+  }
+  return bounds;
+}
+
+body_kind_t body_get_kind(body_t *body) { return body->kind; }
+
+void body_set_collision_filter(body_t *body, uint32_t category,
+                               uint32_t mask) {
+  body->category = category;
+  body->mask = mask;
 }
 
-vector_t body_get_centroid(body_t *body) { return body->centroid; }
+uint32_t body_get_collision_category(body_t *body) { return body->category; }
+
+uint32_t body_get_collision_mask(body_t *body) { return body->mask; }
+
+double body_get_inverse_mass(body_t *body) {
+  return body->kind == BODY_DYNAMIC ? 1.0 / body->mass : 0;
+}
 
-vector_t body_get_velocity(body_t *body) { return body->velocity; }
+void store_swap(double *array, size_t slot1, size_t slot2) {
+  double value = array[slot1];
+  array[slot1] = array[slot2];
+  array[slot2] = value;
+}
+
+/**
+ * Swaps the bodies in two slots of a store.
+ */
+void store_swap_slots(body_store_t *store, size_t slot1, size_t slot2) {
+  if (slot1 == slot2) {
+    return;
+  }
+  store_swap(store->x, slot1, slot2);
+  store_swap(store->y, slot1, slot2);
+  store_swap(store->vx, slot1, slot2);
+  store_swap(store->vy, slot1, slot2);
+  store_swap(store->fx, slot1, slot2);
+  store_swap(store->fy, slot1, slot2);
+  store_swap(store->jx, slot1, slot2);
+  store_swap(store->jy, slot1, slot2);
+  store_swap(store->inv_mass, slot1, slot2);
+  body_t *body = store->bodies[slot1];
+  store->bodies[slot1] = store->bodies[slot2];
+  store->bodies[slot2] = body;
+  store->bodies[slot1]->slot = slot1;
+  store->bodies[slot2]->slot = slot2;
+}
+
+/**
+ * Moves an attached body to the other side of the boundary between moving
+ * and static bodies if its kind has changed sides.
+ */
+void store_update_kind(body_t *body, bool was_static) {
+  body_store_t *store = body->store;
+  bool is_static = body->kind == BODY_STATIC;
+  if (is_static && !was_static) {
+    store_swap_slots(store, body->slot, --store->num_moving);
+  } else if (!is_static && was_static) {
+    store_swap_slots(store, body->slot, store->num_moving++);
+  }
+}
+
+double *store_resize(double *array, size_t capacity) {
+  array = realloc(array, sizeof(double) * capacity);
+  assert(array != NULL);
+  return array;
+}
+
+void body_set_kind(body_t *body, body_kind_t kind) {
+  bool was_static = body->kind == BODY_STATIC;
+  body->kind = kind;
+  body->bounds_valid = false;
+  if (kind != BODY_DYNAMIC) {
+    body_wake(body);
+  }
+  if (body->store != NULL) {
+    store_update_kind(body, was_static);
+  }
+  if (kind == BODY_DYNAMIC) {
+    if (body->store != NULL) {
+      body->store->inv_mass[body->slot] = body_get_inverse_mass(body);
+    }
+    return;
+  }
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    store->fx[body->slot] = store->fy[body->slot] = 0;
+    store->jx[body->slot] = store->jy[body->slot] = 0;
+    store->inv_mass[body->slot] = 0;
+    if (kind == BODY_STATIC) {
+      store->vx[body->slot] = store->vy[body->slot] = 0;
+    }
+  }
+  body->force = VEC_ZERO;
+  body->impulse = VEC_ZERO;
+  if (kind == BODY_STATIC) {
+    body->velocity = VEC_ZERO;
+  }
+}
+
+vector_t body_get_velocity(body_t *body) {
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    return (vector_t){store->vx[body->slot], store->vy[body->slot]};
+  }
+  return body->velocity;
+}
 
 double body_get_rotation(body_t *body) { return body->rotation; }
 
+void body_save_transform(body_t *body) {
+  body->previous_centroid = body_get_centroid(body);
+  body->previous_rotation = body->rotation;
+}
+
+vector_t body_get_interpolated_centroid(body_t *body, double alpha) {
+  vector_t centroid = body_get_centroid(body);
+  return vec_add(body->previous_centroid,
+                 vec_multiply(alpha, vec_subtract(centroid,
+                                                  body->previous_centroid)));
+}
+
+double body_get_interpolated_rotation(body_t *body, double alpha) {
+  return body->previous_rotation +
+         alpha * (body->rotation - body->previous_rotation);
+}
+
 double body_get_mass(body_t *body) { return body->mass; }
 
 rgb_color_t body_get_color(body_t *body) { return body->color; }
@@ -83,35 +431,131 @@ rgb_color_t body_get_color(body_t *body) { return body->color; }
 void *body_get_info(body_t *body) { return body->info; }
 
 void body_set_centroid(body_t *body, vector_t x) {
-  vector_t displacement = vec_subtract(x, body->centroid);
-
-  polygon_translate(body->shape, displacement);
+  body_wake(body);
+  body->bounds_valid = false;
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    store->x[body->slot] = x.x;
+    store->y[body->slot] = x.y;
+    return;
+  }
   body->centroid = x;
 }
 
-void body_set_velocity(body_t *body, vector_t v) { body->velocity = v; }
+void body_set_velocity(body_t *body, vector_t v) {
+  if (body->kind == BODY_STATIC) {
+    return;
+  }
+  body_wake(body);
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    store->vx[body->slot] = v.x;
+    store->vy[body->slot] = v.y;
+    return;
+  }
+  body->velocity = v;
+}
 
 void body_set_rotation(body_t *body, double angle) {
-  double relative_angle = angle - body->rotation;
-
-  polygon_rotate(body->shape, relative_angle, body->centroid);
+  body_wake(body);
   body->rotation = angle;
+  body->world_shape_dirty = true;
+  body->world_normals_dirty = !body->is_circle;
 }
 
 void body_set_color(body_t *body, rgb_color_t color) { body->color = color; }
 
+vector_t body_get_force(body_t *body) {
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    return (vector_t){store->fx[body->slot], store->fy[body->slot]};
+  }
+  return body->force;
+}
+
+vector_t body_get_impulse(body_t *body) {
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    return (vector_t){store->jx[body->slot], store->jy[body->slot]};
+  }
+  return body->impulse;
+}
+
 void body_add_force(body_t *body, vector_t force) {
+  if (body->kind != BODY_DYNAMIC) {
+    return;
+  }
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    store->fx[body->slot] += force.x;
+    store->fy[body->slot] += force.y;
+    return;
+  }
   body->force = vec_add(body->force, force);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
+  if (body->kind != BODY_DYNAMIC) {
+    return;
+  }
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    store->jx[body->slot] += impulse.x;
+    store->jy[body->slot] += impulse.y;
+    return;
+  }
   body->impulse = vec_add(body->impulse, impulse);
 }
 
+/**
+ * Ticks the bodies in slots [start, end) of a store.
+ * Does exactly the same arithmetic as body_tick() does on a detached body,
+ * but on plain arrays with no aliasing, so the compiler can vectorize it.
+ */
+void store_integrate(body_store_t *store, size_t start, size_t end,
+                     double dt) {
+  double *restrict x = store->x;
+  double *restrict y = store->y;
+  double *restrict vx = store->vx;
+  double *restrict vy = store->vy;
+  double *restrict fx = store->fx;
+  double *restrict fy = store->fy;
+  double *restrict jx = store->jx;
+  double *restrict jy = store->jy;
+  const double *restrict inv_mass = store->inv_mass;
+  for (size_t i = start; i < end; ++i) {
+    double new_vx = vx[i] + inv_mass[i] * (jx[i] + dt * fx[i]);
+    double new_vy = vy[i] + inv_mass[i] * (jy[i] + dt * fy[i]);
+    x[i] += dt * (0.5 * (vx[i] + new_vx));
+    y[i] += dt * (0.5 * (vy[i] + new_vy));
+    vx[i] = new_vx;
+    vy[i] = new_vy;
+    fx[i] = 0;
+    fy[i] = 0;
+    jx[i] = 0;
+    jy[i] = 0;
+  }
+}
+
 void body_tick(body_t *body, double dt) {
+  if (body->is_sleeping || body->kind == BODY_STATIC) {
+    // Sleeping and static bodies stay put, but drop what was applied this tick
+    body_store_t *store = body->store;
+    if (store != NULL) {
+      store->fx[body->slot] = store->fy[body->slot] = 0;
+      store->jx[body->slot] = store->jy[body->slot] = 0;
+    }
+    body->force = VEC_ZERO;
+    body->impulse = VEC_ZERO;
+    return;
+  }
+  if (body->store != NULL) {
+    store_integrate(body->store, body->slot, body->slot + 1, dt);
+    return;
+  }
   vector_t total_impulse =
       vec_add(body->impulse, vec_multiply(dt, body->force));
-  vector_t dv = vec_multiply(1.0 / body_get_mass(body), total_impulse);
+  vector_t dv = vec_multiply(body_get_inverse_mass(body), total_impulse);
 
   vector_t old_velocity = body_get_velocity(body);
   vector_t new_velocity = vec_add(old_velocity, dv);
@@ -121,8 +565,9 @@ void body_tick(body_t *body, double dt) {
   vector_t displacement = vec_multiply(dt, avg_velocity);
   vector_t new_centroid = vec_add(body->centroid, displacement);
 
-  body_set_centroid(body, new_centroid);
-  body_set_velocity(body, new_velocity);
+  // Assigned directly, since the setters would reset the rest time
+  body->centroid = new_centroid;
+  body->velocity = new_velocity;
   body->impulse = VEC_ZERO;
   body->force = VEC_ZERO;
 }
@@ -130,3 +575,199 @@ void body_tick(body_t *body, double dt) {
 void body_remove(body_t *body) { body->is_removed = true; }
 
 bool body_is_removed(body_t *body) { return body->is_removed; }
+
+void body_sleep(body_t *body) {
+  // Only forces move a dynamic body, so only it can settle. A kinematic
+  // body may be following a slow path, and a static body never moves.
+  if (body->kind != BODY_DYNAMIC) {
+    return;
+  }
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    store->vx[body->slot] = store->vy[body->slot] = 0;
+    store->fx[body->slot] = store->fy[body->slot] = 0;
+    store->jx[body->slot] = store->jy[body->slot] = 0;
+  }
+  body->velocity = VEC_ZERO;
+  body->force = VEC_ZERO;
+  body->impulse = VEC_ZERO;
+  body->is_sleeping = true;
+}
+
+void body_wake(body_t *body) {
+  body->is_sleeping = false;
+  body->rest_time = 0;
+}
+
+bool body_is_sleeping(body_t *body) { return body->is_sleeping; }
+
+double body_get_rest_time(body_t *body) { return body->rest_time; }
+
+void body_set_rest_time(body_t *body, double rest_time) {
+  body->rest_time = rest_time;
+}
+
+void body_save_state(body_t *body, body_state_t *state) {
+  *state = (body_state_t){body_get_centroid(body),
+                          body_get_velocity(body),
+                          body_get_force(body),
+                          body_get_impulse(body),
+                          body->rotation,
+                          body->previous_centroid,
+                          body->previous_rotation,
+                          body->rest_time,
+                          body->color,
+                          body->kind,
+                          body->category,
+                          body->mask,
+                          body->is_removed,
+                          body->is_sleeping};
+}
+
+void body_restore_state(body_t *body, const body_state_t *state) {
+  if (state->kind != body->kind) {
+    body_set_kind(body, state->kind);
+  }
+  body_store_t *store = body->store;
+  if (store != NULL) {
+    size_t slot = body->slot;
+    store->x[slot] = state->centroid.x;
+    store->y[slot] = state->centroid.y;
+    store->vx[slot] = state->velocity.x;
+    store->vy[slot] = state->velocity.y;
+    store->fx[slot] = state->force.x;
+    store->fy[slot] = state->force.y;
+    store->jx[slot] = state->impulse.x;
+    store->jy[slot] = state->impulse.y;
+  }
+  body->centroid = state->centroid;
+  body->velocity = state->velocity;
+  body->force = state->force;
+  body->impulse = state->impulse;
+  if (state->rotation != body->rotation) {
+    body_set_rotation(body, state->rotation);
+  }
+  body->bounds_valid = false;
+  body->previous_centroid = state->previous_centroid;
+  body->previous_rotation = state->previous_rotation;
+  body->rest_time = state->rest_time;
+  body->color = state->color;
+  body->category = state->category;
+  body->mask = state->mask;
+  body->is_removed = state->is_removed;
+  body->is_sleeping = state->is_sleeping;
+}
+
+body_store_t *body_store_init() {
+  body_store_t *store = malloc(sizeof(body_store_t));
+  assert(store != NULL);
+  store->x = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->y = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->vx = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->vy = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->fx = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->fy = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->jx = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->jy = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->inv_mass = malloc(sizeof(double) * STORE_INITIAL_CAPACITY);
+  store->bodies = malloc(sizeof(body_t *) * STORE_INITIAL_CAPACITY);
+  assert(store->x != NULL && store->y != NULL);
+  assert(store->vx != NULL && store->vy != NULL);
+  assert(store->fx != NULL && store->fy != NULL);
+  assert(store->jx != NULL && store->jy != NULL);
+  assert(store->inv_mass != NULL && store->bodies != NULL);
+  store->size = 0;
+  store->capacity = STORE_INITIAL_CAPACITY;
+  store->num_moving = 0;
+  return store;
+}
+
+void body_store_free(body_store_t *store) {
+  // Detaching from the end never moves another body
+  while (store->size != 0) {
+    body_store_detach(store->bodies[store->size - 1]);
+  }
+  free(store->x);
+  free(store->y);
+  free(store->vx);
+  free(store->vy);
+  free(store->fx);
+  free(store->fy);
+  free(store->jx);
+  free(store->jy);
+  free(store->inv_mass);
+  free(store->bodies);
+  free(store);
+}
+
+size_t body_store_size(body_store_t *store) { return store->size; }
+
+size_t body_store_num_moving(body_store_t *store) { return store->num_moving; }
+
+void body_store_attach(body_store_t *store, body_t *body) {
+  assert(body->store == NULL);
+
+  if (store->size == store->capacity) {
+    store->capacity *= 2;
+    store->x = store_resize(store->x, store->capacity);
+    store->y = store_resize(store->y, store->capacity);
+    store->vx = store_resize(store->vx, store->capacity);
+    store->vy = store_resize(store->vy, store->capacity);
+    store->fx = store_resize(store->fx, store->capacity);
+    store->fy = store_resize(store->fy, store->capacity);
+    store->jx = store_resize(store->jx, store->capacity);
+    store->jy = store_resize(store->jy, store->capacity);
+    store->inv_mass = store_resize(store->inv_mass, store->capacity);
+    store->bodies =
+        realloc(store->bodies, sizeof(body_t *) * store->capacity);
+    assert(store->bodies != NULL);
+  }
+
+  size_t slot = store->size++;
+  store->x[slot] = body->centroid.x;
+  store->y[slot] = body->centroid.y;
+  store->vx[slot] = body->velocity.x;
+  store->vy[slot] = body->velocity.y;
+  store->fx[slot] = body->force.x;
+  store->fy[slot] = body->force.y;
+  store->jx[slot] = body->impulse.x;
+  store->jy[slot] = body->impulse.y;
+  // Matches body_tick(), so attached bodies move identically
+  store->inv_mass[slot] = body_get_inverse_mass(body);
+  store->bodies[slot] = body;
+  body->store = store;
+  body->slot = slot;
+  if (body->kind != BODY_STATIC) {
+    store_swap_slots(store, slot, store->num_moving++);
+  }
+}
+
+void body_store_detach(body_t *body) {
+  body_store_t *store = body->store;
+  assert(store != NULL);
+
+  size_t slot = body->slot;
+  body->centroid = (vector_t){store->x[slot], store->y[slot]};
+  body->velocity = (vector_t){store->vx[slot], store->vy[slot]};
+  body->force = (vector_t){store->fx[slot], store->fy[slot]};
+  body->impulse = (vector_t){store->jx[slot], store->jy[slot]};
+  body->store = NULL;
+
+  // Moves the freed slot to the end, first moving a freed moving slot to
+  // the boundary so the static bodies stay after the moving ones
+  if (slot < store->num_moving) {
+    store_swap_slots(store, slot, --store->num_moving);
+    slot = store->num_moving;
+  }
+  store_swap_slots(store, slot, --store->size);
+}
+
+void body_store_tick(body_store_t *store, double dt) {
+  store_integrate(store, 0, store->num_moving, dt);
+}
+
+void body_store_tick_range(body_store_t *store, size_t start, size_t end,
+                           double dt) {
+  assert(start <= end && end <= store->num_moving);
+  store_integrate(store, start, end, dt);
+}
@@ -1,5 +1,6 @@
 #include "collision.h"
 
+#include "body.h"
 #include "list.h"
 #include "polygon.h"
 #include "vector.h"
@@ -13,34 +14,11 @@ typedef struct seperation_helper {
   double overlap;
 } seperation_helper_t;
 
-list_t *get_normalized_proj_axes(list_t *shape) {
-  size_t num_verts = list_size(shape);
-  list_t *axes = list_init(num_verts, free);
-  for (size_t i = 0; i < num_verts; ++i) {
-    // Calculate axis (unit vector perpendicular to edge)
-    vector_t vert1 = *(vector_t *)list_get(shape, i);
-    vector_t vert2 = *(vector_t *)list_get(shape, (i + 1) % list_size(shape));
-    vector_t edge = vec_subtract(vert2, vert1);
-    vector_t edge_normal = vec_rotate_90(edge, true);
-    vector_t axis = vec_normalize(edge_normal);
-
-    // Add axis to list
-    vector_t *axis_ptr = malloc(sizeof(vector_t));
-    *axis_ptr = axis;
-    list_add(axes, axis_ptr);
-  }
-  return axes;
-}
-
 /**
- * Returns whether the projections of the given shapes onto the given axis are
- * separated. If so, the return also contains the amount of overlap the two
- * shapes have once projected onto the given axis.
+ * Returns whether two projected ranges are separated. If not, the return also
+ * contains the amount the ranges overlap.
  */
-seperation_helper_t shapes_are_separated(vector_t normalized_axis,
-                                         list_t *shape1, list_t *shape2) {
-  range_t proj1 = polygon_proj(shape1, normalized_axis, false);
-  range_t proj2 = polygon_proj(shape2, normalized_axis, false);
+seperation_helper_t ranges_are_separated(range_t proj1, range_t proj2) {
   seperation_helper_t seperated_info;
   seperated_info.seperated = proj1.max < proj2.min || proj2.max < proj1.min;
   double overlap;
@@ -67,44 +45,250 @@ seperation_helper_t shapes_are_separated(vector_t normalized_axis,
   return seperated_info;
 }
 
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
-  list_t *axes1 = get_normalized_proj_axes(shape1);
-  list_t *axes2 = get_normalized_proj_axes(shape2);
+/**
+ * Returns whether the projections of the given shapes onto the given axis are
+ * separated. If so, the return also contains the amount of overlap the two
+ * shapes have once projected onto the given axis.
+ */
+seperation_helper_t shapes_are_separated(vector_t normalized_axis,
+                                         const vector_t *shape1, size_t size1,
+                                         const vector_t *shape2, size_t size2) {
+  range_t proj1 = vertices_proj(shape1, size1, normalized_axis, false);
+  range_t proj2 = vertices_proj(shape2, size2, normalized_axis, false);
+  return ranges_are_separated(proj1, proj2);
+}
 
-  collision_info_t ret_info;
+/**
+ * Tests one axis of a separating axis search, keeping track of the axis of
+ * minimum overlap seen so far.
+ *
+ * @return whether the shapes are separated along the axis
+ */
+bool separated_on_axis(vector_t normalized_axis, const vector_t *shape1,
+                       size_t size1, const vector_t *shape2, size_t size2,
+                       double *min_overlap, vector_t *min_axis) {
+  seperation_helper_t seperated_info =
+      shapes_are_separated(normalized_axis, shape1, size1, shape2, size2);
+  if (seperated_info.seperated) {
+    return true;
+  }
+  // finds the axis of minimum overlap
+  if (*min_overlap > seperated_info.overlap) {
+    *min_axis = normalized_axis;
+    *min_overlap = seperated_info.overlap;
+  }
+  return false;
+}
+
+/**
+ * Records the axis a collision test should try first next time.
+ */
+void cache_axis(separating_axis_cache_t *cache, vector_t axis) {
+  if (cache != NULL) {
+    cache->has_axis = true;
+    cache->axis = axis;
+  }
+}
+
+collision_info_t find_normals_collision(const vector_t *shape1,
+                                        const vector_t *normals1, size_t size1,
+                                        const vector_t *shape2,
+                                        const vector_t *normals2, size_t size2,
+                                        separating_axis_cache_t *cache) {
+  collision_info_t ret_info = {.collided = false};
+  // Shapes that were apart last time are usually still apart along the
+  // same axis. Any separating axis proves the shapes are apart, so the
+  // cached axis is only used to exit early, never as the collision axis.
+  if (cache != NULL && cache->has_axis &&
+      shapes_are_separated(cache->axis, shape1, size1, shape2, size2)
+          .seperated) {
+    return ret_info;
+  }
 
-  size_t num_axes1 = list_size(axes1);
-  size_t num_axes2 = list_size(axes2);
-  size_t num_axes = num_axes1 + num_axes2;
-  ret_info.collided = true;
   double min = INFINITY;
-  vector_t min_axis;
-  for (size_t i = 0; i < num_axes; ++i) {
-    list_t *axis_group = (i < num_axes1) ? axes1 : axes2;
-    if (num_axes1 == 0) {
-      num_axes1 = num_axes2;
-      axis_group = axes2;
+  vector_t min_axis = VEC_ZERO;
+  const vector_t *normals[2] = {normals1, normals2};
+  size_t sizes[2] = {size1, size2};
+  for (size_t s = 0; s < 2; ++s) {
+    for (size_t i = 0; i < sizes[s]; ++i) {
+      if (separated_on_axis(normals[s][i], shape1, size1, shape2, size2, &min,
+                            &min_axis)) {
+        cache_axis(cache, normals[s][i]);
+        return ret_info;
+      }
     }
-    vector_t axis = *(vector_t *)list_get(axis_group, i % num_axes1);
-    seperation_helper_t seperated_info =
-        shapes_are_separated(axis, shape1, shape2);
-    if (seperated_info.seperated == true) {
-      ret_info.collided = false;
-      break;
-    } else {
-      // finds the axis of minimum overlap
-      if (min > seperated_info.overlap) {
-        min_axis = axis;
-        min = seperated_info.overlap;
+  }
+  ret_info.collided = true;
+  ret_info.axis = min_axis;
+  // The shapes most likely separate along the axis they overlap least on
+  cache_axis(cache, min_axis);
+  return ret_info;
+}
+
+collision_info_t find_vertices_collision(const vector_t *shape1, size_t size1,
+                                         const vector_t *shape2, size_t size2) {
+  collision_info_t ret_info = {.collided = false};
+  double min = INFINITY;
+  vector_t min_axis = VEC_ZERO;
+  // Computes each edge normal as it is needed, so nothing is allocated
+  // and a separated pair skips normalizing the remaining edges
+  const vector_t *shapes[2] = {shape1, shape2};
+  size_t sizes[2] = {size1, size2};
+  for (size_t s = 0; s < 2; ++s) {
+    for (size_t i = 0; i < sizes[s]; ++i) {
+      const vector_t *shape = shapes[s];
+      vector_t edge = vec_subtract(shape[(i + 1) % sizes[s]], shape[i]);
+      vector_t axis = vec_normalize(vec_rotate_90(edge, true));
+      if (separated_on_axis(axis, shape1, size1, shape2, size2, &min,
+                            &min_axis)) {
+        return ret_info;
       }
     }
   }
+  ret_info.collided = true;
+  ret_info.axis = min_axis;
+  return ret_info;
+}
+
+collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+  polygon_t *polygon1 = polygon_from_list(shape1);
+  polygon_t *polygon2 = polygon_from_list(shape2);
+  collision_info_t ret_info = find_vertices_collision(
+      polygon_vertices(polygon1), polygon_size(polygon1),
+      polygon_vertices(polygon2), polygon_size(polygon2));
+  polygon_free(polygon1);
+  polygon_free(polygon2);
+  return ret_info;
+}
+
+collision_info_t find_circles_collision(vector_t center1, double radius1,
+                                        vector_t center2, double radius2) {
+  collision_info_t ret_info = {.collided = false};
+  vector_t difference = vec_subtract(center2, center1);
+  double distance_squared = vec_dot(difference, difference);
+  double radii = radius1 + radius2;
+  if (distance_squared > radii * radii) {
+    return ret_info;
+  }
+  ret_info.collided = true;
+  // Concentric circles can be pushed apart along any axis
+  ret_info.axis = distance_squared > 0
+                      ? vec_multiply(1 / sqrt(distance_squared), difference)
+                      : (vector_t){1, 0};
+  return ret_info;
+}
+
+/**
+ * Tests one axis of a circle-polygon separating axis search, keeping track of
+ * the axis of minimum overlap seen so far.
+ *
+ * @return whether the shapes are separated along the axis
+ */
+bool circle_separated_on_axis(vector_t normalized_axis, vector_t center,
+                              double radius, const vector_t *shape,
+                              size_t size, double *min_overlap,
+                              vector_t *min_axis) {
+  double center_proj = vec_dot(center, normalized_axis);
+  range_t circle_proj = {center_proj - radius, center_proj + radius};
+  range_t polygon_proj = vertices_proj(shape, size, normalized_axis, false);
+  seperation_helper_t seperated_info =
+      ranges_are_separated(circle_proj, polygon_proj);
+  if (seperated_info.seperated) {
+    return true;
+  }
+  if (*min_overlap > seperated_info.overlap) {
+    *min_axis = normalized_axis;
+    *min_overlap = seperated_info.overlap;
+  }
+  return false;
+}
 
-  if (ret_info.collided == true) {
-    ret_info.axis = min_axis;
+collision_info_t find_circle_polygon_collision(vector_t center, double radius,
+                                               const vector_t *shape,
+                                               const vector_t *normals,
+                                               size_t size,
+                                               separating_axis_cache_t *cache) {
+  collision_info_t ret_info = {.collided = false};
+  double min = INFINITY;
+  vector_t min_axis = {1, 0};
+  // See find_normals_collision(); the cached axis only allows an early exit
+  double ignored_min = -INFINITY;
+  if (cache != NULL && cache->has_axis &&
+      circle_separated_on_axis(cache->axis, center, radius, shape, size,
+                               &ignored_min, &min_axis)) {
+    return ret_info;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (circle_separated_on_axis(normals[i], center, radius, shape, size, &min,
+                                 &min_axis)) {
+      cache_axis(cache, normals[i]);
+      return ret_info;
+    }
+  }
+
+  // A circle has no edges; the only other axis that can separate it from a
+  // polygon runs from the polygon's closest vertex to the circle's center
+  size_t closest = 0;
+  double closest_distance = INFINITY;
+  vector_t interior = VEC_ZERO;
+  for (size_t i = 0; i < size; ++i) {
+    vector_t offset = vec_subtract(center, shape[i]);
+    double distance = vec_dot(offset, offset);
+    if (distance < closest_distance) {
+      closest = i;
+      closest_distance = distance;
+    }
+    interior = vec_add(interior, shape[i]);
+  }
+  if (closest_distance > 0) {
+    vector_t axis = vec_multiply(1 / sqrt(closest_distance),
+                                 vec_subtract(center, shape[closest]));
+    if (circle_separated_on_axis(axis, center, radius, shape, size, &min,
+                                 &min_axis)) {
+      cache_axis(cache, axis);
+      return ret_info;
+    }
   }
 
-  list_free(axes1);
-  list_free(axes2);
+  ret_info.collided = true;
+  cache_axis(cache, min_axis);
+  // Point the axis from the circle towards the polygon's interior
+  interior = vec_multiply(1.0 / size, interior);
+  if (vec_dot(min_axis, vec_subtract(interior, center)) < 0) {
+    min_axis = vec_negate(min_axis);
+  }
+  ret_info.axis = min_axis;
   return ret_info;
 }
+
+collision_info_t find_body_collision(body_t *body1, body_t *body2,
+                                     separating_axis_cache_t *cache) {
+  if (body_is_circle(body1) && body_is_circle(body2)) {
+    return find_circles_collision(body_get_centroid(body1),
+                                  body_get_radius(body1),
+                                  body_get_centroid(body2),
+                                  body_get_radius(body2));
+  }
+  if (body_is_circle(body1) || body_is_circle(body2)) {
+    body_t *circle = body_is_circle(body1) ? body1 : body2;
+    body_t *polygon = circle == body1 ? body2 : body1;
+    polygon_view_t shape = body_view_shape(polygon);
+    polygon_view_t normals = body_view_normals(polygon);
+    collision_info_t info = find_circle_polygon_collision(
+        body_get_centroid(circle), body_get_radius(circle), shape.vertices,
+        normals.vertices, shape.size, cache);
+    // The axis points from the circle, so flip it if the circle is body2
+    if (info.collided && circle == body2) {
+      info.axis = vec_negate(info.axis);
+    }
+    return info;
+  }
+
+  polygon_view_t shape1 = body_view_shape(body1);
+  polygon_view_t shape2 = body_view_shape(body2);
+  polygon_view_t normals1 = body_view_normals(body1);
+  polygon_view_t normals2 = body_view_normals(body2);
+  return find_normals_collision(shape1.vertices, normals1.vertices,
+                                shape1.size, shape2.vertices,
+                                normals2.vertices, shape2.size, cache);
+}
@@ -1,16 +1,26 @@
 #include "forces.h"
 
+#include "barnes_hut.h"
 #include "collision.h"
 #include "list.h"
+#include "polygon.h"
+#include "rng.h"
 #include "scene.h"
+#include "spatial_grid.h"
 #include "vector.h"
 
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 const double GRAVITY_MIN_DIST = 5;
 
+/**
+ * The most random numbers a random impulse draws in one tick.
+ */
+const uint64_t RANDOM_IMPULSE_DRAWS = 5;
+
 // TODO
 // typedef struct const_body_aux {
 //   list_t *consts;
@@ -24,6 +34,8 @@ typedef struct force_aux {
   void *const_body_aux;
   free_func_t freer;
   bool already_colliding;
+  // The axis to test first the next time the pair is checked
+  separating_axis_cache_t axis_cache;
 } force_aux_t;
 
 force_aux_t *force_aux_init(collision_handler_t handler, void *aux,
@@ -34,6 +46,7 @@ force_aux_t *force_aux_init(collision_handler_t handler, void *aux,
   force_aux->const_body_aux = aux;
   force_aux->freer = freer;
   force_aux->already_colliding = false;
+  force_aux->axis_cache.has_axis = false;
   return force_aux;
 }
 
@@ -64,63 +77,98 @@ void const_body_aux_free(void *aux) {
   free(tpd_aux);
 }
 
-void apply_newtonian(void *aux) {
-  const_body_aux_t *tpd_aux = aux;
-  body_t *body1 = list_get(tpd_aux->bodies, 0);
-  body_t *body2 = list_get(tpd_aux->bodies, 1);
-  double big_g = *(double *)list_get(tpd_aux->consts, 0);
-  vector_t centroid1 = body_get_centroid(body1);
-  vector_t centroid2 = body_get_centroid(body2);
-  double dist = vec_dist(centroid1, centroid2);
-  if (dist < GRAVITY_MIN_DIST) {
-    return;
+/**
+ * Applies gravity for records {body1, body2, {G}}.
+ */
+void apply_newtonian_batch(scene_t *scene, force_record_t *records,
+                           size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    force_record_t *record = &records[i];
+    if (force_record_is_idle(record)) {
+      continue;
+    }
+    vector_t centroid1 = body_get_centroid(record->body1);
+    vector_t centroid2 = body_get_centroid(record->body2);
+    double dx = centroid2.x - centroid1.x;
+    double dy = centroid2.y - centroid1.y;
+    double dist = sqrt(dx * dx + dy * dy);
+    if (dist < GRAVITY_MIN_DIST) {
+      continue;
+    }
+    double force_mag = record->constants[0] * body_get_mass(record->body1) *
+                       body_get_mass(record->body2) / (dist * dist * dist);
+    vector_t force = {force_mag * dx, force_mag * dy};
+    body_add_force(record->body1, force);
+    body_add_force(record->body2, vec_negate(force));
   }
-  vector_t dir_1_to_2 =
-      vec_multiply(1.0 / dist, vec_subtract(centroid2, centroid1));
-  vector_t dir_2_to_1 = vec_negate(dir_1_to_2);
-  double force_mag =
-      big_g * body_get_mass(body1) * body_get_mass(body2) / (dist * dist);
-  body_add_force(body1, vec_multiply(force_mag, dir_1_to_2));
-  body_add_force(body2, vec_multiply(force_mag, dir_2_to_1));
 }
 
-void apply_spring(void *aux) {
-  const_body_aux_t *tpd_aux = aux;
-  body_t *body1 = list_get(tpd_aux->bodies, 0);
-  body_t *body2 = list_get(tpd_aux->bodies, 1);
-  double k = *(double *)list_get(tpd_aux->consts, 0);
-  vector_t centroid1 = body_get_centroid(body1);
-  vector_t centroid2 = body_get_centroid(body2);
-  vector_t disp_1_to_2 = vec_subtract(centroid2, centroid1);
-  vector_t disp_2_to_1 = vec_negate(disp_1_to_2);
-  body_add_force(body1, vec_multiply(k, disp_1_to_2));
-  body_add_force(body2, vec_multiply(k, disp_2_to_1));
+/**
+ * Applies springs for records {body1, body2, {k}}.
+ */
+void apply_spring_batch(scene_t *scene, force_record_t *records,
+                        size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    force_record_t *record = &records[i];
+    if (force_record_is_idle(record)) {
+      continue;
+    }
+    vector_t centroid1 = body_get_centroid(record->body1);
+    vector_t centroid2 = body_get_centroid(record->body2);
+    double k = record->constants[0];
+    vector_t force = {k * (centroid2.x - centroid1.x),
+                      k * (centroid2.y - centroid1.y)};
+    body_add_force(record->body1, force);
+    body_add_force(record->body2, vec_negate(force));
+  }
 }
 
-void apply_drag(void *aux) {
-  const_body_aux_t *tpd_aux = aux;
-  body_t *body = list_get(tpd_aux->bodies, 0);
-  double gamma = *(double *)list_get(tpd_aux->consts, 0);
-  vector_t force = vec_multiply(-gamma, body_get_velocity(body));
-  body_add_force(body, force);
+/**
+ * Applies drag for records {body, NULL, {gamma}}.
+ */
+void apply_drag_batch(scene_t *scene, force_record_t *records,
+                      size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    force_record_t *record = &records[i];
+    if (force_record_is_idle(record)) {
+      continue;
+    }
+    double gamma = record->constants[0];
+    vector_t velocity = body_get_velocity(record->body1);
+    body_add_force(record->body1,
+                   (vector_t){-gamma * velocity.x, -gamma * velocity.y});
+  }
 }
 
-void apply_random_impulse(void *aux) {
-  const_body_aux_t *tpd_aux = aux;
-  body_t *body = list_get(tpd_aux->bodies, 0);
-  double probability = *(double *)list_get(tpd_aux->consts, 0);
-  double max_impulse = *(double *)list_get(tpd_aux->consts, 1);
-
-  double random_impulse_x =
-      ((double)(rand() - rand()) / RAND_MAX * max_impulse);
-  double random_impulse_y =
-      ((double)(rand() - rand()) / RAND_MAX * max_impulse);
-
-  double random_prob = ((double)rand() / RAND_MAX);
+/**
+ * Applies random impulses for records
+ * {body, NULL, {probability, max_impulse}}.
+ */
+void apply_random_impulse_batch(scene_t *scene, force_record_t *records,
+                                size_t count) {
+  uint64_t seed = scene_get_seed(scene);
+  uint64_t first_draw = scene_get_tick(scene) * RANDOM_IMPULSE_DRAWS;
+  for (size_t i = 0; i < count; i++) {
+    force_record_t *record = &records[i];
+    if (force_record_is_idle(record)) {
+      continue;
+    }
+    double probability = record->constants[0];
+    double max_impulse = record->constants[1];
 
-  if (random_prob <= probability) {
-    body_add_impulse(body,
-                     (vector_t){.x = random_impulse_x, .y = random_impulse_y});
+    // Each record draws from its own stream, and each tick from its own
+    // stretch of that stream, so no state is shared between records or ticks
+    rng_t rng = {seed, record->stream, first_draw};
+    double random_prob = rng_next_double(&rng);
+    if (random_prob > probability) {
+      continue;
+    }
+    double random_impulse_x =
+        (rng_next_double(&rng) - rng_next_double(&rng)) * max_impulse;
+    double random_impulse_y =
+        (rng_next_double(&rng) - rng_next_double(&rng)) * max_impulse;
+    body_add_impulse(record->body1, (vector_t){.x = random_impulse_x,
+                                               .y = random_impulse_y});
   }
 }
 
@@ -139,13 +187,14 @@ void apply_physics_collision(body_t *body1, body_t *body2, vector_t axis,
                              void *aux) {
   const_body_aux_t *tpd_aux = aux;
   double *elasticity = list_get(tpd_aux->consts, 0);
-  if (body_get_mass(body1) == INFINITY) {
+  // Bodies that forces cannot move act like walls
+  if (body_get_inverse_mass(body1) == 0) {
     double m = body_get_mass(body2);
     vector_t body2_speed = body_get_velocity(body2);
     double impulse = vec_dot(axis, body2_speed);
     impulse = impulse * m * (1 + *elasticity);
     body_add_impulse(body2, vec_multiply(impulse, axis));
-  } else if (body_get_mass(body2) == INFINITY) {
+  } else if (body_get_inverse_mass(body2) == 0) {
     double m = body_get_mass(body1);
     vector_t body1_speed = body_get_velocity(body1);
     double impulse = vec_dot(axis, body1_speed);
@@ -212,11 +261,8 @@ void collision(void *aux) {
   const_body_aux_t *tpd_aux = force_aux->const_body_aux;
   body_t *body1 = list_get(tpd_aux->bodies, 0);
   body_t *body2 = list_get(tpd_aux->bodies, 1);
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  collision_info_t bodies_are_colliding = find_collision(shape1, shape2);
-  list_free(shape1);
-  list_free(shape2);
+  collision_info_t bodies_are_colliding =
+      find_body_collision(body1, body2, &force_aux->axis_cache);
   if (bodies_are_colliding.collided) {
     if (force_aux->already_colliding == false) {
       force_aux->handler(body1, body2, bodies_are_colliding.axis,
@@ -228,81 +274,682 @@ void collision(void *aux) {
   }
 }
 
+/**
+ * Called by the scene's broad phase when a collision's bodies stop being
+ * candidates for contact, since collision() is no longer run to notice.
+ */
+void collision_separated(void *aux) {
+  force_aux_t *force_aux = aux;
+  force_aux->already_colliding = false;
+}
+
 void create_newtonian_gravity(scene_t *scene, double big_g, body_t *body1,
                               body_t *body2) {
-  // build force aux
-  list_t *aux_bodies = list_init(2, (free_func_t)body_free);
-  list_add(aux_bodies, body1);
-  list_add(aux_bodies, body2);
-  list_t *consts = list_init(1, free);
-  double *big_g_ptr = malloc(sizeof(double));
-  *big_g_ptr = big_g;
-  list_add(consts, big_g_ptr);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
+  scene_add_force_record(
+      scene, apply_newtonian_batch,
+      (force_record_t){.body1 = body1, .body2 = body2, .constants = {big_g}});
+}
 
-  // add force creator to the scene
-  list_t *scene_bodies = list_init(2, (free_func_t)body_free);
-  list_add(scene_bodies, body1);
-  list_add(scene_bodies, body2);
-  scene_add_bodies_force_creator(scene, apply_newtonian, aux, scene_bodies,
-                                 const_body_aux_free);
+/**
+ * The state of a create_gravity_field() force creator.
+ * The arrays are reused every tick and only grow with the number of bodies.
+ */
+typedef struct gravity_field {
+  scene_t *scene;
+  double big_g;
+  double theta;
+  barnes_hut_t *tree;
+  body_t **bodies;
+  vector_t *positions;
+  double *masses;
+  size_t capacity;
+} gravity_field_t;
+
+void gravity_field_free(void *aux) {
+  gravity_field_t *field = aux;
+  barnes_hut_free(field->tree);
+  free(field->bodies);
+  free(field->positions);
+  free(field->masses);
+  free(field);
 }
 
-void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
-  // build force_aux_t
-  list_t *aux_bodies = list_init(2, (free_func_t)body_free);
-  list_add(aux_bodies, body1);
-  list_add(aux_bodies, body2);
-  list_t *consts = list_init(1, free);
-  double *k_ptr = malloc(sizeof(double));
-  *k_ptr = k;
-  list_add(consts, k_ptr);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
+void apply_gravity_field(void *aux) {
+  gravity_field_t *field = aux;
+  size_t num_bodies = scene_bodies(field->scene);
+  if (num_bodies > field->capacity) {
+    field->capacity = num_bodies;
+    field->bodies = realloc(field->bodies, sizeof(body_t *) * num_bodies);
+    field->positions =
+        realloc(field->positions, sizeof(vector_t) * num_bodies);
+    field->masses = realloc(field->masses, sizeof(double) * num_bodies);
+    assert(field->bodies != NULL);
+    assert(field->positions != NULL);
+    assert(field->masses != NULL);
+  }
 
-  // add force creator to the scene
-  list_t *scene_bodies = list_init(2, (free_func_t)body_free);
-  list_add(scene_bodies, body1);
-  list_add(scene_bodies, body2);
-  scene_add_bodies_force_creator(scene, apply_spring, aux, scene_bodies,
-                                 const_body_aux_free);
+  // Like pairwise gravity, bodies removed this tick still count until the
+  // scene frees them at the end of the tick
+  size_t count = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(field->scene, i);
+    double mass = body_get_mass(body);
+    if (mass == INFINITY) {
+      continue;
+    }
+    field->bodies[count] = body;
+    field->positions[count] = body_get_centroid(body);
+    field->masses[count] = mass;
+    count++;
+  }
+
+  barnes_hut_build(field->tree, field->positions, field->masses, count);
+  for (size_t i = 0; i < count; i++) {
+    if (body_get_inverse_mass(field->bodies[i]) == 0) {
+      continue;
+    }
+    vector_t accel = barnes_hut_field(field->tree, field->positions[i], i,
+                                      field->theta, GRAVITY_MIN_DIST);
+    body_add_force(field->bodies[i],
+                   vec_multiply(field->big_g * field->masses[i], accel));
+  }
+}
+
+void create_gravity_field(scene_t *scene, double big_g, double theta) {
+  assert(theta >= 0);
+  gravity_field_t *field = malloc(sizeof(gravity_field_t));
+  assert(field != NULL);
+  field->scene = scene;
+  field->big_g = big_g;
+  field->theta = theta;
+  field->tree = barnes_hut_init();
+  field->bodies = NULL;
+  field->positions = NULL;
+  field->masses = NULL;
+  field->capacity = 0;
+
+  // No bodies are listed, so removing bodies never removes the field
+  scene_add_bodies_force_creator(scene, apply_gravity_field, field, NULL,
+                                 gravity_field_free);
+}
+
+/**
+ * A pair of bodies in a Verlet list, as indices into built_bodies.
+ */
+typedef struct neighbor_pair {
+  size_t body1;
+  size_t body2;
+} neighbor_pair_t;
+
+/**
+ * The state of a create_pair_interaction() force creator.
+ * The arrays are reused every tick and only grow with the group.
+ */
+typedef struct pair_interaction {
+  // The group, owned by the scene's force
+  list_t *bodies;
+  double cutoff;
+  double skin;
+  pair_kernel_t kernel;
+  void *aux;
+  free_func_t freer;
+
+  spatial_grid_t *grid;
+  // The group, and where each body was, when the Verlet list was built
+  body_t **built_bodies;
+  vector_t *built_centroids;
+  size_t num_built;
+  // Where each body is this tick
+  vector_t *centroids;
+  size_t bodies_capacity;
+
+  neighbor_pair_t *pairs;
+  size_t num_pairs;
+  size_t pairs_capacity;
+} pair_interaction_t;
+
+void pair_interaction_free(void *aux) {
+  pair_interaction_t *interaction = aux;
+  if (interaction->freer != NULL) {
+    interaction->freer(interaction->aux);
+  }
+  spatial_grid_free(interaction->grid);
+  free(interaction->built_bodies);
+  free(interaction->built_centroids);
+  free(interaction->centroids);
+  free(interaction->pairs);
+  free(interaction);
+}
+
+/**
+ * Adds a pair of bodies from the grid to the Verlet list
+ * if they are within cutoff + skin of each other.
+ */
+void add_neighbor_pair(size_t body1, size_t body2, void *aux) {
+  pair_interaction_t *interaction = aux;
+  double reach = interaction->cutoff + interaction->skin;
+  if (vec_dist(interaction->centroids[body1], interaction->centroids[body2]) >=
+      reach) {
+    return;
+  }
+  if (interaction->num_pairs == interaction->pairs_capacity) {
+    interaction->pairs_capacity = interaction->pairs_capacity == 0
+                                      ? 8
+                                      : 2 * interaction->pairs_capacity;
+    interaction->pairs =
+        realloc(interaction->pairs,
+                sizeof(neighbor_pair_t) * interaction->pairs_capacity);
+    assert(interaction->pairs != NULL);
+  }
+  interaction->pairs[interaction->num_pairs++] =
+      (neighbor_pair_t){body1, body2};
+}
+
+/**
+ * Rebuilds the Verlet list from this tick's centroids.
+ */
+void build_neighbor_list(pair_interaction_t *interaction, size_t num_bodies) {
+  double half_reach = (interaction->cutoff + interaction->skin) / 2;
+  vector_t half_size = {half_reach, half_reach};
+  spatial_grid_clear(interaction->grid);
+  for (size_t i = 0; i < num_bodies; i++) {
+    vector_t centroid = interaction->centroids[i];
+    interaction->built_bodies[i] = list_get(interaction->bodies, i);
+    interaction->built_centroids[i] = centroid;
+    aabb_t bounds = {vec_subtract(centroid, half_size),
+                     vec_add(centroid, half_size)};
+    spatial_grid_insert(interaction->grid, i, bounds);
+  }
+  interaction->num_built = num_bodies;
+  interaction->num_pairs = 0;
+  spatial_grid_pairs(interaction->grid, add_neighbor_pair, interaction);
+}
+
+void apply_pair_interaction(void *aux) {
+  pair_interaction_t *interaction = aux;
+  size_t num_bodies = list_size(interaction->bodies);
+  if (num_bodies > interaction->bodies_capacity) {
+    interaction->bodies_capacity = num_bodies;
+    interaction->built_bodies = realloc(interaction->built_bodies,
+                                        sizeof(body_t *) * num_bodies);
+    interaction->built_centroids = realloc(interaction->built_centroids,
+                                           sizeof(vector_t) * num_bodies);
+    interaction->centroids =
+        realloc(interaction->centroids, sizeof(vector_t) * num_bodies);
+    assert(interaction->built_bodies != NULL);
+    assert(interaction->built_centroids != NULL);
+    assert(interaction->centroids != NULL);
+  }
+
+  // The list is stale once the group changes or a body moves more than half
+  // the skin, since two bodies could then have closed the whole skin
+  double max_shift = interaction->skin / 2;
+  bool stale = num_bodies != interaction->num_built;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(interaction->bodies, i);
+    vector_t centroid = body_get_centroid(body);
+    interaction->centroids[i] = centroid;
+    stale = stale || body != interaction->built_bodies[i] ||
+            vec_dist(centroid, interaction->built_centroids[i]) > max_shift;
+  }
+  if (stale) {
+    build_neighbor_list(interaction, num_bodies);
+  }
+
+  for (size_t i = 0; i < interaction->num_pairs; i++) {
+    neighbor_pair_t pair = interaction->pairs[i];
+    vector_t offset = vec_subtract(interaction->centroids[pair.body2],
+                                   interaction->centroids[pair.body1]);
+    if (vec_norm(offset) >= interaction->cutoff) {
+      continue;
+    }
+    body_t *body1 = interaction->built_bodies[pair.body1];
+    body_t *body2 = interaction->built_bodies[pair.body2];
+    vector_t force =
+        interaction->kernel(body1, body2, offset, interaction->aux);
+    body_add_force(body1, force);
+    body_add_force(body2, vec_negate(force));
+  }
+}
+
+void create_pair_interaction(scene_t *scene, list_t *bodies, double cutoff,
+                             double skin, pair_kernel_t kernel, void *aux,
+                             free_func_t freer) {
+  assert(cutoff > 0);
+  assert(skin >= 0);
+  pair_interaction_t *interaction = malloc(sizeof(pair_interaction_t));
+  assert(interaction != NULL);
+  interaction->bodies = bodies;
+  interaction->cutoff = cutoff;
+  interaction->skin = skin;
+  interaction->kernel = kernel;
+  interaction->aux = aux;
+  interaction->freer = freer;
+  interaction->grid = spatial_grid_init(cutoff + skin);
+  interaction->built_bodies = NULL;
+  interaction->built_centroids = NULL;
+  interaction->num_built = 0;
+  interaction->centroids = NULL;
+  interaction->bodies_capacity = 0;
+  interaction->pairs = NULL;
+  interaction->num_pairs = 0;
+  interaction->pairs_capacity = 0;
+  scene_add_group_force_creator(scene, apply_pair_interaction, interaction,
+                                bodies, pair_interaction_free);
+}
+
+typedef struct spring_edge {
+  size_t body1;
+  size_t body2;
+  double k;
+  double rest_length;
+  double damping;
+} spring_edge_t;
+
+struct spring_network {
+  // The group, owned by the scene's force
+  list_t *bodies;
+  scene_t *scene;
+  bool implicit;
+  // Every body the group started with. The edges refer to these, so an
+  // edge comes back if a restored snapshot puts its bodies back in the group.
+  body_t **all_members;
+  size_t num_all;
+  // The bodies in the group as of the last sync, and the index of each in
+  // all_members
+  body_t **members;
+  size_t *member_ids;
+  size_t num_members;
+  // Each member's state, read once per tick
+  vector_t *centroids;
+  vector_t *velocities;
+  vector_t *forces;
+  double *inverse_masses;
+
+  // Every spring, by index into all_members. Springs are only ever added,
+  // so a snapshot restores them by saving num_edges.
+  spring_edge_t *edges;
+  size_t num_edges;
+  size_t edges_capacity;
+  // The springs whose bodies are both in the group, by index into members,
+  // built from the first num_synced springs
+  spring_edge_t *active;
+  size_t num_active;
+  size_t num_synced;
+};
+
+void spring_network_free(void *aux) {
+  spring_network_t *network = aux;
+  free(network->all_members);
+  free(network->members);
+  free(network->member_ids);
+  free(network->centroids);
+  free(network->velocities);
+  free(network->forces);
+  free(network->inverse_masses);
+  free(network->edges);
+  free(network->active);
+  free(network);
+}
+
+/**
+ * Reindexes the springs if the group or the springs have changed since the
+ * last sync, e.g. the scene dropped removed bodies from the group, or a
+ * snapshot put them back and dropped the springs added since.
+ * The group always keeps the order the bodies started in, so the members
+ * are matched up with all_members in one pass.
+ */
+void spring_network_sync(spring_network_t *network) {
+  size_t num_bodies = list_size(network->bodies);
+  bool changed = num_bodies != network->num_members ||
+                 network->num_edges != network->num_synced;
+  for (size_t i = 0; i < num_bodies && !changed; i++) {
+    changed = list_get(network->bodies, i) != network->members[i];
+  }
+  if (!changed) {
+    return;
+  }
+
+  size_t *new_index = malloc(sizeof(size_t) * (network->num_all + 1));
+  assert(new_index != NULL);
+  size_t next = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(network->bodies, i);
+    while (network->all_members[next] != body) {
+      new_index[next++] = SIZE_MAX;
+      assert(next < network->num_all);
+    }
+    network->members[i] = body;
+    network->member_ids[i] = next;
+    new_index[next++] = i;
+  }
+  while (next < network->num_all) {
+    new_index[next++] = SIZE_MAX;
+  }
+  network->num_members = num_bodies;
+
+  network->num_active = 0;
+  for (size_t i = 0; i < network->num_edges; i++) {
+    spring_edge_t edge = network->edges[i];
+    edge.body1 = new_index[edge.body1];
+    edge.body2 = new_index[edge.body2];
+    if (edge.body1 != SIZE_MAX && edge.body2 != SIZE_MAX) {
+      network->active[network->num_active++] = edge;
+    }
+  }
+  network->num_synced = network->num_edges;
+  free(new_index);
+}
+
+/**
+ * Adds each spring's force to the forces on its bodies.
+ * Like the body store's kernel, this works on components directly,
+ * since calling the vector functions dominates such a short loop.
+ */
+void spring_network_explicit(spring_network_t *network) {
+  vector_t *centroids = network->centroids;
+  vector_t *velocities = network->velocities;
+  vector_t *forces = network->forces;
+  for (size_t i = 0; i < network->num_active; i++) {
+    spring_edge_t edge = network->active[i];
+    double dx = centroids[edge.body2].x - centroids[edge.body1].x;
+    double dy = centroids[edge.body2].y - centroids[edge.body1].y;
+    double length = sqrt(dx * dx + dy * dy);
+    if (length == 0) {
+      continue;
+    }
+    double nx = dx / length, ny = dy / length;
+    double relative_speed =
+        (velocities[edge.body2].x - velocities[edge.body1].x) * nx +
+        (velocities[edge.body2].y - velocities[edge.body1].y) * ny;
+    double magnitude = edge.k * (length - edge.rest_length) +
+                       edge.damping * relative_speed;
+    forces[edge.body1].x += magnitude * nx;
+    forces[edge.body1].y += magnitude * ny;
+    forces[edge.body2].x -= magnitude * nx;
+    forces[edge.body2].y -= magnitude * ny;
+  }
+}
+
+/**
+ * Applies a backward Euler step of each spring in turn to the velocities.
+ * Treating one spring on its own, the relative speed v along it after the
+ * step solves v' = v - dt * w * (k * (stretch + dt * v') + damping * v'),
+ * where w is the sum of the bodies' inverse masses.
+ */
+void spring_network_implicit(spring_network_t *network, double dt) {
+  vector_t *centroids = network->centroids;
+  vector_t *velocities = network->velocities;
+  double *inverse_masses = network->inverse_masses;
+  for (size_t i = 0; i < network->num_active; i++) {
+    spring_edge_t edge = network->active[i];
+    double inverse_mass1 = inverse_masses[edge.body1];
+    double inverse_mass2 = inverse_masses[edge.body2];
+    double inverse_mass = inverse_mass1 + inverse_mass2;
+    double dx = centroids[edge.body2].x - centroids[edge.body1].x;
+    double dy = centroids[edge.body2].y - centroids[edge.body1].y;
+    double length = sqrt(dx * dx + dy * dy);
+    if (length == 0 || inverse_mass == 0) {
+      continue;
+    }
+    double nx = dx / length, ny = dy / length;
+    double relative_speed =
+        (velocities[edge.body2].x - velocities[edge.body1].x) * nx +
+        (velocities[edge.body2].y - velocities[edge.body1].y) * ny;
+    double resistance = edge.damping + dt * edge.k;
+    double impulse = -dt *
+                     (edge.k * (length - edge.rest_length) +
+                      resistance * relative_speed) /
+                     (1 + dt * inverse_mass * resistance);
+    velocities[edge.body1].x -= inverse_mass1 * impulse * nx;
+    velocities[edge.body1].y -= inverse_mass1 * impulse * ny;
+    velocities[edge.body2].x += inverse_mass2 * impulse * nx;
+    velocities[edge.body2].y += inverse_mass2 * impulse * ny;
+  }
+}
+
+void apply_spring_network(void *aux) {
+  spring_network_t *network = aux;
+  spring_network_sync(network);
+  for (size_t i = 0; i < network->num_members; i++) {
+    body_t *body = network->members[i];
+    network->centroids[i] = body_get_centroid(body);
+    network->velocities[i] = body_get_velocity(body);
+    network->forces[i] = VEC_ZERO;
+    network->inverse_masses[i] = body_get_inverse_mass(body);
+  }
+
+  if (!network->implicit) {
+    spring_network_explicit(network);
+    for (size_t i = 0; i < network->num_members; i++) {
+      vector_t force = network->forces[i];
+      if (force.x != 0 || force.y != 0) {
+        body_add_force(network->members[i], force);
+      }
+    }
+    return;
+  }
+
+  spring_network_implicit(network, scene_get_tick_dt(network->scene));
+  for (size_t i = 0; i < network->num_members; i++) {
+    body_t *body = network->members[i];
+    vector_t dv = vec_subtract(network->velocities[i],
+                               body_get_velocity(body));
+    if ((dv.x != 0 || dv.y != 0) && network->inverse_masses[i] != 0) {
+      body_add_impulse(body,
+                       vec_multiply(1 / network->inverse_masses[i], dv));
+    }
+  }
+}
+
+spring_network_t *create_spring_network(scene_t *scene, list_t *bodies,
+                                        bool implicit) {
+  spring_network_t *network = malloc(sizeof(spring_network_t));
+  assert(network != NULL);
+  // The group never holds more than it starts with, so the arrays never
+  // need to grow
+  size_t num_bodies = list_size(bodies);
+  network->bodies = bodies;
+  network->scene = scene;
+  network->implicit = implicit;
+  network->all_members = malloc(sizeof(body_t *) * num_bodies);
+  network->members = malloc(sizeof(body_t *) * num_bodies);
+  network->member_ids = malloc(sizeof(size_t) * num_bodies);
+  network->centroids = malloc(sizeof(vector_t) * num_bodies);
+  network->velocities = malloc(sizeof(vector_t) * num_bodies);
+  network->forces = malloc(sizeof(vector_t) * num_bodies);
+  network->inverse_masses = malloc(sizeof(double) * num_bodies);
+  assert(num_bodies == 0 ||
+         (network->all_members != NULL && network->members != NULL &&
+          network->member_ids != NULL && network->centroids != NULL &&
+          network->velocities != NULL && network->forces != NULL &&
+          network->inverse_masses != NULL));
+  for (size_t i = 0; i < num_bodies; i++) {
+    network->all_members[i] = list_get(bodies, i);
+    network->members[i] = network->all_members[i];
+    network->member_ids[i] = i;
+  }
+  network->num_all = num_bodies;
+  network->num_members = num_bodies;
+  network->edges = NULL;
+  network->num_edges = 0;
+  network->edges_capacity = 0;
+  network->active = NULL;
+  network->num_active = 0;
+  network->num_synced = 0;
+  scene_add_group_force_creator(scene, apply_spring_network, network, bodies,
+                                spring_network_free);
+  scene_add_force_state(scene, network, &network->num_edges,
+                        sizeof(network->num_edges));
+  return network;
+}
+
+void spring_network_add(spring_network_t *network, size_t body1, size_t body2,
+                        double k, double rest_length, double damping) {
+  spring_network_sync(network);
+  assert(body1 < network->num_members && body2 < network->num_members);
+  assert(body1 != body2);
+  assert(k >= 0 && damping >= 0);
+  if (network->num_edges == network->edges_capacity) {
+    network->edges_capacity =
+        network->edges_capacity == 0 ? 8 : 2 * network->edges_capacity;
+    network->edges = realloc(network->edges,
+                             sizeof(spring_edge_t) * network->edges_capacity);
+    network->active = realloc(network->active,
+                              sizeof(spring_edge_t) * network->edges_capacity);
+    assert(network->edges != NULL && network->active != NULL);
+  }
+  network->edges[network->num_edges++] =
+      (spring_edge_t){network->member_ids[body1], network->member_ids[body2],
+                      k, rest_length, damping};
+  network->active[network->num_active++] =
+      (spring_edge_t){body1, body2, k, rest_length, damping};
+  network->num_synced = network->num_edges;
+}
+
+size_t spring_network_size(spring_network_t *network) {
+  spring_network_sync(network);
+  return network->num_active;
+}
+
+void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
+  scene_add_force_record(
+      scene, apply_spring_batch,
+      (force_record_t){.body1 = body1, .body2 = body2, .constants = {k}});
 }
 
 void create_drag(scene_t *scene, double gamma, body_t *body) {
-  // build force_aux_t
-  list_t *aux_bodies = list_init(1, (free_func_t)body_free);
-  list_add(aux_bodies, body);
-  list_t *consts = list_init(1, free);
-  double *gamma_ptr = malloc(sizeof(double));
-  *gamma_ptr = gamma;
-  list_add(consts, gamma_ptr);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
+  scene_add_force_record(scene, apply_drag_batch,
+                         (force_record_t){.body1 = body, .constants = {gamma}});
+}
 
-  // add force creator to the scene
-  list_t *scene_bodies = list_init(1, (free_func_t)body_free);
-  list_add(scene_bodies, body);
-  scene_add_bodies_force_creator(scene, apply_drag, aux, scene_bodies,
-                                 const_body_aux_free);
+typedef enum {
+  FIELD_ACCELERATION,
+  FIELD_DRAG,
+  FIELD_WIND,
+} field_kind_t;
+
+/**
+ * The state of a field force from create_uniform_gravity(),
+ * create_field_drag() or create_wind_field().
+ */
+typedef struct field_force {
+  scene_t *scene;
+  field_kind_t kind;
+  uint32_t categories;
+  // The acceleration of FIELD_ACCELERATION
+  vector_t acceleration;
+  // The linear (or wind) and quadratic coefficients of FIELD_DRAG and
+  // FIELD_WIND
+  double linear;
+  double quadratic;
+  vector_field_t wind;
+  void *aux;
+  free_func_t freer;
+} field_force_t;
+
+void field_force_free(void *aux) {
+  field_force_t *field = aux;
+  if (field->freer != NULL) {
+    field->freer(field->aux);
+  }
+  free(field);
+}
+
+/**
+ * Returns whether a field force acts on a body.
+ */
+bool field_selects(field_force_t *field, body_t *body) {
+  if (field->categories != 0 &&
+      (body_get_collision_category(body) & field->categories) == 0) {
+    return false;
+  }
+  return body_get_inverse_mass(body) != 0 && !body_is_sleeping(body);
+}
+
+void apply_field_force(void *aux) {
+  field_force_t *field = aux;
+  size_t num_bodies = scene_bodies(field->scene);
+  // Each kind gets its own loop, so the loops do not branch on the kind
+  switch (field->kind) {
+  case FIELD_ACCELERATION:
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_t *body = scene_get_body(field->scene, i);
+      if (field_selects(field, body)) {
+        body_add_force(body,
+                       vec_multiply(body_get_mass(body), field->acceleration));
+      }
+    }
+    break;
+  case FIELD_DRAG:
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_t *body = scene_get_body(field->scene, i);
+      if (field_selects(field, body)) {
+        vector_t velocity = body_get_velocity(body);
+        double coefficient =
+            field->linear + field->quadratic * vec_norm(velocity);
+        body_add_force(body, vec_multiply(-coefficient, velocity));
+      }
+    }
+    break;
+  case FIELD_WIND:
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_t *body = scene_get_body(field->scene, i);
+      if (field_selects(field, body)) {
+        vector_t wind = field->wind(body_get_centroid(body), field->aux);
+        vector_t relative = vec_subtract(wind, body_get_velocity(body));
+        body_add_force(body, vec_multiply(field->linear, relative));
+      }
+    }
+    break;
+  }
+}
+
+/**
+ * Adds a field force to a scene. It has no bodies, so removing bodies
+ * never removes it.
+ */
+void add_field_force(scene_t *scene, field_force_t field) {
+  field_force_t *aux = malloc(sizeof(field_force_t));
+  assert(aux != NULL);
+  *aux = field;
+  aux->scene = scene;
+  scene_add_bodies_force_creator(scene, apply_field_force, aux, NULL,
+                                 field_force_free);
+}
+
+void create_uniform_gravity(scene_t *scene, vector_t acceleration,
+                            uint32_t categories) {
+  add_field_force(scene, (field_force_t){.kind = FIELD_ACCELERATION,
+                                         .categories = categories,
+                                         .acceleration = acceleration});
+}
+
+void create_field_drag(scene_t *scene, double linear, double quadratic,
+                       uint32_t categories) {
+  assert(linear >= 0 && quadratic >= 0);
+  add_field_force(scene, (field_force_t){.kind = FIELD_DRAG,
+                                         .categories = categories,
+                                         .linear = linear,
+                                         .quadratic = quadratic});
+}
+
+void create_wind_field(scene_t *scene, vector_field_t wind, double gamma,
+                       void *aux, free_func_t freer, uint32_t categories) {
+  assert(gamma >= 0);
+  add_field_force(scene, (field_force_t){.kind = FIELD_WIND,
+                                         .categories = categories,
+                                         .linear = gamma,
+                                         .wind = wind,
+                                         .aux = aux,
+                                         .freer = freer});
 }
 
 void create_random_impulse(scene_t *scene, double probability,
                            double max_impulse, body_t *body) {
-  // build force_aux_t
-  list_t *aux_bodies = list_init(1, (free_func_t)body_free);
-  list_add(aux_bodies, body);
-  list_t *consts = list_init(2, free);
-  double *probability_ptr = malloc(sizeof(double));
-  *probability_ptr = probability;
-  list_add(consts, probability_ptr);
-  double *max_impulse_ptr = malloc(sizeof(double));
-  *max_impulse_ptr = max_impulse;
-  list_add(consts, max_impulse_ptr);
-  const_body_aux_t *aux = const_body_aux_init(consts, aux_bodies);
-
-  // add force creator to the scene
-  list_t *scene_bodies = list_init(1, (free_func_t)body_free);
-  list_add(scene_bodies, body);
-  scene_add_bodies_force_creator(scene, apply_random_impulse, aux, scene_bodies,
-                                 const_body_aux_free);
+  scene_add_force_record(
+      scene, apply_random_impulse_batch,
+      (force_record_t){.body1 = body, .constants = {probability, max_impulse}});
 }
 
 void create_collision(scene_t *scene, body_t *body1, body_t *body2,
@@ -315,8 +962,12 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
   force_aux_t *force_aux = force_aux_init(handler, aux, freer);
 
   // do aux_bodies and force_aux->bodies need to be diff lists??????
-  scene_add_bodies_force_creator(scene, (force_creator_t)collision, force_aux,
-                                 aux_bodies, force_aux_free);
+  scene_add_contact_force_creator(scene, (force_creator_t)collision,
+                                  collision_separated, force_aux, aux_bodies,
+                                  force_aux_free);
+  // Lets a restored snapshot remember whether the bodies were touching
+  scene_add_force_state(scene, force_aux, &force_aux->already_colliding,
+                        sizeof(bool));
 }
 
 void create_destructive_collision(scene_t *scene, body_t *body1,
@@ -95,3 +95,24 @@ void list_add(list_t *list, void *value) {
   list->objects[list->size] = value;
   ++list->size;
 }
+
+void list_sort(list_t *list, int (*compare)(const void *, const void *)) {
+  qsort(list->objects, list->size, sizeof(void *), compare);
+}
+
+size_t list_filter(list_t *list, list_keep_func_t keep, void *aux) {
+  // Slide each kept element down over the rejected ones before it
+  size_t kept = 0;
+  for (size_t i = 0; i < list->size; ++i) {
+    void *object = list->objects[i];
+    if (keep(object, aux)) {
+      list->objects[kept] = object;
+      ++kept;
+    } else if (list->freer != NULL) {
+      list->freer(object);
+    }
+  }
+  size_t removed = list->size - kept;
+  list->size = kept;
+  return removed;
+}
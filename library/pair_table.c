@@ -0,0 +1,181 @@
+#include "pair_table.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The smallest number of slots a table is created with. Must be a power of 2.
+ */
+const size_t PAIR_TABLE_MIN_SLOTS = 8;
+
+/**
+ * A slot in the table's open-addressed array.
+ * The slot is empty iff first is NULL.
+ * The pair is always stored with first < second (by address).
+ */
+typedef struct pair_slot {
+  const void *first;
+  const void *second;
+  void *value;
+} pair_slot_t;
+
+struct pair_table {
+  pair_slot_t *slots;
+  // Always a power of 2, and at least twice size
+  size_t num_slots;
+  size_t size;
+  free_func_t freer;
+};
+
+/**
+ * Orders the two keys of a pair so (a, b) and (b, a) are stored identically.
+ */
+void pair_table_order(const void **first, const void **second) {
+  if ((uintptr_t)*first > (uintptr_t)*second) {
+    const void *temp = *first;
+    *first = *second;
+    *second = temp;
+  }
+}
+
+/**
+ * Hashes an ordered pair of pointers into a slot index.
+ */
+size_t pair_table_hash(pair_table_t *table, const void *first,
+                       const void *second) {
+  uint64_t hash = (uint64_t)(uintptr_t)first * 0x9E3779B97F4A7C15ull;
+  hash ^= (uint64_t)(uintptr_t)second + 0x7F4A7C159E3779B9ull + (hash << 6) +
+          (hash >> 2);
+  // Mix the high bits down so the low bits used for indexing are well spread
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return (size_t)hash & (table->num_slots - 1);
+}
+
+/**
+ * Finds the slot holding a pair, or the empty slot where it would be inserted.
+ */
+size_t pair_table_find(pair_table_t *table, const void *first,
+                       const void *second) {
+  size_t index = pair_table_hash(table, first, second);
+  while (table->slots[index].first != NULL &&
+         (table->slots[index].first != first ||
+          table->slots[index].second != second)) {
+    index = (index + 1) & (table->num_slots - 1);
+  }
+  return index;
+}
+
+pair_table_t *pair_table_init(size_t initial_size, free_func_t freer) {
+  size_t num_slots = PAIR_TABLE_MIN_SLOTS;
+  while (num_slots < 2 * initial_size) {
+    num_slots *= 2;
+  }
+
+  pair_table_t *table = malloc(sizeof(pair_table_t));
+  assert(table != NULL);
+  table->slots = calloc(num_slots, sizeof(pair_slot_t));
+  assert(table->slots != NULL);
+  table->num_slots = num_slots;
+  table->size = 0;
+  table->freer = freer;
+  return table;
+}
+
+void pair_table_free(pair_table_t *table) {
+  if (table->freer != NULL) {
+    for (size_t i = 0; i < table->num_slots; ++i) {
+      if (table->slots[i].first != NULL) {
+        table->freer(table->slots[i].value);
+      }
+    }
+  }
+  free(table->slots);
+  free(table);
+}
+
+size_t pair_table_size(pair_table_t *table) { return table->size; }
+
+void *pair_table_get(pair_table_t *table, const void *first,
+                     const void *second) {
+  pair_table_order(&first, &second);
+  return table->slots[pair_table_find(table, first, second)].value;
+}
+
+/**
+ * Doubles the number of slots in a table and reinserts every pair.
+ */
+void pair_table_grow(pair_table_t *table) {
+  pair_slot_t *old_slots = table->slots;
+  size_t old_num_slots = table->num_slots;
+
+  table->num_slots *= 2;
+  table->slots = calloc(table->num_slots, sizeof(pair_slot_t));
+  assert(table->slots != NULL);
+  for (size_t i = 0; i < old_num_slots; ++i) {
+    if (old_slots[i].first != NULL) {
+      size_t index =
+          pair_table_find(table, old_slots[i].first, old_slots[i].second);
+      table->slots[index] = old_slots[i];
+    }
+  }
+  free(old_slots);
+}
+
+void pair_table_put(pair_table_t *table, const void *first, const void *second,
+                    void *value) {
+  assert(first != NULL);
+  assert(second != NULL);
+  assert(value != NULL);
+
+  pair_table_order(&first, &second);
+  size_t index = pair_table_find(table, first, second);
+  if (table->slots[index].first != NULL) {
+    table->slots[index].value = value;
+    return;
+  }
+
+  // Keep the table at most half full so probe sequences stay short
+  if (2 * (table->size + 1) > table->num_slots) {
+    pair_table_grow(table);
+    index = pair_table_find(table, first, second);
+  }
+  table->slots[index] = (pair_slot_t){first, second, value};
+  ++table->size;
+}
+
+void *pair_table_remove(pair_table_t *table, const void *first,
+                        const void *second) {
+  pair_table_order(&first, &second);
+  size_t index = pair_table_find(table, first, second);
+  if (table->slots[index].first == NULL) {
+    return NULL;
+  }
+  void *removed = table->slots[index].value;
+
+  // Shift later entries of the probe sequence back into the hole,
+  // so lookups never need tombstones
+  size_t mask = table->num_slots - 1;
+  size_t hole = index;
+  size_t next = (hole + 1) & mask;
+  while (table->slots[next].first != NULL) {
+    size_t home = pair_table_hash(table, table->slots[next].first,
+                                  table->slots[next].second);
+    // The entry may move into the hole only if its home slot does not lie
+    // cyclically in (hole, next]
+    bool home_in_range = (hole <= next) ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+    if (!home_in_range) {
+      table->slots[hole] = table->slots[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  table->slots[hole] = (pair_slot_t){NULL, NULL, NULL};
+  --table->size;
+
+  return removed;
+}
@@ -3,48 +3,120 @@
 #include "list.h"
 #include "vector.h"
 
+#include <assert.h>
 #include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
-double polygon_area(list_t *polygon) {
+/**
+ * The factor by which a polygon's capacity increases when it is full.
+ */
+const size_t POLYGON_GROW_FACTOR = 2;
+
+struct polygon {
+  vector_t *vertices;
+  size_t size;
+  size_t capacity;
+};
+
+polygon_t *polygon_init(size_t initial_size) {
+  polygon_t *polygon = malloc(sizeof(polygon_t));
+  assert(polygon != NULL);
+  polygon->vertices = malloc(sizeof(vector_t) * initial_size);
+  polygon->size = 0;
+  polygon->capacity = initial_size;
+  return polygon;
+}
+
+polygon_t *polygon_from_list(list_t *vertices) {
+  size_t size = list_size(vertices);
+  polygon_t *polygon = polygon_init(size);
+  for (size_t i = 0; i < size; ++i) {
+    polygon->vertices[i] = *(vector_t *)list_get(vertices, i);
+  }
+  polygon->size = size;
+  return polygon;
+}
+
+list_t *polygon_to_list(polygon_t *polygon) {
+  list_t *vertices = list_init(polygon->size, free);
+  for (size_t i = 0; i < polygon->size; ++i) {
+    vector_t *vertex = malloc(sizeof(vector_t));
+    *vertex = polygon->vertices[i];
+    list_add(vertices, vertex);
+  }
+  return vertices;
+}
+
+polygon_t *polygon_copy(polygon_t *polygon) {
+  polygon_t *copy = polygon_init(polygon->size);
+  memcpy(copy->vertices, polygon->vertices, sizeof(vector_t) * polygon->size);
+  copy->size = polygon->size;
+  return copy;
+}
+
+void polygon_free(polygon_t *polygon) {
+  free(polygon->vertices);
+  free(polygon);
+}
+
+size_t polygon_size(polygon_t *polygon) { return polygon->size; }
+
+vector_t *polygon_vertices(polygon_t *polygon) { return polygon->vertices; }
+
+polygon_view_t polygon_view(polygon_t *polygon) {
+  return (polygon_view_t){polygon->vertices, polygon->size};
+}
+
+vector_t polygon_get(polygon_t *polygon, size_t index) {
+  assert(index < polygon->size);
+
+  return polygon->vertices[index];
+}
+
+void polygon_add(polygon_t *polygon, vector_t vertex) {
+  if (polygon->size == polygon->capacity) {
+    size_t new_capacity = POLYGON_GROW_FACTOR * polygon->capacity;
+    if (new_capacity == polygon->capacity) {
+      new_capacity += 1;
+    }
+    polygon->vertices =
+        realloc(polygon->vertices, sizeof(vector_t) * new_capacity);
+    assert(polygon->vertices != NULL);
+    polygon->capacity = new_capacity;
+  }
+
+  polygon->vertices[polygon->size] = vertex;
+  ++polygon->size;
+}
+
+double vertices_area(const vector_t *vertices, size_t size) {
   double det_sum = 0.0;
-  size_t size = list_size(polygon);
 
   // Add determinants in the shoelace formula to det_sum
   for (size_t i = 0; i < size; ++i) {
-    size_t j = (i + 1) % size;
-    det_sum += (((vector_t *)list_get(polygon, i))->x -
-                ((vector_t *)list_get(polygon, j))->x) *
-               (((vector_t *)list_get(polygon, i))->y +
-                ((vector_t *)list_get(polygon, j))->y);
+    vector_t v1 = vertices[i];
+    vector_t v2 = vertices[(i + 1) % size];
+    det_sum += (v1.x - v2.x) * (v1.y + v2.y);
   }
 
   return det_sum * 0.5;
 }
 
-vector_t polygon_centroid(list_t *polygon) {
-  double area = polygon_area(polygon);
+vector_t vertices_centroid(const vector_t *vertices, size_t size) {
+  double area = vertices_area(vertices, size);
   double centroid_x = 0.0;
   double centroid_y = 0.0;
-  size_t size = list_size(polygon);
 
   // Compute the x and y coordinates of the centroid (delaying division by 6 *
   // area)
   for (size_t i = 0; i < size; ++i) {
-    size_t j = (i + 1) % size;
-    centroid_x += (((vector_t *)list_get(polygon, i))->x +
-                   ((vector_t *)list_get(polygon, j))->x) *
-                  (((vector_t *)list_get(polygon, i))->x *
-                       ((vector_t *)list_get(polygon, j))->y -
-                   ((vector_t *)list_get(polygon, j))->x *
-                       ((vector_t *)list_get(polygon, i))->y);
-    centroid_y += (((vector_t *)list_get(polygon, i))->y +
-                   ((vector_t *)list_get(polygon, j))->y) *
-                  (((vector_t *)list_get(polygon, i))->x *
-                       ((vector_t *)list_get(polygon, j))->y -
-                   ((vector_t *)list_get(polygon, j))->x *
-                       ((vector_t *)list_get(polygon, i))->y);
+    vector_t v1 = vertices[i];
+    vector_t v2 = vertices[(i + 1) % size];
+    double cross = v1.x * v2.y - v2.x * v1.y;
+    centroid_x += (v1.x + v2.x) * cross;
+    centroid_y += (v1.y + v2.y) * cross;
   }
   centroid_x /= 6 * area;
   centroid_y /= 6 * area;
@@ -52,34 +124,40 @@ vector_t polygon_centroid(list_t *polygon) {
   return (vector_t){centroid_x, centroid_y};
 }
 
-void polygon_translate(list_t *polygon, vector_t translation) {
-  size_t size = list_size(polygon);
-
+void vertices_translate(vector_t *vertices, size_t size, vector_t translation) {
   // Apply translation to each vertex
   for (size_t i = 0; i < size; ++i) {
-    ((vector_t *)list_get(polygon, i))->x += translation.x;
-    ((vector_t *)list_get(polygon, i))->y += translation.y;
+    vertices[i].x += translation.x;
+    vertices[i].y += translation.y;
   }
 }
 
-void polygon_rotate(list_t *polygon, double angle, vector_t point) {
-  size_t size = list_size(polygon);
+void vertices_rotate(vector_t *vertices, size_t size, double angle,
+                     vector_t point) {
+  double cos_angle = cos(angle);
+  double sin_angle = sin(angle);
 
   for (size_t i = 0; i < size; ++i) {
-    double x = ((vector_t *)list_get(polygon, i))->x;
-    double y = ((vector_t *)list_get(polygon, i))->y;
-
     // Translate to point and rotate
-    vector_t temp_vec = {.x = x - point.x, .y = y - point.y};
-    temp_vec = vec_rotate(temp_vec, angle);
+    double x = vertices[i].x - point.x;
+    double y = vertices[i].y - point.y;
 
     // Translate back and store
-    ((vector_t *)list_get(polygon, i))->x = temp_vec.x + point.x;
-    ((vector_t *)list_get(polygon, i))->y = temp_vec.y + point.y;
+    vertices[i].x = x * cos_angle - y * sin_angle + point.x;
+    vertices[i].y = x * sin_angle + y * cos_angle + point.y;
   }
 }
 
-range_t polygon_proj(list_t *polygon, vector_t axis, bool normalize) {
+void vertices_edge_normals(const vector_t *vertices, size_t size,
+                           vector_t *normals) {
+  for (size_t i = 0; i < size; ++i) {
+    vector_t edge = vec_subtract(vertices[(i + 1) % size], vertices[i]);
+    normals[i] = vec_normalize(vec_rotate_90(edge, true));
+  }
+}
+
+range_t vertices_proj(const vector_t *vertices, size_t size, vector_t axis,
+                      bool normalize) {
   if (axis.x == 0 && axis.y == 0) {
     return (range_t){0, 0};
   }
@@ -87,10 +165,8 @@ range_t polygon_proj(list_t *polygon, vector_t axis, bool normalize) {
   range_t proj_range = {INFINITY, -INFINITY};
   vector_t axis_normalized = normalize ? vec_normalize(axis) : axis;
 
-  size_t size = list_size(polygon);
   for (size_t i = 0; i < size; ++i) {
-    vector_t vert = *(vector_t *)list_get(polygon, i);
-    double vert_proj = vec_scalar_proj(axis_normalized, vert, false);
+    double vert_proj = vec_dot(vertices[i], axis_normalized);
     if (vert_proj < proj_range.min) {
       proj_range.min = vert_proj;
     }
@@ -99,4 +175,88 @@ range_t polygon_proj(list_t *polygon, vector_t axis, bool normalize) {
     }
   }
   return proj_range;
-}
\ No newline at end of file
+}
+
+aabb_t vertices_bounds(const vector_t *vertices, size_t size) {
+  aabb_t bounds = {{INFINITY, INFINITY}, {-INFINITY, -INFINITY}};
+  for (size_t i = 0; i < size; ++i) {
+    bounds.min.x = fmin(bounds.min.x, vertices[i].x);
+    bounds.min.y = fmin(bounds.min.y, vertices[i].y);
+    bounds.max.x = fmax(bounds.max.x, vertices[i].x);
+    bounds.max.y = fmax(bounds.max.y, vertices[i].y);
+  }
+  return bounds;
+}
+
+bool aabb_overlap(aabb_t box1, aabb_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+bool aabb_segment_overlap(aabb_t box, vector_t start, vector_t end) {
+  // Clip the segment's parameter range [0, 1] against each pair of slabs
+  double t_min = 0, t_max = 1;
+  double starts[2] = {start.x, start.y};
+  double deltas[2] = {end.x - start.x, end.y - start.y};
+  double mins[2] = {box.min.x, box.min.y};
+  double maxes[2] = {box.max.x, box.max.y};
+  for (size_t axis = 0; axis < 2; axis++) {
+    if (deltas[axis] == 0) {
+      if (starts[axis] < mins[axis] || starts[axis] > maxes[axis]) {
+        return false;
+      }
+      continue;
+    }
+    double t1 = (mins[axis] - starts[axis]) / deltas[axis];
+    double t2 = (maxes[axis] - starts[axis]) / deltas[axis];
+    t_min = fmax(t_min, fmin(t1, t2));
+    t_max = fmin(t_max, fmax(t1, t2));
+    if (t_min > t_max) {
+      return false;
+    }
+  }
+  return true;
+}
+
+double polygon_area(list_t *polygon) {
+  polygon_t *vertices = polygon_from_list(polygon);
+  double area = vertices_area(vertices->vertices, vertices->size);
+  polygon_free(vertices);
+  return area;
+}
+
+vector_t polygon_centroid(list_t *polygon) {
+  polygon_t *vertices = polygon_from_list(polygon);
+  vector_t centroid = vertices_centroid(vertices->vertices, vertices->size);
+  polygon_free(vertices);
+  return centroid;
+}
+
+void polygon_translate(list_t *polygon, vector_t translation) {
+  size_t size = list_size(polygon);
+
+  // The list's vertices are separate allocations, so update them in place
+  for (size_t i = 0; i < size; ++i) {
+    vector_t *vertex = list_get(polygon, i);
+    vertices_translate(vertex, 1, translation);
+  }
+}
+
+void polygon_rotate(list_t *polygon, double angle, vector_t point) {
+  polygon_t *vertices = polygon_from_list(polygon);
+  vertices_rotate(vertices->vertices, vertices->size, angle, point);
+
+  // Copy the rotated vertices back into the list
+  for (size_t i = 0; i < vertices->size; ++i) {
+    *(vector_t *)list_get(polygon, i) = vertices->vertices[i];
+  }
+  polygon_free(vertices);
+}
+
+range_t polygon_proj(list_t *polygon, vector_t axis, bool normalize) {
+  polygon_t *vertices = polygon_from_list(polygon);
+  range_t proj_range =
+      vertices_proj(vertices->vertices, vertices->size, axis, normalize);
+  polygon_free(vertices);
+  return proj_range;
+}
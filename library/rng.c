@@ -0,0 +1,83 @@
+#include "rng.h"
+
+#include <assert.h>
+
+/**
+ * The multipliers and key increments of Philox4x32, from
+ * Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (2011).
+ */
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+/**
+ * The number of rounds. 10 is the smallest number the paper recommends.
+ */
+const size_t PHILOX_ROUNDS = 10;
+
+/**
+ * Scales the top 53 bits of a random number into [0, 1).
+ */
+const double RNG_DOUBLE_SCALE = 1.0 / 9007199254740992.0;
+
+/**
+ * Runs Philox4x32-10 on a 128-bit counter with a 64-bit key,
+ * replacing the counter with the random output.
+ */
+void philox4x32(uint32_t ctr[4], uint32_t key[2]) {
+  uint32_t k0 = key[0];
+  uint32_t k1 = key[1];
+  for (size_t round = 0; round < PHILOX_ROUNDS; round++) {
+    uint64_t product0 = (uint64_t)PHILOX_M0 * ctr[0];
+    uint64_t product1 = (uint64_t)PHILOX_M1 * ctr[2];
+    uint32_t hi0 = (uint32_t)(product0 >> 32);
+    uint32_t hi1 = (uint32_t)(product1 >> 32);
+    ctr[0] = hi1 ^ ctr[1] ^ k0;
+    ctr[1] = (uint32_t)product1;
+    ctr[2] = hi0 ^ ctr[3] ^ k1;
+    ctr[3] = (uint32_t)product0;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+}
+
+uint64_t rng_bits(uint64_t seed, uint64_t stream, uint64_t counter) {
+  uint32_t ctr[4] = {(uint32_t)counter, (uint32_t)(counter >> 32),
+                     (uint32_t)stream, (uint32_t)(stream >> 32)};
+  uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+  philox4x32(ctr, key);
+  return ((uint64_t)ctr[1] << 32) | ctr[0];
+}
+
+double rng_uniform(uint64_t seed, uint64_t stream, uint64_t counter) {
+  return (rng_bits(seed, stream, counter) >> 11) * RNG_DOUBLE_SCALE;
+}
+
+rng_t rng_init(uint64_t seed, uint64_t stream) {
+  return (rng_t){seed, stream, 0};
+}
+
+uint64_t rng_next(rng_t *rng) {
+  return rng_bits(rng->seed, rng->stream, rng->counter++);
+}
+
+double rng_next_double(rng_t *rng) {
+  return rng_uniform(rng->seed, rng->stream, rng->counter++);
+}
+
+double rng_next_range(rng_t *rng, double min, double max) {
+  assert(min <= max);
+  return min + (max - min) * rng_next_double(rng);
+}
+
+size_t rng_next_index(rng_t *rng, size_t n) {
+  assert(n > 0);
+  // Rejects the top sliver of values so every index is equally likely
+  uint64_t limit = UINT64_MAX - UINT64_MAX % n;
+  uint64_t bits;
+  do {
+    bits = rng_next(rng);
+  } while (bits >= limit);
+  return (size_t)(bits % n);
+}
@@ -1,25 +1,259 @@
 #include "scene.h"
+#include "aabb_tree.h"
+#include "collision.h"
 #include "list.h"
+#include "pair_table.h"
+#include "slot_map.h"
+#include "spatial_grid.h"
+#include "thread_pool.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 const size_t INIT_BODY_CAPACITY = 8;
 const size_t INIT_FORCE_CAPACITY = 8;
+// The most forces or bodies handed to a thread at once in a parallel tick
+const size_t PARALLEL_FORCE_GRAIN = 16;
+const size_t PARALLEL_BODY_GRAIN = 1024;
+const size_t PARALLEL_COLLISION_GRAIN = 64;
+// The number of collision categories, one per bit of a body's category
+#define COLLISION_CATEGORIES 32
+
+typedef struct force force_t;
+typedef struct record_ref record_ref_t;
+
+/**
+ * A handler registered with scene_add_collision_handler() (handler is set)
+ * or scene_add_collision_event_handler() (event_handler is set).
+ */
+typedef struct collision_rule {
+  uint32_t category1;
+  uint32_t category2;
+  // The collision_event_t bits the handler is called for
+  uint32_t events;
+  collision_handler_t handler;
+  collision_event_handler_t event_handler;
+  void *aux;
+  free_func_t freer;
+} collision_rule_t;
+
+/**
+ * The contact state of a pair of bodies whose bounding boxes overlap,
+ * kept only while they keep overlapping.
+ */
+typedef struct collision_pair {
+  body_t *body1;
+  body_t *body2;
+  bool touching;
+  // The axis of the last collision, reported when the contact ends
+  vector_t axis;
+  separating_axis_cache_t axis_cache;
+  // The last tick the pair was a candidate for collision
+  size_t last_tick;
+} collision_pair_t;
+
+/**
+ * A contact event waiting to be dispatched to the collision handlers.
+ */
+typedef struct collision_record {
+  body_t *body1;
+  body_t *body2;
+  collision_event_t event;
+  vector_t axis;
+} collision_record_t;
+
+/**
+ * The records of one kind of built-in force, see scene_add_force_record().
+ */
+typedef struct force_batch {
+  force_kernel_t kernel;
+  force_record_t *records;
+  // Each record's entry in its bodies' lists in body_records, in the same
+  // order as records
+  record_ref_t **refs;
+  size_t num_records;
+  size_t capacity;
+} force_batch_t;
+
+/**
+ * Where a force record is, kept up to date as records move within their
+ * batch so a body's records can be found without scanning the batches.
+ */
+struct record_ref {
+  force_batch_t *batch;
+  size_t index;
+};
 
 struct scene {
   list_t *bodies;
+  // Maps handles to bodies. handles holds each body's handle, in the same
+  // order as bodies, so reaping a body can free its slot.
+  slot_map_t *slots;
+  body_handle_t *handles;
+  size_t handles_capacity;
   list_t *forces;
+  // Maps each pair of bodies to the list of contact forces between them
+  pair_table_t *contact_forces;
+  // Maps each body to the list of forces that act on it. A single body is
+  // stored as the pair (body, body).
+  pair_table_t *body_forces;
+  // The records of built-in forces, one batch per kernel, in the order the
+  // kernels were first used
+  list_t *force_batches;
+  // Maps each body to the list of record_ref_t of the force records it is
+  // in, so removing a body only has to look at its own records and sleeping
+  // can find islands. Stored like body_forces.
+  pair_table_t *body_records;
+  // The broad phase: at most one of grid and tree is non-NULL.
+  // If both are NULL, every contact force runs every tick.
+  spatial_grid_t *grid;
+  aabb_tree_t *tree;
+  // The tree's proxy id for each body, in the same order as bodies
+  list_t *proxies;
+  // Contact forces run by the broad phase on the last tick
+  list_t *active_contacts;
+  // Handlers registered with scene_add_collision_handler(), in order.
+  // collision_partners[i] holds the categories some handler pairs with
+  // category bit i, so most pairs are rejected without scanning the rules.
+  list_t *collision_rules;
+  uint32_t collision_partners[COLLISION_CATEGORIES];
+  // The contact state of each candidate pair, in collision_pair_list and
+  // indexed by its bodies in collision_pairs
+  pair_table_t *collision_pairs;
+  list_t *collision_pair_list;
+  // The events found this tick, dispatched once every pair is tested.
+  // collision_events holds every kind of event some handler asks for.
+  collision_record_t *collision_records;
+  size_t num_collision_records;
+  size_t collision_records_capacity;
+  uint32_t collision_events;
+  // If non-NULL, every body's state is kept here and ticked in one batch
+  body_store_t *store;
+  // If non-NULL, forces and bodies are ticked on these threads.
+  // schedule holds the forces run each tick, grouped into batches ending
+  // at batch_ends, where no two forces in a batch share a body.
+  thread_pool_t *pool;
+  force_t **schedule;
+  size_t *batch_ends;
+  size_t num_batches;
+  bool schedule_dirty;
+  // The fixed step scene_advance() ticks by, or 0 to tick by the frame time.
+  // accumulator holds the time not yet simulated.
+  double fixed_step;
+  size_t max_substeps;
+  double accumulator;
+  // Bodies slower than sleep_speed for sleep_delay seconds fall asleep
+  bool sleeping_enabled;
+  double sleep_speed;
+  double sleep_delay;
+  size_t tick;
+  // The dt of the current or last tick
+  double tick_dt;
+  size_t forces_added;
+  // Seeds random forces, see scene_set_seed()
+  uint64_t seed;
+  // The number of force records added, used to give each its own stream
+  uint64_t records_added;
+  // The snapshots of this scene, see scene_snapshot_init()
+  list_t *snapshots;
+  // The number of snapshots taken; each snapshot remembers its number
+  uint64_t epoch;
+  // Removed bodies and forces that a snapshot may still restore,
+  // in the order they were removed
+  list_t *retained;
+};
+
+/**
+ * A removed body or force kept alive for scene_restore(), and the epoch
+ * it was removed in. Only snapshots taken in or before that epoch can
+ * refer to it.
+ */
+typedef struct retained {
+  body_t *body;
+  force_t *force;
+  uint64_t epoch;
+} retained_t;
+
+struct scene_snapshot {
+  // The scene the snapshot was made for, or NULL once the scene is freed
+  scene_t *scene;
+  // The scene's epoch when the snapshot was last taken, or 0 if never taken
+  uint64_t epoch;
+  size_t tick;
+  double tick_dt;
+  double accumulator;
+  size_t forces_added;
+  uint64_t records_added;
+
+  // The scene's bodies, in order, with each one's handle and state
+  body_t **bodies;
+  body_handle_t *handles;
+  body_state_t *body_states;
+  size_t num_bodies;
+  size_t bodies_capacity;
+  // A copy of the scene's handles, so restored bodies get theirs back
+  slot_map_t *slots;
+
+  // The scene's forces, in order, with each one's last_tick and, for group
+  // forces, the number of bodies in the group
+  force_t **forces;
+  size_t *last_ticks;
+  size_t *group_sizes;
+  size_t num_forces;
+  size_t forces_capacity;
+  // The bodies of every group force, one group after another
+  body_t **group_bodies;
+  size_t group_bodies_capacity;
+  // The states from scene_add_force_state(), one after another
+  char *force_states;
+  size_t force_states_size;
+  size_t force_states_capacity;
+
+  // The records of every force batch, one batch after another, and the
+  // number of records in each batch
+  force_record_t *records;
+  size_t records_capacity;
+  size_t *batch_sizes;
+  size_t num_batches;
+  size_t batches_capacity;
+
+  force_t **active_contacts;
+  size_t num_active_contacts;
+  size_t active_contacts_capacity;
+
+  collision_pair_t *collision_pairs;
+  size_t num_collision_pairs;
+  size_t collision_pairs_capacity;
 };
 
-typedef struct force {
+struct force {
   force_creator_t forcer;
   void *aux;
   list_t *bodies;
   free_func_t freer;
   bool mark_removal;
-} force_t;
+  // Only set for contact forces, see scene_add_contact_force_creator()
+  bool is_contact;
+  force_creator_t separator;
+  // The order the force was added in, so batches can run in that order
+  size_t index;
+  // The last tick the broad phase ran this force on
+  size_t last_tick;
+  // Whether the force may run at the same time as forces on other bodies,
+  // see scene_add_parallel_force_creator()
+  bool thread_safe;
+  // Only set for group forces, see scene_add_group_force_creator()
+  bool is_group;
+  // Whether a group force has removed bodies to drop at the end of the tick
+  bool prune_bodies;
+  // Part of aux saved by snapshots, see scene_add_force_state()
+  void *state;
+  size_t state_size;
+};
 
 void force_free(force_t *force) {
   if (force->freer != NULL) {
@@ -34,28 +268,311 @@ void force_free(force_t *force) {
   free(force);
 }
 
+void retained_free(retained_t *retained) {
+  if (retained->body != NULL) {
+    body_free(retained->body);
+  } else {
+    force_free(retained->force);
+  }
+  free(retained);
+}
+
+/**
+ * Finds the epoch of the oldest snapshot taken of a scene.
+ *
+ * @return the epoch, or UINT64_MAX if no snapshot has been taken
+ */
+uint64_t scene_oldest_snapshot(scene_t *scene) {
+  uint64_t oldest = UINT64_MAX;
+  size_t num_snapshots = list_size(scene->snapshots);
+  for (size_t i = 0; i < num_snapshots; i++) {
+    scene_snapshot_t *snapshot = list_get(scene->snapshots, i);
+    if (snapshot->epoch != 0 && snapshot->epoch < oldest) {
+      oldest = snapshot->epoch;
+    }
+  }
+  return oldest;
+}
+
+/**
+ * Keeps a removed body or force alive while some snapshot may restore it.
+ * Exactly one of body and force is non-NULL.
+ */
+void scene_retain(scene_t *scene, body_t *body, force_t *force) {
+  retained_t *retained = malloc(sizeof(retained_t));
+  assert(retained != NULL);
+  *retained = (retained_t){body, force, scene->epoch};
+  list_add(scene->retained, retained);
+}
+
+/**
+ * Frees a body that has left the scene, unless a snapshot may restore it.
+ */
+void scene_release_body(scene_t *scene, body_t *body) {
+  if (scene_oldest_snapshot(scene) == UINT64_MAX) {
+    body_free(body);
+    return;
+  }
+  // A retained body is not ticked, so it leaves the store until restored
+  if (scene->store != NULL) {
+    body_store_detach(body);
+  }
+  scene_retain(scene, body, NULL);
+}
+
+/**
+ * Frees a force that has left the scene, unless a snapshot may restore it.
+ */
+void scene_release_force(scene_t *scene, force_t *force) {
+  if (scene_oldest_snapshot(scene) == UINT64_MAX) {
+    force_free(force);
+    return;
+  }
+  scene_retain(scene, NULL, force);
+}
+
+bool scene_keep_retained(void *retained, void *oldest) {
+  retained_t *entry = retained;
+  if (entry->epoch >= *(uint64_t *)oldest) {
+    return true;
+  }
+  retained_free(entry);
+  return false;
+}
+
+/**
+ * Passed to list_filter() on a scene's retained bodies and forces.
+ * Frees the forces, keeping the bodies.
+ */
+bool scene_keep_retained_body(void *retained, void *aux) {
+  retained_t *entry = retained;
+  if (entry->body != NULL) {
+    return true;
+  }
+  retained_free(entry);
+  return false;
+}
+
+/**
+ * Frees the retained bodies and forces that no snapshot can restore,
+ * i.e. those removed before the oldest snapshot was taken.
+ */
+void scene_collect_retained(scene_t *scene) {
+  uint64_t oldest = scene_oldest_snapshot(scene);
+  list_filter(scene->retained, scene_keep_retained, &oldest);
+}
+
+void force_batch_free(force_batch_t *batch) {
+  for (size_t i = 0; i < batch->num_records; i++) {
+    free(batch->refs[i]);
+  }
+  free(batch->refs);
+  free(batch->records);
+  free(batch);
+}
+
+void collision_rule_free(collision_rule_t *rule) {
+  if (rule->freer != NULL) {
+    rule->freer(rule->aux);
+  }
+  free(rule);
+}
+
 // used to mark forces for removal in scene_tick
 void force_remove(force_t *force) { force->mark_removal = true; }
 
 // returns true if a force is marked for removal
 bool force_is_removed(force_t *force) { return force->mark_removal; }
 
+// returns true if a body is not moving and will not move by itself
+bool body_is_idle(body_t *body) {
+  return body_is_sleeping(body) || body_get_kind(body) == BODY_STATIC;
+}
+
+// returns true if a force has bodies and they are all asleep or static,
+// so running it can be skipped
+bool force_is_idle(force_t *force) {
+  size_t num_bodies = list_size(force->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    if (!body_is_idle(list_get(force->bodies, i))) {
+      return false;
+    }
+  }
+  return num_bodies != 0;
+}
+
 scene_t *scene_init() {
-  list_t *bodies = list_init(INIT_BODY_CAPACITY, (free_func_t)body_free);
-  list_t *forces = list_init(INIT_FORCE_CAPACITY, (free_func_t)force_free);
+  // Removed bodies and forces are freed by scene_release_body() and
+  // scene_release_force(), since a snapshot may keep them alive
+  list_t *bodies = list_init(INIT_BODY_CAPACITY, NULL);
+  list_t *forces = list_init(INIT_FORCE_CAPACITY, NULL);
 
   scene_t *scene = malloc(sizeof(scene_t));
   scene->bodies = bodies;
   scene->forces = forces;
+  scene->slots = slot_map_init(INIT_BODY_CAPACITY);
+  scene->handles = malloc(sizeof(body_handle_t) * INIT_BODY_CAPACITY);
+  assert(scene->handles != NULL);
+  scene->handles_capacity = INIT_BODY_CAPACITY;
+  scene->contact_forces =
+      pair_table_init(INIT_FORCE_CAPACITY, (free_func_t)list_free);
+  scene->body_forces =
+      pair_table_init(INIT_BODY_CAPACITY, (free_func_t)list_free);
+  scene->force_batches = list_init(1, (free_func_t)force_batch_free);
+  scene->body_records =
+      pair_table_init(INIT_BODY_CAPACITY, (free_func_t)list_free);
+  scene->grid = NULL;
+  scene->tree = NULL;
+  scene->proxies = NULL;
+  scene->active_contacts = list_init(INIT_FORCE_CAPACITY, NULL);
+  scene->collision_rules = list_init(1, (free_func_t)collision_rule_free);
+  for (size_t i = 0; i < COLLISION_CATEGORIES; i++) {
+    scene->collision_partners[i] = 0;
+  }
+  scene->collision_pairs = pair_table_init(INIT_BODY_CAPACITY, NULL);
+  scene->collision_pair_list = list_init(INIT_BODY_CAPACITY, free);
+  scene->collision_records = NULL;
+  scene->num_collision_records = 0;
+  scene->collision_records_capacity = 0;
+  scene->collision_events = 0;
+  scene->store = NULL;
+  scene->pool = NULL;
+  scene->schedule = NULL;
+  scene->batch_ends = NULL;
+  scene->num_batches = 0;
+  scene->schedule_dirty = true;
+  scene->fixed_step = 0;
+  scene->max_substeps = 0;
+  scene->accumulator = 0;
+  scene->sleeping_enabled = false;
+  scene->sleep_speed = 0;
+  scene->sleep_delay = 0;
+  scene->tick = 0;
+  scene->tick_dt = 0;
+  scene->forces_added = 0;
+  scene->seed = 0;
+  scene->records_added = 0;
+  scene->snapshots = list_init(1, NULL);
+  scene->epoch = 0;
+  scene->retained = list_init(1, NULL);
   return scene;
 }
 
 void scene_free(scene_t *scene) {
+  scene_disable_broad_phase(scene);
+  list_free(scene->active_contacts);
+  list_free(scene->collision_rules);
+  pair_table_free(scene->collision_pairs);
+  list_free(scene->collision_pair_list);
+  free(scene->collision_records);
+  pair_table_free(scene->contact_forces);
+  pair_table_free(scene->body_forces);
+  list_free(scene->force_batches);
+  pair_table_free(scene->body_records);
+  // Forces go first, since freeing one may look at its bodies
+  list_filter(scene->retained, scene_keep_retained_body, NULL);
+  for (size_t i = 0; i < list_size(scene->retained); i++) {
+    retained_free(list_get(scene->retained, i));
+  }
+  list_free(scene->retained);
+  for (size_t i = 0; i < list_size(scene->forces); i++) {
+    force_free(list_get(scene->forces, i));
+  }
   list_free(scene->forces);
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_free(list_get(scene->bodies, i));
+  }
   list_free(scene->bodies);
+  // The snapshots outlive the scene, but can no longer be taken or restored
+  for (size_t i = 0; i < list_size(scene->snapshots); i++) {
+    scene_snapshot_t *snapshot = list_get(scene->snapshots, i);
+    snapshot->scene = NULL;
+  }
+  list_free(scene->snapshots);
+  slot_map_free(scene->slots);
+  free(scene->handles);
+  if (scene->store != NULL) {
+    body_store_free(scene->store);
+  }
+  scene_set_threads(scene, 1);
   free(scene);
 }
 
+void scene_set_threads(scene_t *scene, size_t num_threads) {
+  assert(num_threads > 0);
+
+  if (scene->pool != NULL) {
+    thread_pool_free(scene->pool);
+    free(scene->schedule);
+    free(scene->batch_ends);
+    scene->pool = NULL;
+    scene->schedule = NULL;
+    scene->batch_ends = NULL;
+  }
+  if (num_threads > 1) {
+    scene->pool = thread_pool_init(num_threads);
+    scene->schedule_dirty = true;
+  }
+}
+
+void scene_enable_body_store(scene_t *scene) {
+  if (scene->store != NULL) {
+    return;
+  }
+  scene->store = body_store_init();
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    body_store_attach(scene->store, list_get(scene->bodies, i));
+  }
+}
+
+void scene_enable_grid(scene_t *scene, double cell_size) {
+  scene_disable_broad_phase(scene);
+  scene->schedule_dirty = true;
+  scene->grid = spatial_grid_init(cell_size);
+}
+
+/**
+ * Inserts a body into the scene's AABB tree and records its proxy id.
+ */
+void scene_insert_tree_proxy(scene_t *scene, body_t *body) {
+  size_t *proxy = malloc(sizeof(size_t));
+  assert(proxy != NULL);
+  *proxy = aabb_tree_insert(scene->tree, body_get_bounds(body), body);
+  list_add(scene->proxies, proxy);
+}
+
+void scene_enable_aabb_tree(scene_t *scene, double margin) {
+  scene_disable_broad_phase(scene);
+  scene->schedule_dirty = true;
+  scene->tree = aabb_tree_init(margin);
+  scene->proxies = list_init(list_size(scene->bodies) + 1, free);
+  for (size_t i = 0; i < list_size(scene->bodies); i++) {
+    scene_insert_tree_proxy(scene, list_get(scene->bodies, i));
+  }
+}
+
+bool scene_has_broad_phase(scene_t *scene) {
+  return scene->grid != NULL || scene->tree != NULL;
+}
+
+void scene_disable_broad_phase(scene_t *scene) {
+  scene->schedule_dirty = true;
+  if (scene->grid != NULL) {
+    spatial_grid_free(scene->grid);
+    scene->grid = NULL;
+  }
+  if (scene->tree != NULL) {
+    aabb_tree_free(scene->tree);
+    list_free(scene->proxies);
+    scene->tree = NULL;
+    scene->proxies = NULL;
+  }
+  // Every contact force runs next tick, which resets its contact state
+  while (list_size(scene->active_contacts) != 0) {
+    list_remove(scene->active_contacts, list_size(scene->active_contacts) - 1);
+  }
+}
+
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
 
 body_t *scene_get_body(scene_t *scene, size_t index) {
@@ -64,15 +581,122 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
   return list_get(scene->bodies, index);
 }
 
-void scene_add_body(scene_t *scene, body_t *body) {
+body_handle_t scene_get_handle(scene_t *scene, size_t index) {
+  assert(index < list_size(scene->bodies));
+
+  return scene->handles[index];
+}
+
+body_t *scene_get_body_by_handle(scene_t *scene, body_handle_t handle) {
+  return slot_map_get(scene->slots, handle);
+}
+
+body_handle_t scene_add_body(scene_t *scene, body_t *body) {
+  size_t index = list_size(scene->bodies);
+  if (index == scene->handles_capacity) {
+    scene->handles_capacity *= 2;
+    scene->handles = realloc(scene->handles, sizeof(body_handle_t) *
+                                                 scene->handles_capacity);
+    assert(scene->handles != NULL);
+  }
+  body_handle_t handle = slot_map_insert(scene->slots, body);
+  scene->handles[index] = handle;
   list_add(scene->bodies, body);
+  // A body placed before being added should not be drawn sliding into place
+  body_save_transform(body);
+  if (scene->store != NULL) {
+    body_store_attach(scene->store, body);
+  }
+  if (scene->tree != NULL) {
+    scene_insert_tree_proxy(scene, body);
+  }
+  return handle;
+}
+
+/**
+ * Removes a contact force from the list of forces between its two bodies.
+ */
+void scene_unindex_contact(scene_t *scene, force_t *force) {
+  body_t *body1 = list_get(force->bodies, 0);
+  body_t *body2 = list_get(force->bodies, 1);
+  list_t *pair_forces = pair_table_get(scene->contact_forces, body1, body2);
+  for (size_t i = 0; i < list_size(pair_forces); i++) {
+    if (list_get(pair_forces, i) == force) {
+      list_remove(pair_forces, i);
+      break;
+    }
+  }
+  if (list_size(pair_forces) == 0) {
+    pair_table_remove(scene->contact_forces, body1, body2);
+    list_free(pair_forces);
+  }
+}
+
+/**
+ * Removes a force from the list of forces acting on each of its bodies
+ * that is not itself being removed. Takes O(number of forces on each body).
+ */
+void scene_unindex_force(scene_t *scene, force_t *force) {
+  if (force->is_contact) {
+    scene_unindex_contact(scene, force);
+  }
+  size_t num_bodies = list_size(force->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(force->bodies, i);
+    // Removed bodies' lists are dropped whole by scene_mark_body_forces()
+    list_t *body_forces = pair_table_get(scene->body_forces, body, body);
+    if (body_forces == NULL) {
+      continue;
+    }
+    for (size_t j = 0; j < list_size(body_forces); j++) {
+      if (list_get(body_forces, j) == force) {
+        list_remove(body_forces, j);
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * Marks every force acting on a removed body for removal and forgets the
+ * body's list of forces. Takes O(number of forces on the body).
+ * Group forces are not marked, but added to *groups (allocated on first
+ * use) so the removed bodies can be dropped from them afterwards.
+ *
+ * @return the number of forces newly marked for removal
+ */
+size_t scene_mark_body_forces(scene_t *scene, body_t *body, list_t **groups) {
+  list_t *body_forces = pair_table_remove(scene->body_forces, body, body);
+  if (body_forces == NULL) {
+    return 0;
+  }
+  size_t marked = 0;
+  size_t num_forces = list_size(body_forces);
+  for (size_t i = 0; i < num_forces; i++) {
+    force_t *force = list_get(body_forces, i);
+    if (force->is_group) {
+      if (!force->prune_bodies) {
+        force->prune_bodies = true;
+        if (*groups == NULL) {
+          *groups = list_init(1, NULL);
+        }
+        list_add(*groups, force);
+      }
+    } else if (!force_is_removed(force)) {
+      force_remove(force);
+      marked++;
+    }
+  }
+  list_free(body_forces);
+  return marked;
 }
 
 void scene_remove_force(scene_t *scene, size_t index) {
   assert(index < list_size(scene->forces));
 
   force_t *force = list_remove(scene->forces, index);
-  force_free(force);
+  scene_unindex_force(scene, force);
+  scene_release_force(scene, force);
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
@@ -82,6 +706,44 @@ void scene_remove_body(scene_t *scene, size_t index) {
   body_remove(body);
 }
 
+void scene_remove_body_by_handle(scene_t *scene, body_handle_t handle) {
+  body_t *body = slot_map_get(scene->slots, handle);
+  if (body != NULL) {
+    body_remove(body);
+  }
+}
+
+/**
+ * Indexes a force by each of its bodies, so removing a body only has to
+ * look at the forces acting on it.
+ */
+void scene_index_force(scene_t *scene, force_t *force) {
+  size_t num_bodies = list_size(force->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(force->bodies, i);
+    list_t *body_forces = pair_table_get(scene->body_forces, body, body);
+    if (body_forces == NULL) {
+      body_forces = list_init(1, NULL);
+      pair_table_put(scene->body_forces, body, body, body_forces);
+    }
+    list_add(body_forces, force);
+  }
+}
+
+/**
+ * Indexes a contact force by its pair of bodies for the broad phase.
+ */
+void scene_index_contact(scene_t *scene, force_t *force) {
+  body_t *body1 = list_get(force->bodies, 0);
+  body_t *body2 = list_get(force->bodies, 1);
+  list_t *pair_forces = pair_table_get(scene->contact_forces, body1, body2);
+  if (pair_forces == NULL) {
+    pair_forces = list_init(1, NULL);
+    pair_table_put(scene->contact_forces, body1, body2, pair_forces);
+  }
+  list_add(pair_forces, force);
+}
+
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                              free_func_t freer) {
   scene_add_bodies_force_creator(scene, forcer, aux, NULL, freer);
@@ -100,54 +762,1518 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
   force->mark_removal = false;
   force->freer = freer;
   force->forcer = forcer;
+  force->is_contact = false;
+  force->separator = NULL;
+  force->index = scene->forces_added++;
+  force->last_tick = 0;
+  force->thread_safe = false;
+  force->is_group = false;
+  force->prune_bodies = false;
+  force->state = NULL;
+  force->state_size = 0;
   list_add(scene->forces, force);
+  scene->schedule_dirty = true;
+  scene_index_force(scene, force);
 }
 
-void scene_tick(scene_t *scene, double dt) {
-  size_t num_forces = list_size(scene->forces);
+void scene_add_parallel_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies,
+                                      free_func_t freer) {
+  assert(bodies != NULL);
+
+  scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
+  force_t *force = list_get(scene->forces, list_size(scene->forces) - 1);
+  force->thread_safe = true;
+}
+
+bool force_record_is_idle(force_record_t *record) {
+  return body_is_idle(record->body1) &&
+         (record->body2 == NULL || body_is_idle(record->body2));
+}
+
+/**
+ * Adds a record to the list of records a body is in.
+ */
+void scene_index_record(scene_t *scene, body_t *body, record_ref_t *ref) {
+  list_t *refs = pair_table_get(scene->body_records, body, body);
+  if (refs == NULL) {
+    refs = list_init(1, NULL);
+    pair_table_put(scene->body_records, body, body, refs);
+  }
+  list_add(refs, ref);
+}
+
+/**
+ * Appends a record to a batch and indexes it by its bodies.
+ */
+void scene_push_record(scene_t *scene, force_batch_t *batch,
+                       force_record_t record) {
+  if (batch->num_records == batch->capacity) {
+    batch->capacity = batch->capacity == 0 ? 8 : 2 * batch->capacity;
+    batch->records =
+        realloc(batch->records, sizeof(force_record_t) * batch->capacity);
+    batch->refs =
+        realloc(batch->refs, sizeof(record_ref_t *) * batch->capacity);
+    assert(batch->records != NULL && batch->refs != NULL);
+  }
+  record_ref_t *ref = malloc(sizeof(record_ref_t));
+  assert(ref != NULL);
+  *ref = (record_ref_t){batch, batch->num_records};
+  batch->records[batch->num_records] = record;
+  batch->refs[batch->num_records] = ref;
+  batch->num_records++;
+
+  scene_index_record(scene, record.body1, ref);
+  if (record.body2 != NULL) {
+    scene_index_record(scene, record.body2, ref);
+  }
+}
+
+void scene_add_force_record(scene_t *scene, force_kernel_t kernel,
+                            force_record_t record) {
+  assert(record.body1 != NULL && record.body2 != record.body1);
+
+  force_batch_t *batch = NULL;
+  size_t num_batches = list_size(scene->force_batches);
+  for (size_t i = 0; i < num_batches && batch == NULL; i++) {
+    force_batch_t *other = list_get(scene->force_batches, i);
+    if (other->kernel == kernel) {
+      batch = other;
+    }
+  }
+  if (batch == NULL) {
+    batch = malloc(sizeof(force_batch_t));
+    assert(batch != NULL);
+    *batch = (force_batch_t){kernel, NULL, NULL, 0, 0};
+    list_add(scene->force_batches, batch);
+  }
+  record.stream = scene->records_added++;
+  scene_push_record(scene, batch, record);
+}
+
+bool scene_keep_other_ref(void *ref, void *removed) { return ref != removed; }
+
+/**
+ * Drops a removed body's records, moving the last record of each batch
+ * into the gap, and forgets its list of records.
+ * Takes O(number of records on the body and on the bodies it shares them
+ * with), rather than looking at every record.
+ */
+void scene_remove_body_records(scene_t *scene, body_t *body) {
+  list_t *refs = pair_table_remove(scene->body_records, body, body);
+  if (refs == NULL) {
+    return;
+  }
+  size_t num_refs = list_size(refs);
+  for (size_t i = 0; i < num_refs; i++) {
+    record_ref_t *ref = list_get(refs, i);
+    force_batch_t *batch = ref->batch;
+    force_record_t *record = &batch->records[ref->index];
+    body_t *other = record->body1 == body ? record->body2 : record->body1;
+    // A removed other body has already dropped the records they share
+    list_t *other_refs = NULL;
+    if (other != NULL) {
+      other_refs = pair_table_get(scene->body_records, other, other);
+    }
+    if (other_refs != NULL) {
+      list_filter(other_refs, scene_keep_other_ref, ref);
+    }
+
+    size_t last = --batch->num_records;
+    if (ref->index != last) {
+      batch->records[ref->index] = batch->records[last];
+      batch->refs[ref->index] = batch->refs[last];
+      batch->refs[ref->index]->index = ref->index;
+    }
+    free(ref);
+  }
+  list_free(refs);
+}
+
+void scene_add_group_force_creator(scene_t *scene, force_creator_t forcer,
+                                   void *aux, list_t *bodies,
+                                   free_func_t freer) {
+  assert(bodies != NULL);
+
+  scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
+  force_t *force = list_get(scene->forces, list_size(scene->forces) - 1);
+  force->is_group = true;
+}
+
+void scene_add_force_state(scene_t *scene, void *aux, void *state,
+                           size_t size) {
+  // Searches from the end, since the force was most likely just added
+  force_t *force = NULL;
+  for (size_t i = list_size(scene->forces); i > 0 && force == NULL; i--) {
+    force_t *other = list_get(scene->forces, i - 1);
+    if (other->aux == aux) {
+      force = other;
+    }
+  }
+  assert(force != NULL);
+  force->state = state;
+  force->state_size = size;
+}
+
+void scene_add_contact_force_creator(scene_t *scene, force_creator_t forcer,
+                                     force_creator_t separator, void *aux,
+                                     list_t *bodies, free_func_t freer) {
+  assert(bodies != NULL && list_size(bodies) >= 2);
+
+  scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
+  force_t *force = list_get(scene->forces, list_size(scene->forces) - 1);
+  force->is_contact = true;
+  force->separator = separator;
+  scene_index_contact(scene, force);
+}
+
+/**
+ * Registers a collision rule, recording which categories it pairs.
+ */
+void scene_add_collision_rule(scene_t *scene, collision_rule_t rule) {
+  assert(rule.category1 != 0 && rule.category2 != 0);
+  assert(rule.events != 0);
+
+  collision_rule_t *added = malloc(sizeof(collision_rule_t));
+  assert(added != NULL);
+  *added = rule;
+  list_add(scene->collision_rules, added);
+  scene->collision_events |= rule.events;
+  for (size_t i = 0; i < COLLISION_CATEGORIES; i++) {
+    if ((rule.category1 >> i) & 1) {
+      scene->collision_partners[i] |= rule.category2;
+    }
+    if ((rule.category2 >> i) & 1) {
+      scene->collision_partners[i] |= rule.category1;
+    }
+  }
+}
+
+void scene_add_collision_handler(scene_t *scene, uint32_t category1,
+                                 uint32_t category2,
+                                 collision_handler_t handler, void *aux,
+                                 free_func_t freer) {
+  scene_add_collision_rule(scene,
+                           (collision_rule_t){category1, category2,
+                                              COLLISION_BEGIN, handler, NULL,
+                                              aux, freer});
+}
+
+void scene_add_collision_event_handler(scene_t *scene, uint32_t category1,
+                                       uint32_t category2, uint32_t events,
+                                       collision_event_handler_t handler,
+                                       void *aux, free_func_t freer) {
+  scene_add_collision_rule(scene,
+                           (collision_rule_t){category1, category2, events,
+                                              NULL, handler, aux, freer});
+}
+
+/**
+ * Returns whether two bodies' collision filters let them collide and some
+ * collision handler is registered for their categories.
+ */
+bool scene_may_collide(scene_t *scene, body_t *body1, body_t *body2) {
+  uint32_t category1 = body_get_collision_category(body1);
+  uint32_t category2 = body_get_collision_category(body2);
+  if ((category1 & body_get_collision_mask(body2)) == 0 ||
+      (category2 & body_get_collision_mask(body1)) == 0) {
+    return false;
+  }
+  for (size_t i = 0; category1 != 0; i++, category1 >>= 1) {
+    if ((category1 & 1) && (scene->collision_partners[i] & category2)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Queues a contact event to be dispatched once every pair is tested.
+ * Events no handler asks for are dropped.
+ */
+void scene_record_collision(scene_t *scene, collision_pair_t *pair,
+                            collision_event_t event) {
+  if ((scene->collision_events & event) == 0) {
+    return;
+  }
+  if (scene->num_collision_records == scene->collision_records_capacity) {
+    scene->collision_records_capacity =
+        scene->collision_records_capacity == 0
+            ? INIT_BODY_CAPACITY
+            : 2 * scene->collision_records_capacity;
+    scene->collision_records =
+        realloc(scene->collision_records,
+                sizeof(collision_record_t) * scene->collision_records_capacity);
+    assert(scene->collision_records != NULL);
+  }
+  scene->collision_records[scene->num_collision_records++] =
+      (collision_record_t){pair->body1, pair->body2, event, pair->axis};
+}
+
+/**
+ * Calls the collision handlers for every event recorded this tick, in order.
+ */
+void scene_dispatch_collisions(scene_t *scene) {
+  size_t num_rules = list_size(scene->collision_rules);
+  // Handlers only remove bodies, never add events, so the count is fixed
+  for (size_t i = 0; i < scene->num_collision_records; i++) {
+    collision_record_t record = scene->collision_records[i];
+    uint32_t category1 = body_get_collision_category(record.body1);
+    uint32_t category2 = body_get_collision_category(record.body2);
+    for (size_t j = 0; j < num_rules; j++) {
+      if (body_is_removed(record.body1) || body_is_removed(record.body2)) {
+        break;
+      }
+      collision_rule_t *rule = list_get(scene->collision_rules, j);
+      if ((rule->events & record.event) == 0) {
+        continue;
+      }
+      body_t *body1 = record.body1;
+      body_t *body2 = record.body2;
+      vector_t axis = record.axis;
+      if (!(rule->category1 & category1) || !(rule->category2 & category2)) {
+        if (!(rule->category1 & category2) || !(rule->category2 & category1)) {
+          continue;
+        }
+        body1 = record.body2;
+        body2 = record.body1;
+        axis = vec_negate(axis);
+      }
+      if (rule->handler != NULL) {
+        rule->handler(body1, body2, axis, rule->aux);
+      } else {
+        rule->event_handler(body1, body2, record.event, axis, rule->aux);
+      }
+    }
+  }
+  scene->num_collision_records = 0;
+}
+
+/**
+ * Drops the contact state of pairs that were not candidates this tick,
+ * recording an end event if they were touching, and of pairs whose bodies
+ * are about to be freed.
+ */
+bool scene_keep_collision_pair(void *pair, void *aux) {
+  collision_pair_t *collision_pair = pair;
+  scene_t *scene = aux;
+  if (body_is_removed(collision_pair->body1) ||
+      body_is_removed(collision_pair->body2)) {
+    pair_table_remove(scene->collision_pairs, collision_pair->body1,
+                      collision_pair->body2);
+    return false;
+  }
+  if (collision_pair->last_tick == scene->tick) {
+    return true;
+  }
+  if (collision_pair->touching) {
+    scene_record_collision(scene, collision_pair, COLLISION_END);
+  }
+  pair_table_remove(scene->collision_pairs, collision_pair->body1,
+                    collision_pair->body2);
+  return false;
+}
+
+/**
+ * A pair tested this tick and what the test found. Idle pairs are not tested,
+ * since whether they touch cannot have changed.
+ */
+typedef struct collision_check {
+  collision_pair_t *pair;
+  bool idle;
+  collision_info_t info;
+} collision_check_t;
+
+void scene_check_collision_chunk(void *checks, size_t start, size_t end) {
+  for (size_t i = start; i < end; i++) {
+    collision_check_t *check = &((collision_check_t *)checks)[i];
+    if (!check->idle) {
+      collision_pair_t *pair = check->pair;
+      check->info =
+          find_body_collision(pair->body1, pair->body2, &pair->axis_cache);
+    }
+  }
+}
+
+/**
+ * Tests each candidate pair of bodies for collision, then calls the handlers
+ * for the begin, persist and end events found.
+ * The candidates are given as consecutive pairs of bodies in a list.
+ */
+void scene_run_collisions(scene_t *scene, list_t *candidates) {
+  size_t num_candidates = list_size(candidates) / 2;
+  collision_check_t *checks =
+      malloc(sizeof(collision_check_t) * (num_candidates + 1));
+  assert(checks != NULL);
+
+  // Finds each pair's state serially, since that may grow the pair table
+  size_t num_checks = 0;
+  for (size_t i = 0; i < num_candidates; i++) {
+    body_t *body1 = list_get(candidates, 2 * i);
+    body_t *body2 = list_get(candidates, 2 * i + 1);
+    if (body_is_removed(body1) || body_is_removed(body2)) {
+      continue;
+    }
+    collision_pair_t *pair =
+        pair_table_get(scene->collision_pairs, body1, body2);
+    if (pair == NULL) {
+      pair = malloc(sizeof(collision_pair_t));
+      assert(pair != NULL);
+      pair->body1 = body1;
+      pair->body2 = body2;
+      pair->touching = false;
+      pair->axis = VEC_ZERO;
+      pair->axis_cache.has_axis = false;
+      pair_table_put(scene->collision_pairs, body1, body2, pair);
+      list_add(scene->collision_pair_list, pair);
+    }
+    pair->last_tick = scene->tick;
+    bool idle = body_is_idle(body1) && body_is_idle(body2);
+    checks[num_checks++] = (collision_check_t){pair, idle, {false, VEC_ZERO}};
+  }
+
+  // Tests the pairs, which only writes to each pair's own state
+  if (scene->pool != NULL) {
+    // Brings every body's world shape up to date first, since that is
+    // computed lazily and the pairs share bodies
+    for (size_t i = 0; i < num_checks; i++) {
+      body_t *pair_bodies[] = {checks[i].pair->body1, checks[i].pair->body2};
+      for (size_t j = 0; j < 2; j++) {
+        if (!body_is_circle(pair_bodies[j])) {
+          body_view_shape(pair_bodies[j]);
+          body_view_normals(pair_bodies[j]);
+        }
+      }
+    }
+    thread_pool_for(scene->pool, num_checks, PARALLEL_COLLISION_GRAIN,
+                    scene_check_collision_chunk, checks);
+  } else {
+    scene_check_collision_chunk(checks, 0, num_checks);
+  }
+
+  for (size_t i = 0; i < num_checks; i++) {
+    collision_pair_t *pair = checks[i].pair;
+    if (checks[i].idle) {
+      if (pair->touching) {
+        scene_record_collision(scene, pair, COLLISION_PERSIST);
+      }
+      continue;
+    }
+    collision_info_t info = checks[i].info;
+    if (info.collided) {
+      pair->axis = info.axis;
+      scene_record_collision(scene, pair,
+                             pair->touching ? COLLISION_PERSIST
+                                            : COLLISION_BEGIN);
+    } else if (pair->touching) {
+      scene_record_collision(scene, pair, COLLISION_END);
+    }
+    pair->touching = info.collided;
+  }
+  free(checks);
+  list_filter(scene->collision_pair_list, scene_keep_collision_pair, scene);
+
+  scene_dispatch_collisions(scene);
+  // Forgets the pairs of bodies the handlers removed, before they are freed
+  list_filter(scene->collision_pair_list, scene_keep_collision_pair, scene);
+}
+
+/**
+ * Collects every pair of bodies that may collide, for scenes without a
+ * broad phase.
+ */
+void scene_collect_all_collisions(scene_t *scene, list_t *candidates) {
+  size_t num_bodies = list_size(scene->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body1 = list_get(scene->bodies, i);
+    if (body_get_collision_category(body1) == 0) {
+      continue;
+    }
+    for (size_t j = i + 1; j < num_bodies; j++) {
+      body_t *body2 = list_get(scene->bodies, j);
+      if ((body_get_kind(body1) != BODY_STATIC ||
+           body_get_kind(body2) != BODY_STATIC) &&
+          scene_may_collide(scene, body1, body2)) {
+        list_add(candidates, body1);
+        list_add(candidates, body2);
+      }
+    }
+  }
+}
+
+/**
+ * Passed to the broad phase's pair enumeration: collects the contact forces
+ * between each pair of bodies whose bounding boxes overlap into a list,
+ * and the pairs that collision handlers should test into another.
+ */
+typedef struct contact_collector {
+  scene_t *scene;
+  list_t *candidates;
+  list_t *collisions;
+} contact_collector_t;
+
+void scene_collect_contacts(void *body1, void *body2, void *aux) {
+  // Two static bodies can never start or stop touching
+  if (body_get_kind(body1) == BODY_STATIC &&
+      body_get_kind(body2) == BODY_STATIC) {
+    return;
+  }
+  contact_collector_t *collector = aux;
+  if (scene_may_collide(collector->scene, body1, body2)) {
+    list_add(collector->collisions, body1);
+    list_add(collector->collisions, body2);
+  }
+  list_t *pair_forces =
+      pair_table_get(collector->scene->contact_forces, body1, body2);
+  if (pair_forces == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < list_size(pair_forces); i++) {
+    list_add(collector->candidates, list_get(pair_forces, i));
+  }
+}
+
+void scene_collect_grid_contacts(size_t index1, size_t index2, void *aux) {
+  list_t *bodies = ((contact_collector_t *)aux)->scene->bodies;
+  scene_collect_contacts(list_get(bodies, index1), list_get(bodies, index2),
+                         aux);
+}
+
+int force_index_compare(const void *force1, const void *force2) {
+  size_t index1 = (*(force_t **)force1)->index;
+  size_t index2 = (*(force_t **)force2)->index;
+  return (index1 > index2) - (index1 < index2);
+}
+
+/**
+ * Runs only the contact forces whose bodies' bounding boxes overlap, in the
+ * order they were added, then notifies contacts that stopped overlapping.
+ * Adds the overlapping pairs that collision handlers should test
+ * to collisions.
+ */
+void scene_run_contact_forces(scene_t *scene, list_t *collisions) {
+  contact_collector_t collector = {
+      scene, list_init(list_size(scene->active_contacts) + 1, NULL),
+      collisions};
+  size_t num_bodies = list_size(scene->bodies);
+  if (scene->grid != NULL) {
+    spatial_grid_clear(scene->grid);
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_t *body = list_get(scene->bodies, i);
+      spatial_grid_insert(scene->grid, i, body_get_bounds(body));
+    }
+    spatial_grid_pairs(scene->grid, scene_collect_grid_contacts, &collector);
+  } else {
+    // Refit here rather than after body_tick() so bodies moved between
+    // ticks (e.g. with body_set_centroid()) are also accounted for.
+    // Only bodies that left their fat boxes change the tree.
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_t *body = list_get(scene->bodies, i);
+      size_t *proxy = list_get(scene->proxies, i);
+      aabb_tree_move(scene->tree, *proxy, body_get_bounds(body));
+    }
+    aabb_tree_pairs(scene->tree, scene_collect_contacts, &collector);
+  }
+  list_sort(collector.candidates, force_index_compare);
+
+  size_t num_candidates = list_size(collector.candidates);
+  for (size_t i = 0; i < num_candidates; i++) {
+    force_t *force = list_get(collector.candidates, i);
+    force->last_tick = scene->tick;
+    // Idle bodies have not moved, so their contact state is unchanged
+    if (!force_is_idle(force)) {
+      force->forcer(force->aux);
+    }
+  }
+
+  // Contacts that ran last tick but were culled this tick have separated
+  size_t num_active = list_size(scene->active_contacts);
+  for (size_t i = 0; i < num_active; i++) {
+    force_t *force = list_get(scene->active_contacts, i);
+    if (force->last_tick != scene->tick && force->separator != NULL) {
+      force->separator(force->aux);
+    }
+  }
+  list_free(scene->active_contacts);
+  scene->active_contacts = collector.candidates;
+}
+
+/**
+ * Drops forces that are about to be freed from the broad phase's list of
+ * active contacts.
+ */
+bool force_is_live(void *force, void *aux) { return !force_is_removed(force); }
+
+void scene_prune_active_contacts(scene_t *scene) {
+  list_filter(scene->active_contacts, force_is_live, NULL);
+}
+
+/**
+ * Passed to list_filter() on the scene's bodies. Counts the bodies visited so
+ * a removed body's tree proxy (at the same index) can be removed as well.
+ */
+typedef struct body_filter {
+  scene_t *scene;
+  size_t index;
+  // The number of bodies kept so far
+  size_t kept;
+} body_filter_t;
+
+bool scene_keep_body(void *body, void *aux) {
+  body_filter_t *filter = aux;
+  body_handle_t *handles = filter->scene->handles;
+  size_t index = filter->index++;
+  if (!body_is_removed(body)) {
+    // Compacts the handles alongside the bodies
+    handles[filter->kept++] = handles[index];
+    return true;
+  }
+  slot_map_remove(filter->scene->slots, handles[index]);
+  if (filter->scene->tree != NULL) {
+    size_t *proxy = list_get(filter->scene->proxies, index);
+    aabb_tree_remove(filter->scene->tree, *proxy);
+    // Marks the proxy for scene_keep_proxy()
+    *proxy = SIZE_MAX;
+  }
+  scene_release_body(filter->scene, body);
+  return false;
+}
+
+bool scene_keep_proxy(void *proxy, void *aux) {
+  return *(size_t *)proxy != SIZE_MAX;
+}
+
+bool scene_keep_group_body(void *body, void *aux) {
+  return !body_is_removed(body);
+}
+
+bool scene_keep_force(void *force, void *scene) {
+  if (!force_is_removed(force)) {
+    return true;
+  }
+  scene_unindex_force(scene, force);
+  scene_release_force(scene, force);
+  return false;
+}
 
+/**
+ * The batches a body's forces were put in while building a schedule.
+ * Bit i of used is set if the body has a force in batch segment + i.
+ */
+typedef struct body_batches {
+  size_t segment;
+  uint64_t used;
+  size_t last;
+} body_batches_t;
+
+/**
+ * Groups the forces run each tick into batches for a parallel tick by
+ * greedily coloring the graph where forces sharing a body are adjacent:
+ * each thread-safe force goes in the first batch none of its bodies use yet.
+ * A force that is not thread-safe gets a batch of its own after every earlier
+ * force, and every later force comes after it, just like in a serial tick.
+ */
+void scene_build_schedule(scene_t *scene) {
+  size_t num_forces = list_size(scene->forces);
+  size_t *batches = malloc(sizeof(size_t) * num_forces);
+  assert(batches != NULL);
+  // Maps each body (as the pair (body, body)) to its body_batches_t
+  pair_table_t *records = pair_table_init(list_size(scene->bodies), free);
+  // Thread-safe forces go in batches from first_batch on
+  size_t first_batch = 0;
+  size_t num_batches = 0;
+  size_t num_scheduled = 0;
   for (size_t i = 0; i < num_forces; i++) {
-    force_t *force = (force_t *)list_get(scene->forces, i);
+    force_t *force = list_get(scene->forces, i);
+    if (scene_has_broad_phase(scene) && force->is_contact) {
+      batches[i] = SIZE_MAX;
+      continue;
+    }
+    size_t batch;
+    size_t num_bodies = list_size(force->bodies);
+    if (!force->thread_safe) {
+      batch = num_batches;
+      first_batch = batch + 1;
+    } else {
+      uint64_t used = 0;
+      size_t after_last = first_batch;
+      for (size_t j = 0; j < num_bodies; j++) {
+        body_t *body = list_get(force->bodies, j);
+        body_batches_t *record = pair_table_get(records, body, body);
+        if (record != NULL && record->segment == first_batch) {
+          used |= record->used;
+          if (record->last + 1 > after_last) {
+            after_last = record->last + 1;
+          }
+        }
+      }
+      // Uses the first free batch, or the batch after all of them if the
+      // first 64 are taken
+      size_t offset = 0;
+      while (offset < 64 && (used >> offset & 1) != 0) {
+        offset++;
+      }
+      batch = offset < 64 ? first_batch + offset : after_last;
 
-    // applies each force
-    force->forcer(force->aux);
+      for (size_t j = 0; j < num_bodies; j++) {
+        body_t *body = list_get(force->bodies, j);
+        body_batches_t *record = pair_table_get(records, body, body);
+        if (record == NULL) {
+          record = malloc(sizeof(body_batches_t));
+          assert(record != NULL);
+          pair_table_put(records, body, body, record);
+          record->segment = SIZE_MAX;
+        }
+        if (record->segment != first_batch) {
+          *record = (body_batches_t){first_batch, 0, first_batch};
+        }
+        if (batch - first_batch < 64) {
+          record->used |= (uint64_t)1 << (batch - first_batch);
+        }
+        if (batch > record->last) {
+          record->last = batch;
+        }
+      }
+    }
+    batches[i] = batch;
+    num_scheduled++;
+    if (batch + 1 > num_batches) {
+      num_batches = batch + 1;
+    }
   }
+  pair_table_free(records);
 
+  // Counting sort by batch, keeping forces in the same batch in order
+  free(scene->batch_ends);
+  scene->batch_ends = calloc(num_batches + 1, sizeof(size_t));
+  assert(scene->batch_ends != NULL);
   for (size_t i = 0; i < num_forces; i++) {
-    force_t *force = (force_t *)list_get(scene->forces, i);
+    if (batches[i] != SIZE_MAX) {
+      scene->batch_ends[batches[i] + 1]++;
+    }
+  }
+  for (size_t b = 0; b < num_batches; b++) {
+    scene->batch_ends[b + 1] += scene->batch_ends[b];
+  }
+  free(scene->schedule);
+  scene->schedule = malloc(sizeof(force_t *) * (num_scheduled + 1));
+  assert(scene->schedule != NULL);
+  for (size_t i = 0; i < num_forces; i++) {
+    if (batches[i] != SIZE_MAX) {
+      scene->schedule[scene->batch_ends[batches[i]]++] =
+          list_get(scene->forces, i);
+    }
+  }
+  // The placement loop advanced each batch's start to its end
+  scene->num_batches = num_batches;
+  free(batches);
+  scene->schedule_dirty = false;
+}
+
+void scene_run_force_chunk(void *forces, size_t start, size_t end) {
+  for (size_t i = start; i < end; i++) {
+    force_t *force = ((force_t **)forces)[i];
+    if (!force_is_idle(force)) {
+      force->forcer(force->aux);
+    }
+  }
+}
+
+/**
+ * Runs the forces of a tick batch by batch, spreading each batch across
+ * the scene's threads.
+ * Forces added during the tick first run next tick, as in a serial tick.
+ */
+void scene_run_forces_parallel(scene_t *scene) {
+  if (scene->schedule_dirty) {
+    scene_build_schedule(scene);
+  }
+  size_t start = 0;
+  for (size_t b = 0; b < scene->num_batches; b++) {
+    size_t end = scene->batch_ends[b];
+    if (end - start == 1) {
+      scene_run_force_chunk(scene->schedule, start, end);
+    } else {
+      thread_pool_for(scene->pool, end - start, PARALLEL_FORCE_GRAIN,
+                      scene_run_force_chunk, scene->schedule + start);
+    }
+    start = end;
+  }
+}
+
+typedef struct tick_chunk {
+  scene_t *scene;
+  double dt;
+} tick_chunk_t;
+
+void scene_tick_body_chunk(void *aux, size_t start, size_t end) {
+  tick_chunk_t *chunk = aux;
+  for (size_t i = start; i < end; i++) {
+    body_t *body = list_get(chunk->scene->bodies, i);
+    if (body_get_kind(body) != BODY_STATIC) {
+      body_tick(body, chunk->dt);
+    }
+  }
+}
+
+void scene_tick_store_chunk(void *aux, size_t start, size_t end) {
+  tick_chunk_t *chunk = aux;
+  body_store_tick_range(chunk->scene->store, start, end, chunk->dt);
+}
+
+/**
+ * Ticks every body in a scene that is not static. Static bodies never move
+ * and never hold forces, so they are skipped without calling body_tick().
+ */
+void scene_integrate(scene_t *scene, double dt) {
+  // removed bodies were freed already, which detached them from the store
+  tick_chunk_t chunk = {scene, dt};
+  size_t num_bodies = list_size(scene->bodies);
+  if (scene->pool != NULL) {
+    if (scene->store != NULL) {
+      thread_pool_for(scene->pool, body_store_num_moving(scene->store),
+                      PARALLEL_BODY_GRAIN, scene_tick_store_chunk, &chunk);
+    } else {
+      thread_pool_for(scene->pool, num_bodies, PARALLEL_BODY_GRAIN,
+                      scene_tick_body_chunk, &chunk);
+    }
+    return;
+  }
+  if (scene->store != NULL) {
+    body_store_tick(scene->store, dt);
+    return;
+  }
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body_get_kind(body) != BODY_STATIC) {
+      body_tick(body, dt);
+    }
+  }
+}
+
+/**
+ * Adds a body to an island unless it is already in visited, or it cannot be
+ * moved by forces and so does not link the island to anything.
+ */
+void scene_extend_island(body_t *body, list_t *island, pair_table_t *visited) {
+  if (body_get_inverse_mass(body) != 0 &&
+      pair_table_get(visited, body, body) == NULL) {
+    pair_table_put(visited, body, body, body);
+    list_add(island, body);
+  }
+}
+
+/**
+ * Adds a body's island to a list: every body linked to it through chains of
+ * non-contact forces and force records. Bodies with infinite mass, and
+ * kinematic and static bodies, cannot be moved by the forces, so they only
+ * ever form an island by themselves.
+ * Bodies in visited are skipped, and every body added is put in visited.
+ */
+void scene_collect_island(scene_t *scene, body_t *start, list_t *island,
+                          pair_table_t *visited) {
+  size_t first = list_size(island);
+  pair_table_put(visited, start, start, start);
+  list_add(island, start);
+  for (size_t i = first; i < list_size(island); i++) {
+    body_t *body = list_get(island, i);
+    if (body_get_inverse_mass(body) == 0) {
+      continue;
+    }
+    list_t *body_forces = pair_table_get(scene->body_forces, body, body);
+    size_t num_forces = body_forces == NULL ? 0 : list_size(body_forces);
+    for (size_t j = 0; j < num_forces; j++) {
+      force_t *force = list_get(body_forces, j);
+      if (force->is_contact || force->is_group) {
+        continue;
+      }
+      for (size_t k = 0; k < list_size(force->bodies); k++) {
+        scene_extend_island(list_get(force->bodies, k), island, visited);
+      }
+    }
+    list_t *refs = pair_table_get(scene->body_records, body, body);
+    size_t num_refs = refs == NULL ? 0 : list_size(refs);
+    for (size_t j = 0; j < num_refs; j++) {
+      record_ref_t *ref = list_get(refs, j);
+      force_record_t *record = &ref->batch->records[ref->index];
+      body_t *other = record->body1 == body ? record->body2 : record->body1;
+      if (other != NULL) {
+        scene_extend_island(other, island, visited);
+      }
+    }
+  }
+}
 
-    // checks list of bodies in each force. if any are marked for removal,
-    // the force is also marked for removal
-    for (size_t j = 0; j < list_size(force->bodies); j++) {
-      body_t *curr_body = list_get(force->bodies, j);
-      if (body_is_removed(curr_body) == true) {
+/**
+ * Wakes the island of every sleeping body that the forces this tick
+ * would move.
+ */
+void scene_wake_disturbed(scene_t *scene, double dt) {
+  pair_table_t *visited = NULL;
+  list_t *island = NULL;
+  size_t num_bodies = list_size(scene->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (!body_is_sleeping(body)) {
+      continue;
+    }
+    vector_t total_impulse =
+        vec_add(body_get_impulse(body), vec_multiply(dt, body_get_force(body)));
+    vector_t dv = vec_multiply(body_get_inverse_mass(body), total_impulse);
+    if (dv.x == 0 && dv.y == 0) {
+      continue;
+    }
+    if (visited == NULL) {
+      visited = pair_table_init(0, NULL);
+      island = list_init(1, NULL);
+    }
+    scene_collect_island(scene, body, island, visited);
+    while (list_size(island) != 0) {
+      body_wake(list_remove(island, list_size(island) - 1));
+    }
+  }
+  if (visited != NULL) {
+    pair_table_free(visited);
+    list_free(island);
+  }
+}
+
+/**
+ * Updates how long each awake body has been resting, and puts to sleep every
+ * island whose bodies have all been resting long enough.
+ */
+void scene_update_sleep(scene_t *scene, double dt) {
+  size_t num_bodies = list_size(scene->bodies);
+  size_t num_rested = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    // Only dynamic bodies can fall asleep, see body_sleep()
+    if (body_is_idle(body) || body_get_kind(body) != BODY_DYNAMIC) {
+      continue;
+    }
+    double rest_time = 0;
+    if (vec_norm(body_get_velocity(body)) <= scene->sleep_speed) {
+      rest_time = body_get_rest_time(body) + dt;
+    }
+    body_set_rest_time(body, rest_time);
+    if (rest_time >= scene->sleep_delay) {
+      num_rested++;
+    }
+  }
+  if (num_rested == 0) {
+    return;
+  }
+
+  pair_table_t *visited = pair_table_init(num_rested, NULL);
+  list_t *island = list_init(1, NULL);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body_is_idle(body) || body_get_kind(body) != BODY_DYNAMIC ||
+        body_get_rest_time(body) < scene->sleep_delay ||
+        pair_table_get(visited, body, body) != NULL) {
+      continue;
+    }
+    scene_collect_island(scene, body, island, visited);
+    bool rested = true;
+    for (size_t j = 0; j < list_size(island) && rested; j++) {
+      rested = body_get_rest_time(list_get(island, j)) >= scene->sleep_delay;
+    }
+    while (list_size(island) != 0) {
+      body_t *member = list_remove(island, list_size(island) - 1);
+      if (rested) {
+        body_sleep(member);
+      }
+    }
+  }
+  pair_table_free(visited);
+  list_free(island);
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  size_t num_forces = list_size(scene->forces);
+  scene->tick++;
+  scene->tick_dt = dt;
+
+  // applies the built-in forces, one kernel call for each kind
+  size_t num_batches = list_size(scene->force_batches);
+  for (size_t i = 0; i < num_batches; i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    if (batch->num_records != 0) {
+      batch->kernel(scene, batch->records, batch->num_records);
+    }
+  }
+
+  if (scene->pool != NULL) {
+    scene_run_forces_parallel(scene);
+  } else {
+    for (size_t i = 0; i < num_forces; i++) {
+      force_t *force = (force_t *)list_get(scene->forces, i);
+
+      // applies each force (contact forces are left to the broad phase)
+      if ((!scene_has_broad_phase(scene) || !force->is_contact) &&
+          !force_is_idle(force)) {
+        force->forcer(force->aux);
+      }
+    }
+  }
+  list_t *collisions =
+      list_init(2 * list_size(scene->collision_pair_list) + 2, NULL);
+  if (scene_has_broad_phase(scene)) {
+    scene_run_contact_forces(scene, collisions);
+  } else if (list_size(scene->collision_rules) != 0) {
+    scene_collect_all_collisions(scene, collisions);
+  }
+  scene_run_collisions(scene, collisions);
+  list_free(collisions);
+
+  // marks the forces acting on each removed body for removal,
+  // looking only at that body's forces
+  size_t num_bodies = list_size(scene->bodies);
+  size_t removed_bodies = 0;
+  size_t removed_forces = 0;
+  list_t *groups = NULL;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body_is_removed(body)) {
+      removed_bodies++;
+      removed_forces += scene_mark_body_forces(scene, body, &groups);
+      scene_remove_body_records(scene, body);
+    }
+  }
+
+  // drops removed bodies from group forces, removing groups left empty
+  if (groups != NULL) {
+    size_t num_groups = list_size(groups);
+    for (size_t i = 0; i < num_groups; i++) {
+      force_t *force = list_get(groups, i);
+      force->prune_bodies = false;
+      list_filter(force->bodies, scene_keep_group_body, NULL);
+      if (list_size(force->bodies) == 0 && !force_is_removed(force)) {
         force_remove(force);
+        removed_forces++;
       }
     }
+    list_free(groups);
   }
 
-  // loops through bodies, if marked for removal, removes it
-  // otherwise, body_tick is applied
-  size_t i = 0;
-  while (i < list_size(scene->bodies)) {
+  // removes every marked force and then every marked body in one pass each.
+  // Forces go first since unindexing them looks at their surviving bodies.
+  if (removed_forces != 0) {
+    scene_prune_active_contacts(scene);
+    list_filter(scene->forces, scene_keep_force, scene);
+    scene->schedule_dirty = true;
+  }
+  if (removed_bodies != 0) {
+    body_filter_t body_filter = {scene, 0, 0};
+    list_filter(scene->bodies, scene_keep_body, &body_filter);
+    if (scene->tree != NULL) {
+      list_filter(scene->proxies, scene_keep_proxy, NULL);
+    }
+  }
+
+  if (scene->sleeping_enabled) {
+    scene_wake_disturbed(scene, dt);
+  }
+  scene_integrate(scene, dt);
+  if (scene->sleeping_enabled) {
+    scene_update_sleep(scene, dt);
+  }
+}
+
+double scene_get_tick_dt(scene_t *scene) { return scene->tick_dt; }
+
+size_t scene_get_tick(scene_t *scene) { return scene->tick; }
+
+void scene_set_seed(scene_t *scene, uint64_t seed) { scene->seed = seed; }
+
+uint64_t scene_get_seed(scene_t *scene) { return scene->seed; }
+
+void scene_set_fixed_step(scene_t *scene, double step, size_t max_substeps) {
+  assert(step >= 0);
+  assert(step == 0 || max_substeps > 0);
+
+  scene->fixed_step = step;
+  scene->max_substeps = max_substeps;
+  scene->accumulator = 0;
+}
+
+size_t scene_advance(scene_t *scene, double dt) {
+  if (scene->fixed_step == 0) {
+    scene_tick(scene, dt);
+    return 1;
+  }
+
+  scene->accumulator += dt;
+  size_t steps = 0;
+  while (scene->accumulator >= scene->fixed_step &&
+         steps < scene->max_substeps) {
+    size_t num_bodies = list_size(scene->bodies);
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_save_transform(list_get(scene->bodies, i));
+    }
+    scene_tick(scene, scene->fixed_step);
+    scene->accumulator -= scene->fixed_step;
+    steps++;
+  }
+  // After a slow frame, drop the time we could not catch up on instead of
+  // making the next frame slower still
+  if (scene->accumulator >= scene->fixed_step) {
+    scene->accumulator = fmod(scene->accumulator, scene->fixed_step);
+  }
+  return steps;
+}
+
+double scene_get_interpolation(scene_t *scene) {
+  if (scene->fixed_step == 0) {
+    return 1;
+  }
+  return scene->accumulator / scene->fixed_step;
+}
+
+void scene_enable_sleeping(scene_t *scene, double max_speed,
+                           double delay) {
+  assert(max_speed >= 0);
+  assert(delay >= 0);
+
+  scene->sleeping_enabled = true;
+  scene->sleep_speed = max_speed;
+  scene->sleep_delay = delay;
+}
+
+void scene_disable_sleeping(scene_t *scene) {
+  scene->sleeping_enabled = false;
+  size_t num_bodies = list_size(scene->bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_wake(list_get(scene->bodies, i));
+  }
+}
+
+/**
+ * Grows a snapshot's array so it can hold at least needed elements.
+ * The old contents are not kept, since every snapshot overwrites them.
+ */
+void *snapshot_reserve(void *array, size_t *capacity, size_t needed,
+                       size_t elem_size) {
+  if (needed <= *capacity) {
+    return array;
+  }
+  size_t new_capacity = *capacity == 0 ? 8 : *capacity;
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  free(array);
+  array = malloc(elem_size * new_capacity);
+  assert(array != NULL);
+  *capacity = new_capacity;
+  return array;
+}
+
+scene_snapshot_t *scene_snapshot_init(scene_t *scene) {
+  scene_snapshot_t *snapshot = calloc(1, sizeof(scene_snapshot_t));
+  assert(snapshot != NULL);
+  snapshot->scene = scene;
+  snapshot->slots = slot_map_init(INIT_BODY_CAPACITY);
+  list_add(scene->snapshots, snapshot);
+  return snapshot;
+}
+
+void scene_snapshot_free(scene_snapshot_t *snapshot) {
+  scene_t *scene = snapshot->scene;
+  if (scene != NULL) {
+    size_t num_snapshots = list_size(scene->snapshots);
+    for (size_t i = 0; i < num_snapshots; i++) {
+      if (list_get(scene->snapshots, i) == snapshot) {
+        list_remove(scene->snapshots, i);
+        break;
+      }
+    }
+    scene_collect_retained(scene);
+  }
+  free(snapshot->bodies);
+  free(snapshot->handles);
+  free(snapshot->body_states);
+  slot_map_free(snapshot->slots);
+  free(snapshot->forces);
+  free(snapshot->last_ticks);
+  free(snapshot->group_sizes);
+  free(snapshot->group_bodies);
+  free(snapshot->force_states);
+  free(snapshot->records);
+  free(snapshot->batch_sizes);
+  free(snapshot->active_contacts);
+  free(snapshot->collision_pairs);
+  free(snapshot);
+}
+
+/**
+ * Saves a scene's bodies and their handles into a snapshot.
+ */
+void scene_snapshot_bodies(scene_t *scene, scene_snapshot_t *snapshot) {
+  size_t num_bodies = list_size(scene->bodies);
+  size_t capacity = snapshot->bodies_capacity;
+  snapshot->bodies = snapshot_reserve(snapshot->bodies, &capacity,
+                                      num_bodies, sizeof(body_t *));
+  capacity = snapshot->bodies_capacity;
+  snapshot->handles = snapshot_reserve(snapshot->handles, &capacity,
+                                       num_bodies, sizeof(body_handle_t));
+  capacity = snapshot->bodies_capacity;
+  snapshot->body_states = snapshot_reserve(snapshot->body_states, &capacity,
+                                           num_bodies, sizeof(body_state_t));
+  snapshot->bodies_capacity = capacity;
+  memcpy(snapshot->handles, scene->handles, sizeof(body_handle_t) * num_bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
     body_t *body = list_get(scene->bodies, i);
-    if (body_is_removed(body) == true) {
-      body_t *body_remove = list_remove(scene->bodies, i);
-      body_free(body_remove);
-    } else {
-      body_tick(body, dt);
-      i++;
+    snapshot->bodies[i] = body;
+    body_save_state(body, &snapshot->body_states[i]);
+  }
+  snapshot->num_bodies = num_bodies;
+  slot_map_copy(snapshot->slots, scene->slots);
+}
+
+/**
+ * Saves a scene's forces, the bodies of its group forces and the states
+ * from scene_add_force_state() into a snapshot.
+ */
+void scene_snapshot_forces(scene_t *scene, scene_snapshot_t *snapshot) {
+  size_t num_forces = list_size(scene->forces);
+  size_t capacity = snapshot->forces_capacity;
+  snapshot->forces = snapshot_reserve(snapshot->forces, &capacity,
+                                      num_forces, sizeof(force_t *));
+  capacity = snapshot->forces_capacity;
+  snapshot->last_ticks = snapshot_reserve(snapshot->last_ticks, &capacity,
+                                          num_forces, sizeof(size_t));
+  capacity = snapshot->forces_capacity;
+  snapshot->group_sizes = snapshot_reserve(snapshot->group_sizes, &capacity,
+                                           num_forces, sizeof(size_t));
+  snapshot->forces_capacity = capacity;
+
+  size_t num_group_bodies = 0;
+  size_t states_size = 0;
+  for (size_t i = 0; i < num_forces; i++) {
+    force_t *force = list_get(scene->forces, i);
+    snapshot->forces[i] = force;
+    snapshot->last_ticks[i] = force->last_tick;
+    snapshot->group_sizes[i] = force->is_group ? list_size(force->bodies) : 0;
+    num_group_bodies += snapshot->group_sizes[i];
+    states_size += force->state_size;
+  }
+  snapshot->num_forces = num_forces;
+
+  snapshot->group_bodies =
+      snapshot_reserve(snapshot->group_bodies,
+                       &snapshot->group_bodies_capacity, num_group_bodies,
+                       sizeof(body_t *));
+  snapshot->force_states =
+      snapshot_reserve(snapshot->force_states,
+                       &snapshot->force_states_capacity, states_size, 1);
+  body_t **group_body = snapshot->group_bodies;
+  char *state = snapshot->force_states;
+  for (size_t i = 0; i < num_forces; i++) {
+    force_t *force = snapshot->forces[i];
+    for (size_t j = 0; j < snapshot->group_sizes[i]; j++) {
+      *group_body++ = list_get(force->bodies, j);
+    }
+    if (force->state_size != 0) {
+      memcpy(state, force->state, force->state_size);
+      state += force->state_size;
     }
   }
+  snapshot->force_states_size = states_size;
+}
+
+/**
+ * Saves the records of a scene's force batches into a snapshot.
+ */
+void scene_snapshot_records(scene_t *scene, scene_snapshot_t *snapshot) {
+  size_t num_batches = list_size(scene->force_batches);
+  snapshot->batch_sizes =
+      snapshot_reserve(snapshot->batch_sizes, &snapshot->batches_capacity,
+                       num_batches, sizeof(size_t));
+  size_t num_records = 0;
+  for (size_t i = 0; i < num_batches; i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    snapshot->batch_sizes[i] = batch->num_records;
+    num_records += batch->num_records;
+  }
+  snapshot->num_batches = num_batches;
+
+  snapshot->records =
+      snapshot_reserve(snapshot->records, &snapshot->records_capacity,
+                       num_records, sizeof(force_record_t));
+  force_record_t *record = snapshot->records;
+  for (size_t i = 0; i < num_batches; i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    memcpy(record, batch->records, sizeof(force_record_t) * batch->num_records);
+    record += batch->num_records;
+  }
+}
+
+void scene_snapshot(scene_t *scene, scene_snapshot_t *snapshot) {
+  assert(snapshot->scene == scene);
 
-  // loops through forces, if marked for removal, removes it
-  size_t j = 0;
-  while (j < list_size(scene->forces)) {
-    force_t *force = list_get(scene->forces, j);
-    if (force_is_removed(force) == true) {
-      scene_remove_force(scene, j);
+  snapshot->epoch = ++scene->epoch;
+  snapshot->tick = scene->tick;
+  snapshot->tick_dt = scene->tick_dt;
+  snapshot->accumulator = scene->accumulator;
+  snapshot->forces_added = scene->forces_added;
+  snapshot->records_added = scene->records_added;
+  scene_snapshot_bodies(scene, snapshot);
+  scene_snapshot_forces(scene, snapshot);
+  scene_snapshot_records(scene, snapshot);
+
+  size_t num_active = list_size(scene->active_contacts);
+  snapshot->active_contacts = snapshot_reserve(
+      snapshot->active_contacts, &snapshot->active_contacts_capacity,
+      num_active, sizeof(force_t *));
+  for (size_t i = 0; i < num_active; i++) {
+    snapshot->active_contacts[i] = list_get(scene->active_contacts, i);
+  }
+  snapshot->num_active_contacts = num_active;
+
+  size_t num_pairs = list_size(scene->collision_pair_list);
+  snapshot->collision_pairs = snapshot_reserve(
+      snapshot->collision_pairs, &snapshot->collision_pairs_capacity,
+      num_pairs, sizeof(collision_pair_t));
+  for (size_t i = 0; i < num_pairs; i++) {
+    collision_pair_t *pair = list_get(scene->collision_pair_list, i);
+    snapshot->collision_pairs[i] = *pair;
+  }
+  snapshot->num_collision_pairs = num_pairs;
+
+  // What the snapshot held before may have been the last use of some
+  // retained bodies and forces
+  scene_collect_retained(scene);
+}
+
+/**
+ * Passed to list_filter() on the scene's collision pairs.
+ * Keeps the first *aux pairs, counting down as it goes.
+ */
+bool scene_keep_first_pairs(void *pair, void *aux) {
+  size_t *remaining = aux;
+  if (*remaining == 0) {
+    return false;
+  }
+  (*remaining)--;
+  return true;
+}
+
+/**
+ * Replaces a scene's collision pairs with a snapshot's, reusing the
+ * existing pairs' memory.
+ */
+void scene_restore_collision_pairs(scene_t *scene,
+                                   scene_snapshot_t *snapshot) {
+  list_t *pairs = scene->collision_pair_list;
+  size_t num_pairs = list_size(pairs);
+  for (size_t i = 0; i < num_pairs; i++) {
+    collision_pair_t *pair = list_get(pairs, i);
+    pair_table_remove(scene->collision_pairs, pair->body1, pair->body2);
+  }
+  size_t keep = snapshot->num_collision_pairs;
+  list_filter(pairs, scene_keep_first_pairs, &keep);
+
+  for (size_t i = 0; i < snapshot->num_collision_pairs; i++) {
+    collision_pair_t *pair;
+    if (i < list_size(pairs)) {
+      pair = list_get(pairs, i);
     } else {
-      j++;
+      pair = malloc(sizeof(collision_pair_t));
+      assert(pair != NULL);
+      list_add(pairs, pair);
+    }
+    *pair = snapshot->collision_pairs[i];
+    pair_table_put(scene->collision_pairs, pair->body1, pair->body2, pair);
+  }
+}
+
+/**
+ * Passed to list_filter() on a scene's retained bodies and forces with the
+ * table of what a snapshot refers to. Takes those back into the scene,
+ * adding bodies back to its store.
+ */
+typedef struct restore_filter {
+  scene_t *scene;
+  pair_table_t *saved;
+} restore_filter_t;
+
+bool scene_keep_unrestored(void *retained, void *aux) {
+  restore_filter_t *filter = aux;
+  retained_t *entry = retained;
+  void *value = entry->body != NULL ? (void *)entry->body : entry->force;
+  if (pair_table_get(filter->saved, value, value) == NULL) {
+    return true;
+  }
+  if (entry->body != NULL && filter->scene->store != NULL) {
+    body_store_attach(filter->scene->store, entry->body);
+  }
+  free(entry);
+  return false;
+}
+
+/**
+ * Puts back a snapshot's bodies in order, with their handles and states,
+ * releasing the bodies it does not refer to.
+ */
+void scene_restore_bodies(scene_t *scene, scene_snapshot_t *snapshot,
+                          pair_table_t *saved) {
+  // Bodies kept from before the restore keep their tree proxies, so the tree
+  // only changes for the bodies that come and go
+  pair_table_t *proxies = NULL;
+  if (scene->tree != NULL) {
+    proxies = pair_table_init(list_size(scene->bodies) + 1, NULL);
+  }
+  while (list_size(scene->bodies) != 0) {
+    size_t last = list_size(scene->bodies) - 1;
+    body_t *body = list_remove(scene->bodies, last);
+    size_t *proxy =
+        scene->tree != NULL ? list_remove(scene->proxies, last) : NULL;
+    if (pair_table_get(saved, body, body) != NULL) {
+      if (proxy != NULL) {
+        pair_table_put(proxies, body, body, proxy);
+      }
+      continue;
+    }
+    if (proxy != NULL) {
+      aabb_tree_remove(scene->tree, *proxy);
+      free(proxy);
+    }
+    scene_release_body(scene, body);
+  }
+
+  if (snapshot->num_bodies > scene->handles_capacity) {
+    scene->handles_capacity = snapshot->num_bodies;
+    scene->handles = realloc(scene->handles, sizeof(body_handle_t) *
+                                                 scene->handles_capacity);
+    assert(scene->handles != NULL);
+  }
+  memcpy(scene->handles, snapshot->handles,
+         sizeof(body_handle_t) * snapshot->num_bodies);
+  slot_map_copy(scene->slots, snapshot->slots);
+  for (size_t i = 0; i < snapshot->num_bodies; i++) {
+    body_t *body = snapshot->bodies[i];
+    list_add(scene->bodies, body);
+    body_restore_state(body, &snapshot->body_states[i]);
+    if (scene->tree != NULL) {
+      size_t *proxy = pair_table_get(proxies, body, body);
+      if (proxy != NULL) {
+        list_add(scene->proxies, proxy);
+      } else {
+        scene_insert_tree_proxy(scene, body);
+      }
     }
   }
-}
\ No newline at end of file
+  if (proxies != NULL) {
+    pair_table_free(proxies);
+  }
+}
+
+/**
+ * Puts back a snapshot's forces in order, with their bodies and states,
+ * releasing the forces it does not refer to, and indexes them again.
+ */
+void scene_restore_forces(scene_t *scene, scene_snapshot_t *snapshot,
+                          pair_table_t *saved) {
+  while (list_size(scene->forces) != 0) {
+    force_t *force = list_remove(scene->forces, list_size(scene->forces) - 1);
+    if (pair_table_get(saved, force, force) == NULL) {
+      scene_release_force(scene, force);
+    }
+  }
+  pair_table_free(scene->contact_forces);
+  pair_table_free(scene->body_forces);
+  scene->contact_forces =
+      pair_table_init(INIT_FORCE_CAPACITY, (free_func_t)list_free);
+  scene->body_forces =
+      pair_table_init(INIT_BODY_CAPACITY, (free_func_t)list_free);
+
+  body_t **group_body = snapshot->group_bodies;
+  char *state = snapshot->force_states;
+  for (size_t i = 0; i < snapshot->num_forces; i++) {
+    force_t *force = snapshot->forces[i];
+    force->mark_removal = false;
+    force->prune_bodies = false;
+    force->last_tick = snapshot->last_ticks[i];
+    if (force->is_group) {
+      while (list_size(force->bodies) != 0) {
+        list_remove(force->bodies, list_size(force->bodies) - 1);
+      }
+      for (size_t j = 0; j < snapshot->group_sizes[i]; j++) {
+        list_add(force->bodies, *group_body++);
+      }
+    }
+    if (force->state_size != 0) {
+      memcpy(force->state, state, force->state_size);
+      state += force->state_size;
+    }
+    list_add(scene->forces, force);
+    scene_index_force(scene, force);
+    if (force->is_contact) {
+      scene_index_contact(scene, force);
+    }
+  }
+}
+
+/**
+ * Puts back the records of a snapshot's force batches and indexes them by
+ * their bodies again. Batches started since the snapshot are left empty.
+ */
+void scene_restore_records(scene_t *scene, scene_snapshot_t *snapshot) {
+  pair_table_free(scene->body_records);
+  scene->body_records =
+      pair_table_init(INIT_BODY_CAPACITY, (free_func_t)list_free);
+
+  force_record_t *record = snapshot->records;
+  size_t num_batches = list_size(scene->force_batches);
+  for (size_t i = 0; i < num_batches; i++) {
+    force_batch_t *batch = list_get(scene->force_batches, i);
+    for (size_t j = 0; j < batch->num_records; j++) {
+      free(batch->refs[j]);
+    }
+    batch->num_records = 0;
+    size_t num_records =
+        i < snapshot->num_batches ? snapshot->batch_sizes[i] : 0;
+    for (size_t j = 0; j < num_records; j++) {
+      scene_push_record(scene, batch, *record++);
+    }
+  }
+}
+
+void scene_restore(scene_t *scene, scene_snapshot_t *snapshot) {
+  assert(snapshot->scene == scene);
+  assert(snapshot->epoch != 0);
+
+  // Everything the snapshot refers to, so the rest can be released
+  pair_table_t *saved =
+      pair_table_init(snapshot->num_bodies + snapshot->num_forces + 1, NULL);
+  for (size_t i = 0; i < snapshot->num_bodies; i++) {
+    body_t *body = snapshot->bodies[i];
+    pair_table_put(saved, body, body, body);
+  }
+  for (size_t i = 0; i < snapshot->num_forces; i++) {
+    force_t *force = snapshot->forces[i];
+    pair_table_put(saved, force, force, force);
+  }
+  restore_filter_t filter = {scene, saved};
+  list_filter(scene->retained, scene_keep_unrestored, &filter);
+
+  scene_restore_forces(scene, snapshot, saved);
+  scene_restore_bodies(scene, snapshot, saved);
+  scene_restore_records(scene, snapshot);
+  pair_table_free(saved);
+
+  while (list_size(scene->active_contacts) != 0) {
+    list_remove(scene->active_contacts, list_size(scene->active_contacts) - 1);
+  }
+  for (size_t i = 0; i < snapshot->num_active_contacts; i++) {
+    list_add(scene->active_contacts, snapshot->active_contacts[i]);
+  }
+  scene_restore_collision_pairs(scene, snapshot);
+
+  scene->tick = snapshot->tick;
+  scene->tick_dt = snapshot->tick_dt;
+  scene->accumulator = snapshot->accumulator;
+  scene->forces_added = snapshot->forces_added;
+  scene->records_added = snapshot->records_added;
+  scene->schedule_dirty = true;
+}
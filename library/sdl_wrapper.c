@@ -46,15 +46,26 @@ clock_t last_clock = 0;
 
 TTF_Font *sans;
 
+/**
+ * Scratch arrays of screen coordinates reused by every sdl_draw_vertices()
+ * call, grown as needed so drawing a frame does not allocate per polygon.
+ */
+int16_t *x_points = NULL;
+int16_t *y_points = NULL;
+size_t points_capacity = 0;
+
+/**
+ * Scratch array of scene coordinates that sdl_render_scene() moves a body's
+ * vertices into when drawing it between two physics steps.
+ */
+vector_t *moved_vertices = NULL;
+size_t moved_capacity = 0;
+
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -201,9 +212,9 @@ void display_clock(size_t countdown) {
   draw_text(20, 10, 0, 50, 25, timer_text);
 }
 
-void sdl_draw_polygon(list_t *points, rgb_color_t color) {
+void sdl_draw_vertices(const vector_t *vertices, size_t n,
+                       rgb_color_t color) {
   // Check parameters
-  size_t n = list_size(points);
   assert(n >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
@@ -211,14 +222,18 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
 
   vector_t window_center = get_window_center();
 
+  // Grow the scratch arrays if this polygon does not fit
+  if (n > points_capacity) {
+    x_points = realloc(x_points, sizeof(*x_points) * n);
+    y_points = realloc(y_points, sizeof(*y_points) * n);
+    assert(x_points != NULL);
+    assert(y_points != NULL);
+    points_capacity = n;
+  }
+
   // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
+    vector_t pixel = get_window_position(vertices[i], window_center);
     x_points[i] = pixel.x;
     y_points[i] = pixel.y;
   }
@@ -226,8 +241,26 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   // Draw polygon with the given color
   filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
                     color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+}
+
+void sdl_draw_circle(vector_t center, double radius, rgb_color_t color) {
+  assert(radius > 0);
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+
+  // SDL2_gfx rasterizes the circle itself, so no vertices are computed
+  vector_t window_center = get_window_center();
+  vector_t pixel = get_window_position(center, window_center);
+  double pixel_radius = round(radius * get_scene_scale(window_center));
+  filledCircleRGBA(renderer, pixel.x, pixel.y, fmax(pixel_radius, 1),
+                   color.r * 255, color.g * 255, color.b * 255, 255);
+}
+
+void sdl_draw_polygon(list_t *points, rgb_color_t color) {
+  polygon_t *polygon = polygon_from_list(points);
+  sdl_draw_vertices(polygon_vertices(polygon), polygon_size(polygon), color);
+  polygon_free(polygon);
 }
 
 void sdl_show(void) {
@@ -251,11 +284,36 @@ void sdl_show(void) {
 
 void sdl_render_scene(scene_t *scene) {
   sdl_clear();
+  double alpha = scene_get_interpolation(scene);
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, body_get_color(body));
+    vector_t centroid = body_get_interpolated_centroid(body, alpha);
+    if (body_is_circle(body)) {
+      sdl_draw_circle(centroid, body_get_radius(body), body_get_color(body));
+      continue;
+    }
+    polygon_view_t shape = body_view_shape(body);
+    vector_t offset = vec_subtract(centroid, body_get_centroid(body));
+    double turn =
+        body_get_interpolated_rotation(body, alpha) - body_get_rotation(body);
+    if (offset.x == 0 && offset.y == 0 && turn == 0) {
+      sdl_draw_vertices(shape.vertices, shape.size, body_get_color(body));
+      continue;
+    }
+
+    // Moves the current vertices back to where the body is drawn
+    if (shape.size > moved_capacity) {
+      moved_vertices =
+          realloc(moved_vertices, sizeof(*moved_vertices) * shape.size);
+      assert(moved_vertices != NULL);
+      moved_capacity = shape.size;
+    }
+    for (size_t j = 0; j < shape.size; j++) {
+      moved_vertices[j] = vec_add(shape.vertices[j], offset);
+    }
+    vertices_rotate(moved_vertices, shape.size, turn, centroid);
+    sdl_draw_vertices(moved_vertices, shape.size, body_get_color(body));
   }
   sdl_show();
 }
@@ -271,4 +329,9 @@ double time_since_last_tick(void) {
   return difference;
 }
 
-void sdl_quit(void) { SDL_Quit(); }
\ No newline at end of file
+void sdl_quit(void) {
+  free(x_points);
+  free(moved_vertices);
+  free(y_points);
+  SDL_Quit();
+}
\ No newline at end of file
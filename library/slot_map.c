@@ -0,0 +1,118 @@
+#include "slot_map.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Marks the end of the chain of free slots.
+ */
+const size_t SLOT_NO_FREE = SIZE_MAX;
+
+/**
+ * A slot holds a value while it is in use. Free slots form a chain through
+ * next_free instead, most recently freed first.
+ * The generation is odd exactly while the slot holds a value, so the zero
+ * handle never matches a slot.
+ */
+typedef struct slot {
+  void *value;
+  size_t generation;
+  size_t next_free;
+} slot_t;
+
+struct slot_map {
+  slot_t *slots;
+  size_t num_slots;
+  size_t capacity;
+  size_t first_free;
+  size_t size;
+};
+
+slot_map_t *slot_map_init(size_t initial_size) {
+  slot_map_t *map = malloc(sizeof(slot_map_t));
+  assert(map != NULL);
+  map->capacity = initial_size == 0 ? 1 : initial_size;
+  map->slots = malloc(sizeof(slot_t) * map->capacity);
+  assert(map->slots != NULL);
+  map->num_slots = 0;
+  map->first_free = SLOT_NO_FREE;
+  map->size = 0;
+  return map;
+}
+
+void slot_map_free(slot_map_t *map) {
+  free(map->slots);
+  free(map);
+}
+
+size_t slot_map_size(slot_map_t *map) { return map->size; }
+
+slot_handle_t slot_map_insert(slot_map_t *map, void *value) {
+  assert(value != NULL);
+
+  size_t index = map->first_free;
+  if (index != SLOT_NO_FREE) {
+    map->first_free = map->slots[index].next_free;
+  } else {
+    if (map->num_slots == map->capacity) {
+      map->capacity *= 2;
+      map->slots = realloc(map->slots, sizeof(slot_t) * map->capacity);
+      assert(map->slots != NULL);
+    }
+    index = map->num_slots++;
+    map->slots[index].generation = 0;
+  }
+
+  slot_t *slot = &map->slots[index];
+  slot->value = value;
+  slot->generation++;
+  map->size++;
+  return (slot_handle_t){index, slot->generation};
+}
+
+/**
+ * Returns the slot a handle refers to, or NULL if the handle is stale.
+ */
+slot_t *slot_map_find(slot_map_t *map, slot_handle_t handle) {
+  if (handle.index >= map->num_slots) {
+    return NULL;
+  }
+  slot_t *slot = &map->slots[handle.index];
+  return slot->generation == handle.generation && handle.generation % 2 == 1
+             ? slot
+             : NULL;
+}
+
+void *slot_map_get(slot_map_t *map, slot_handle_t handle) {
+  slot_t *slot = slot_map_find(map, handle);
+  return slot == NULL ? NULL : slot->value;
+}
+
+void *slot_map_remove(slot_map_t *map, slot_handle_t handle) {
+  slot_t *slot = slot_map_find(map, handle);
+  if (slot == NULL) {
+    return NULL;
+  }
+  void *value = slot->value;
+  slot->value = NULL;
+  slot->generation++;
+  slot->next_free = map->first_free;
+  map->first_free = handle.index;
+  map->size--;
+  return value;
+}
+
+void slot_map_copy(slot_map_t *dest, slot_map_t *src) {
+  if (dest->capacity < src->num_slots) {
+    free(dest->slots);
+    dest->capacity = src->capacity;
+    dest->slots = malloc(sizeof(slot_t) * dest->capacity);
+    assert(dest->slots != NULL);
+  }
+  memcpy(dest->slots, src->slots, sizeof(slot_t) * src->num_slots);
+  dest->num_slots = src->num_slots;
+  dest->first_free = src->first_free;
+  dest->size = src->size;
+}
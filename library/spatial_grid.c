@@ -0,0 +1,322 @@
+#include "spatial_grid.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The number of cell slots a grid starts with. Must be a power of 2.
+ */
+const size_t GRID_INITIAL_CELLS = 64;
+
+/**
+ * Boxes touching more cells than this are not inserted into the cells,
+ * but compared against every other box (e.g. a border spanning the window).
+ */
+const size_t GRID_MAX_CELLS_PER_BOX = 256;
+
+/**
+ * Marks the end of a cell's chain of entries.
+ */
+const size_t GRID_NO_ENTRY = SIZE_MAX;
+
+typedef struct grid_box {
+  size_t id;
+  aabb_t bounds;
+  bool oversized;
+} grid_box_t;
+
+/**
+ * One box's membership in one cell.
+ * Entries in the same cell form a singly linked chain through next.
+ */
+typedef struct grid_entry {
+  size_t box;
+  size_t next;
+} grid_entry_t;
+
+typedef struct grid_cell {
+  int64_t x;
+  int64_t y;
+  size_t head;
+  bool occupied;
+} grid_cell_t;
+
+struct spatial_grid {
+  double cell_size;
+
+  grid_box_t *boxes;
+  size_t num_boxes;
+  size_t boxes_capacity;
+
+  grid_entry_t *entries;
+  size_t num_entries;
+  size_t entries_capacity;
+
+  // Open-addressed hash table of cells, kept at most half full
+  grid_cell_t *cells;
+  size_t num_cells;
+  // Indices into cells of the occupied cells, in the order they were filled
+  size_t *occupied;
+  size_t num_occupied;
+
+  // Indices into boxes of boxes too large to insert into cells
+  size_t *oversized;
+  size_t num_oversized;
+  size_t oversized_capacity;
+};
+
+/**
+ * Grows a dynamic array so it can hold at least needed elements.
+ */
+void *grid_reserve(void *array, size_t *capacity, size_t needed,
+                   size_t elem_size) {
+  if (needed <= *capacity) {
+    return array;
+  }
+  size_t new_capacity = *capacity == 0 ? 8 : *capacity;
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  array = realloc(array, elem_size * new_capacity);
+  assert(array != NULL);
+  *capacity = new_capacity;
+  return array;
+}
+
+spatial_grid_t *spatial_grid_init(double cell_size) {
+  assert(cell_size > 0);
+
+  spatial_grid_t *grid = malloc(sizeof(spatial_grid_t));
+  assert(grid != NULL);
+  grid->cell_size = cell_size;
+  grid->boxes = NULL;
+  grid->num_boxes = 0;
+  grid->boxes_capacity = 0;
+  grid->entries = NULL;
+  grid->num_entries = 0;
+  grid->entries_capacity = 0;
+  grid->cells = calloc(GRID_INITIAL_CELLS, sizeof(grid_cell_t));
+  assert(grid->cells != NULL);
+  grid->num_cells = GRID_INITIAL_CELLS;
+  grid->occupied = malloc(sizeof(size_t) * GRID_INITIAL_CELLS);
+  assert(grid->occupied != NULL);
+  grid->num_occupied = 0;
+  grid->oversized = NULL;
+  grid->num_oversized = 0;
+  grid->oversized_capacity = 0;
+  return grid;
+}
+
+void spatial_grid_free(spatial_grid_t *grid) {
+  free(grid->boxes);
+  free(grid->entries);
+  free(grid->cells);
+  free(grid->occupied);
+  free(grid->oversized);
+  free(grid);
+}
+
+void spatial_grid_clear(spatial_grid_t *grid) {
+  for (size_t i = 0; i < grid->num_occupied; ++i) {
+    grid->cells[grid->occupied[i]].occupied = false;
+  }
+  grid->num_occupied = 0;
+  grid->num_boxes = 0;
+  grid->num_entries = 0;
+  grid->num_oversized = 0;
+}
+
+size_t spatial_grid_size(spatial_grid_t *grid) { return grid->num_boxes; }
+
+/**
+ * Converts a coordinate into the index of the cell row or column holding it.
+ */
+int64_t grid_coord(spatial_grid_t *grid, double coord) {
+  return (int64_t)floor(coord / grid->cell_size);
+}
+
+size_t grid_hash(spatial_grid_t *grid, int64_t x, int64_t y) {
+  uint64_t hash = (uint64_t)x * 0x9E3779B97F4A7C15ull;
+  hash ^= (uint64_t)y * 0xC2B2AE3D27D4EB4Full;
+  hash ^= hash >> 29;
+  return (size_t)hash & (grid->num_cells - 1);
+}
+
+/**
+ * Finds the slot holding a cell, or the empty slot where it would be added.
+ */
+size_t grid_find_cell(spatial_grid_t *grid, int64_t x, int64_t y) {
+  size_t index = grid_hash(grid, x, y);
+  while (grid->cells[index].occupied &&
+         (grid->cells[index].x != x || grid->cells[index].y != y)) {
+    index = (index + 1) & (grid->num_cells - 1);
+  }
+  return index;
+}
+
+/**
+ * Doubles the number of cell slots, moving every occupied cell.
+ * Cell chains are unaffected since entries live in their own array.
+ */
+void grid_grow_cells(spatial_grid_t *grid) {
+  grid_cell_t *old_cells = grid->cells;
+  size_t *old_occupied = grid->occupied;
+
+  grid->num_cells *= 2;
+  grid->cells = calloc(grid->num_cells, sizeof(grid_cell_t));
+  grid->occupied = malloc(sizeof(size_t) * grid->num_cells);
+  assert(grid->cells != NULL);
+  assert(grid->occupied != NULL);
+  for (size_t i = 0; i < grid->num_occupied; ++i) {
+    grid_cell_t cell = old_cells[old_occupied[i]];
+    size_t index = grid_find_cell(grid, cell.x, cell.y);
+    grid->cells[index] = cell;
+    grid->occupied[i] = index;
+  }
+  free(old_cells);
+  free(old_occupied);
+}
+
+/**
+ * Adds an entry for a box to the cell at (x, y), creating the cell if needed.
+ */
+void grid_add_entry(spatial_grid_t *grid, int64_t x, int64_t y, size_t box) {
+  size_t index = grid_find_cell(grid, x, y);
+  if (!grid->cells[index].occupied) {
+    if (2 * (grid->num_occupied + 1) > grid->num_cells) {
+      grid_grow_cells(grid);
+      index = grid_find_cell(grid, x, y);
+    }
+    grid->cells[index] = (grid_cell_t){x, y, GRID_NO_ENTRY, true};
+    grid->occupied[grid->num_occupied++] = index;
+  }
+
+  grid->entries = grid_reserve(grid->entries, &grid->entries_capacity,
+                               grid->num_entries + 1, sizeof(grid_entry_t));
+  grid->entries[grid->num_entries] =
+      (grid_entry_t){box, grid->cells[index].head};
+  grid->cells[index].head = grid->num_entries;
+  ++grid->num_entries;
+}
+
+void spatial_grid_insert(spatial_grid_t *grid, size_t id, aabb_t bounds) {
+  grid->boxes = grid_reserve(grid->boxes, &grid->boxes_capacity,
+                             grid->num_boxes + 1, sizeof(grid_box_t));
+  size_t box = grid->num_boxes++;
+  grid->boxes[box] = (grid_box_t){id, bounds, false};
+
+  double cells_x = floor(bounds.max.x / grid->cell_size) -
+                   floor(bounds.min.x / grid->cell_size) + 1;
+  double cells_y = floor(bounds.max.y / grid->cell_size) -
+                   floor(bounds.min.y / grid->cell_size) + 1;
+  if (!(cells_x * cells_y <= GRID_MAX_CELLS_PER_BOX)) {
+    grid->oversized =
+        grid_reserve(grid->oversized, &grid->oversized_capacity,
+                     grid->num_oversized + 1, sizeof(size_t));
+    grid->oversized[grid->num_oversized++] = box;
+    grid->boxes[box].oversized = true;
+    return;
+  }
+
+  int64_t max_x = grid_coord(grid, bounds.max.x);
+  int64_t max_y = grid_coord(grid, bounds.max.y);
+  for (int64_t x = grid_coord(grid, bounds.min.x); x <= max_x; ++x) {
+    for (int64_t y = grid_coord(grid, bounds.min.y); y <= max_y; ++y) {
+      grid_add_entry(grid, x, y, box);
+    }
+  }
+}
+
+/**
+ * Returns whether a cell is the one responsible for reporting an overlap
+ * between two boxes. Overlapping boxes may share several cells, so only the
+ * cell containing the minimum corner of their intersection reports them.
+ */
+bool grid_owns_overlap(spatial_grid_t *grid, grid_cell_t *cell,
+                       aabb_t bounds1, aabb_t bounds2) {
+  return grid_coord(grid, fmax(bounds1.min.x, bounds2.min.x)) == cell->x &&
+         grid_coord(grid, fmax(bounds1.min.y, bounds2.min.y)) == cell->y;
+}
+
+void spatial_grid_pairs(spatial_grid_t *grid, grid_pair_handler_t handler,
+                        void *aux) {
+  for (size_t i = 0; i < grid->num_occupied; ++i) {
+    grid_cell_t *cell = &grid->cells[grid->occupied[i]];
+    for (size_t e1 = cell->head; e1 != GRID_NO_ENTRY;
+         e1 = grid->entries[e1].next) {
+      grid_box_t *box1 = &grid->boxes[grid->entries[e1].box];
+      for (size_t e2 = grid->entries[e1].next; e2 != GRID_NO_ENTRY;
+           e2 = grid->entries[e2].next) {
+        grid_box_t *box2 = &grid->boxes[grid->entries[e2].box];
+        if (aabb_overlap(box1->bounds, box2->bounds) &&
+            grid_owns_overlap(grid, cell, box1->bounds, box2->bounds)) {
+          // Chains are built newest-first, so report the older box first
+          handler(box2->id, box1->id, aux);
+        }
+      }
+    }
+  }
+
+  // Oversized boxes are compared with every box inserted after them
+  // and with every non-oversized box inserted before them
+  for (size_t i = 0; i < grid->num_oversized; ++i) {
+    size_t big = grid->oversized[i];
+    for (size_t other = 0; other < grid->num_boxes; ++other) {
+      if (other == big || (other < big && grid->boxes[other].oversized)) {
+        continue;
+      }
+      if (aabb_overlap(grid->boxes[big].bounds, grid->boxes[other].bounds)) {
+        size_t first = big < other ? big : other;
+        size_t second = big < other ? other : big;
+        handler(grid->boxes[first].id, grid->boxes[second].id, aux);
+      }
+    }
+  }
+}
+
+void spatial_grid_query(spatial_grid_t *grid, aabb_t bounds,
+                        grid_query_handler_t handler, void *aux) {
+  double cells_x = floor(bounds.max.x / grid->cell_size) -
+                   floor(bounds.min.x / grid->cell_size) + 1;
+  double cells_y = floor(bounds.max.y / grid->cell_size) -
+                   floor(bounds.min.y / grid->cell_size) + 1;
+  bool scan_all = !(cells_x * cells_y <= GRID_MAX_CELLS_PER_BOX);
+
+  if (scan_all) {
+    for (size_t box = 0; box < grid->num_boxes; ++box) {
+      if (aabb_overlap(bounds, grid->boxes[box].bounds)) {
+        handler(grid->boxes[box].id, aux);
+      }
+    }
+    return;
+  }
+
+  int64_t max_x = grid_coord(grid, bounds.max.x);
+  int64_t max_y = grid_coord(grid, bounds.max.y);
+  for (int64_t x = grid_coord(grid, bounds.min.x); x <= max_x; ++x) {
+    for (int64_t y = grid_coord(grid, bounds.min.y); y <= max_y; ++y) {
+      size_t index = grid_find_cell(grid, x, y);
+      grid_cell_t *cell = &grid->cells[index];
+      if (!cell->occupied) {
+        continue;
+      }
+      for (size_t e = cell->head; e != GRID_NO_ENTRY;
+           e = grid->entries[e].next) {
+        grid_box_t *box = &grid->boxes[grid->entries[e].box];
+        if (aabb_overlap(bounds, box->bounds) &&
+            grid_owns_overlap(grid, cell, bounds, box->bounds)) {
+          handler(box->id, aux);
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < grid->num_oversized; ++i) {
+    grid_box_t *box = &grid->boxes[grid->oversized[i]];
+    if (aabb_overlap(bounds, box->bounds)) {
+      handler(box->id, aux);
+    }
+  }
+}
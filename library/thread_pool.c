@@ -0,0 +1,247 @@
+#include "thread_pool.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
+/**
+ * Runs a loop on the calling thread alone.
+ */
+void pool_run_serial(size_t count, size_t grain, pool_task_t task,
+                     void *aux) {
+  for (size_t start = 0; start < count; start += grain) {
+    size_t end = start + grain < count ? start + grain : count;
+    task(aux, start, end);
+  }
+}
+
+#ifdef __EMSCRIPTEN__
+
+struct thread_pool {
+  size_t num_threads;
+};
+
+thread_pool_t *thread_pool_init(size_t num_threads) {
+  assert(num_threads > 0);
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  assert(pool != NULL);
+  pool->num_threads = 1;
+  return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool) { free(pool); }
+
+size_t thread_pool_threads(thread_pool_t *pool) { return pool->num_threads; }
+
+void thread_pool_for(thread_pool_t *pool, size_t count, size_t grain,
+                     pool_task_t task, void *aux) {
+  assert(grain > 0);
+  pool_run_serial(count, grain, task, aux);
+}
+
+#else
+
+/**
+ * The chunks a thread has left to run, [head, tail).
+ * The owner takes chunks from the tail and thieves take them from the head,
+ * so the two only contend over the last chunk.
+ */
+typedef struct pool_deque {
+  pthread_mutex_t lock;
+  size_t head;
+  size_t tail;
+} pool_deque_t;
+
+typedef struct pool_worker {
+  thread_pool_t *pool;
+  size_t id;
+  pthread_t thread;
+} pool_worker_t;
+
+struct thread_pool {
+  size_t num_threads;
+  // Worker 0 is the thread calling thread_pool_for() and has no pthread
+  pool_worker_t *workers;
+  pool_deque_t *deques;
+
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  // Incremented for every loop, so waiting threads know a new one started
+  size_t loop;
+  // The number of threads still working on the current loop
+  size_t busy;
+  bool stopping;
+
+  // The current loop
+  size_t count;
+  size_t grain;
+  pool_task_t task;
+  void *aux;
+};
+
+/**
+ * Takes a chunk from the tail of a thread's own deque.
+ */
+bool pool_pop(pool_deque_t *deque, size_t *chunk) {
+  pthread_mutex_lock(&deque->lock);
+  bool found = deque->head < deque->tail;
+  if (found) {
+    *chunk = --deque->tail;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+/**
+ * Takes a chunk from the head of another thread's deque.
+ */
+bool pool_steal(pool_deque_t *deque, size_t *chunk) {
+  pthread_mutex_lock(&deque->lock);
+  bool found = deque->head < deque->tail;
+  if (found) {
+    *chunk = deque->head++;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+/**
+ * Runs chunks of the current loop until no thread has any left.
+ * No chunks are added during a loop, so once every deque is empty
+ * the thread is done.
+ */
+void pool_work(thread_pool_t *pool, size_t id) {
+  while (true) {
+    size_t chunk;
+    bool found = pool_pop(&pool->deques[id], &chunk);
+    for (size_t i = 1; !found && i < pool->num_threads; i++) {
+      found = pool_steal(&pool->deques[(id + i) % pool->num_threads], &chunk);
+    }
+    if (!found) {
+      return;
+    }
+    size_t start = chunk * pool->grain;
+    size_t end =
+        start + pool->grain < pool->count ? start + pool->grain : pool->count;
+    pool->task(pool->aux, start, end);
+  }
+}
+
+void *pool_thread(void *arg) {
+  pool_worker_t *worker = arg;
+  thread_pool_t *pool = worker->pool;
+  size_t seen_loop = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  while (true) {
+    while (!pool->stopping && pool->loop == seen_loop) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->stopping) {
+      break;
+    }
+    seen_loop = pool->loop;
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_work(pool, worker->id);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->busy == 0) {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+thread_pool_t *thread_pool_init(size_t num_threads) {
+  assert(num_threads > 0);
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  assert(pool != NULL);
+  pool->num_threads = num_threads;
+  pool->workers = malloc(sizeof(pool_worker_t) * num_threads);
+  pool->deques = malloc(sizeof(pool_deque_t) * num_threads);
+  assert(pool->workers != NULL);
+  assert(pool->deques != NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->loop = 0;
+  pool->busy = 0;
+  pool->stopping = false;
+
+  for (size_t i = 0; i < num_threads; i++) {
+    pthread_mutex_init(&pool->deques[i].lock, NULL);
+    pool->deques[i].head = 0;
+    pool->deques[i].tail = 0;
+    pool->workers[i].pool = pool;
+    pool->workers[i].id = i;
+    if (i != 0) {
+      int error = pthread_create(&pool->workers[i].thread, NULL, pool_thread,
+                                 &pool->workers[i]);
+      assert(error == 0);
+    }
+  }
+  return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    if (i != 0) {
+      pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_mutex_destroy(&pool->deques[i].lock);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  free(pool->workers);
+  free(pool->deques);
+  free(pool);
+}
+
+size_t thread_pool_threads(thread_pool_t *pool) { return pool->num_threads; }
+
+void thread_pool_for(thread_pool_t *pool, size_t count, size_t grain,
+                     pool_task_t task, void *aux) {
+  assert(grain > 0);
+  size_t num_chunks = (count + grain - 1) / grain;
+  if (pool->num_threads == 1 || num_chunks <= 1) {
+    pool_run_serial(count, grain, task, aux);
+    return;
+  }
+
+  // Deals out the chunks as evenly as possible, before any thread starts
+  pthread_mutex_lock(&pool->lock);
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    pool->deques[i].head = num_chunks * i / pool->num_threads;
+    pool->deques[i].tail = num_chunks * (i + 1) / pool->num_threads;
+  }
+  pool->count = count;
+  pool->grain = grain;
+  pool->task = task;
+  pool->aux = aux;
+  pool->busy = pool->num_threads - 1;
+  pool->loop++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  pool_work(pool, 0);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->busy != 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+#endif // #ifdef __EMSCRIPTEN__
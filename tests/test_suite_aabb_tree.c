@@ -0,0 +1,182 @@
+#include "aabb_tree.h"
+#include "test_util.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define BOXES 200
+
+/**
+ * The boxes in a test, identified by their index.
+ * The data stored in the tree for box i is &ids[i].
+ */
+typedef struct {
+  aabb_t boxes[BOXES];
+  size_t ids[BOXES];
+  size_t proxies[BOXES];
+  bool inserted[BOXES];
+  int counts[BOXES * BOXES];
+} tree_boxes_t;
+
+void count_tree_pair(void *data1, void *data2, void *aux) {
+  tree_boxes_t *boxes = aux;
+  size_t id1 = *(size_t *)data1, id2 = *(size_t *)data2;
+  assert(id1 != id2);
+  size_t low = id1 < id2 ? id1 : id2;
+  size_t high = id1 < id2 ? id2 : id1;
+  boxes->counts[low * BOXES + high]++;
+}
+
+void count_tree_hit(void *data, void *aux) {
+  ((tree_boxes_t *)aux)->counts[*(size_t *)data]++;
+}
+
+double random_between(double min, double max) {
+  return min + (double)rand() / RAND_MAX * (max - min);
+}
+
+/**
+ * Makes a random box. Most boxes are small, but a few span the whole area,
+ * like a scene with bullets and borders.
+ */
+aabb_t random_box(size_t i) {
+  double x = random_between(-100, 100), y = random_between(-100, 100);
+  double width = random_between(0.5, 10), height = random_between(0.5, 10);
+  if (i % 50 == 0) {
+    width = 200;
+  } else if (i % 50 == 1) {
+    height = 200;
+  }
+  return (aabb_t){{x, y}, {x + width, y + height}};
+}
+
+// Compares the pairs, queries and raycasts of a tree against brute force
+void check_tree(aabb_tree_t *tree, tree_boxes_t *boxes) {
+  for (size_t i = 0; i < BOXES * BOXES; i++) {
+    boxes->counts[i] = 0;
+  }
+  aabb_tree_pairs(tree, count_tree_pair, boxes);
+  for (size_t i = 0; i < BOXES; i++) {
+    for (size_t j = i + 1; j < BOXES; j++) {
+      bool expected = boxes->inserted[i] && boxes->inserted[j] &&
+                      aabb_overlap(boxes->boxes[i], boxes->boxes[j]);
+      assert(boxes->counts[i * BOXES + j] == (expected ? 1 : 0));
+    }
+  }
+
+  aabb_t query = {{-20, -20}, {20, 20}};
+  for (size_t i = 0; i < BOXES; i++) {
+    boxes->counts[i] = 0;
+  }
+  aabb_tree_query(tree, query, count_tree_hit, boxes);
+  for (size_t i = 0; i < BOXES; i++) {
+    bool expected = boxes->inserted[i] && aabb_overlap(query, boxes->boxes[i]);
+    assert(boxes->counts[i] == (expected ? 1 : 0));
+  }
+
+  vector_t start = {-120, -90}, end = {110, 70};
+  for (size_t i = 0; i < BOXES; i++) {
+    boxes->counts[i] = 0;
+  }
+  aabb_tree_raycast(tree, start, end, count_tree_hit, boxes);
+  for (size_t i = 0; i < BOXES; i++) {
+    bool expected = boxes->inserted[i] &&
+                    aabb_segment_overlap(boxes->boxes[i], start, end);
+    assert(boxes->counts[i] == (expected ? 1 : 0));
+  }
+}
+
+void test_tree_empty() {
+  aabb_tree_t *tree = aabb_tree_init(0);
+  assert(aabb_tree_size(tree) == 0);
+  aabb_tree_pairs(tree, count_tree_pair, NULL);
+  aabb_tree_query(tree, (aabb_t){{0, 0}, {1, 1}}, count_tree_hit, NULL);
+  aabb_tree_raycast(tree, (vector_t){0, 0}, (vector_t){1, 1}, count_tree_hit,
+                    NULL);
+  aabb_tree_free(tree);
+}
+
+void test_segment_overlap() {
+  aabb_t box = {{0, 0}, {2, 1}};
+  assert(aabb_segment_overlap(box, (vector_t){-1, 0.5}, (vector_t){3, 0.5}));
+  assert(aabb_segment_overlap(box, (vector_t){1, 0.5}, (vector_t){1, 0.5}));
+  assert(aabb_segment_overlap(box, (vector_t){-1, -1}, (vector_t){1, 1}));
+  // Stops short of the box
+  assert(!aabb_segment_overlap(box, (vector_t){-2, 0.5}, (vector_t){-1, 0.5}));
+  // The infinite line would hit the box, but the segment passes beside it
+  assert(!aabb_segment_overlap(box, (vector_t){3, 0}, (vector_t){4, 2}));
+  assert(!aabb_segment_overlap(box, (vector_t){-1, 2}, (vector_t){3, 2}));
+}
+
+void test_tree_insert_move_remove() {
+  tree_boxes_t *boxes = malloc(sizeof(*boxes));
+  aabb_tree_t *tree = aabb_tree_init(1);
+  for (size_t i = 0; i < BOXES; i++) {
+    boxes->ids[i] = i;
+    boxes->boxes[i] = random_box(i);
+    boxes->proxies[i] = aabb_tree_insert(tree, boxes->boxes[i], &boxes->ids[i]);
+    boxes->inserted[i] = true;
+  }
+  assert(aabb_tree_size(tree) == BOXES);
+  for (size_t i = 0; i < BOXES; i++) {
+    assert(aabb_tree_get_data(tree, boxes->proxies[i]) == &boxes->ids[i]);
+  }
+  check_tree(tree, boxes);
+
+  // Small moves stay within the fat boxes; large ones need reinserting
+  for (size_t i = 0; i < BOXES; i++) {
+    vector_t shift = {random_between(-0.5, 0.5), random_between(-0.5, 0.5)};
+    if (i % 3 == 0) {
+      shift = (vector_t){random_between(-50, 50), random_between(-50, 50)};
+    }
+    aabb_t moved = {vec_add(boxes->boxes[i].min, shift),
+                    vec_add(boxes->boxes[i].max, shift)};
+    bool reinserted = aabb_tree_move(tree, boxes->proxies[i], moved);
+    if (i % 3 != 0) {
+      assert(!reinserted);
+    }
+    boxes->boxes[i] = moved;
+  }
+  check_tree(tree, boxes);
+
+  // Remove every other box, then reinsert half of those
+  for (size_t i = 0; i < BOXES; i += 2) {
+    aabb_tree_remove(tree, boxes->proxies[i]);
+    boxes->inserted[i] = false;
+  }
+  assert(aabb_tree_size(tree) == BOXES / 2);
+  check_tree(tree, boxes);
+  for (size_t i = 0; i < BOXES; i += 4) {
+    boxes->proxies[i] = aabb_tree_insert(tree, boxes->boxes[i], &boxes->ids[i]);
+    boxes->inserted[i] = true;
+  }
+  check_tree(tree, boxes);
+
+  aabb_tree_free(tree);
+  free(boxes);
+}
+
+void tree_remove_invalid(void *tree) { aabb_tree_remove(tree, 12345); }
+
+void test_tree_invalid_proxy() {
+  aabb_tree_t *tree = aabb_tree_init(0);
+  assert(test_assert_fail(tree_remove_invalid, tree));
+  aabb_tree_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_tree_empty)
+  DO_TEST(test_segment_overlap)
+  DO_TEST(test_tree_insert_move_remove)
+  DO_TEST(test_tree_invalid_proxy)
+
+  puts("aabb_tree_test PASS");
+}
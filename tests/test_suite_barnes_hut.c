@@ -0,0 +1,165 @@
+#include "barnes_hut.h"
+#include "test_util.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * Sums the field of every point except self directly, for comparison.
+ */
+vector_t direct_field(vector_t *positions, double *masses, size_t count,
+                      vector_t position, size_t self, double min_dist) {
+  vector_t field = VEC_ZERO;
+  for (size_t i = 0; i < count; i++) {
+    vector_t offset = vec_subtract(positions[i], position);
+    double dist = vec_norm(offset);
+    if (i == self || dist < min_dist || dist == 0) {
+      continue;
+    }
+    field = vec_add(field, vec_multiply(masses[i] / pow(dist, 3), offset));
+  }
+  return field;
+}
+
+void random_points(vector_t *positions, double *masses, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    positions[i] = (vector_t){rand() % 10000 / 10.0, rand() % 10000 / 10.0};
+    masses[i] = 1 + rand() % 100;
+  }
+}
+
+void test_barnes_hut_empty() {
+  barnes_hut_t *tree = barnes_hut_init();
+  assert(barnes_hut_size(tree) == 0);
+  assert(vec_equal(barnes_hut_field(tree, VEC_ZERO, 0, 0.5, 0), VEC_ZERO));
+  barnes_hut_build(tree, NULL, NULL, 0);
+  assert(vec_equal(barnes_hut_field(tree, VEC_ZERO, 0, 0.5, 0), VEC_ZERO));
+  barnes_hut_free(tree);
+}
+
+void test_barnes_hut_two_points() {
+  vector_t positions[] = {{0, 0}, {3, 4}};
+  double masses[] = {2, 50};
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, 2);
+  assert(barnes_hut_size(tree) == 2);
+
+  // 50 / 5 ** 2 toward the second point
+  assert(vec_isclose(barnes_hut_field(tree, positions[0], 0, 0.5, 0),
+                     (vector_t){2 * 0.6, 2 * 0.8}));
+  assert(vec_isclose(barnes_hut_field(tree, positions[1], 1, 0.5, 0),
+                     (vector_t){-0.08 * 0.6, -0.08 * 0.8}));
+  // Points closer than the minimum distance are skipped
+  assert(vec_equal(barnes_hut_field(tree, positions[0], 0, 0.5, 6),
+                   VEC_ZERO));
+  // Leaving out no point, the field at a point ignores that point itself
+  assert(vec_isclose(barnes_hut_field(tree, positions[0], 2, 0.5, 0),
+                     (vector_t){2 * 0.6, 2 * 0.8}));
+  barnes_hut_free(tree);
+}
+
+// With an opening angle of 0, every node is opened, so the sum is exact
+void test_barnes_hut_exact() {
+  const size_t POINTS = 500;
+  vector_t *positions = malloc(sizeof(vector_t) * POINTS);
+  double *masses = malloc(sizeof(double) * POINTS);
+  random_points(positions, masses, POINTS);
+
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, POINTS);
+  for (size_t i = 0; i < POINTS; i++) {
+    vector_t expected = direct_field(positions, masses, POINTS, positions[i],
+                                     i, 5);
+    vector_t actual = barnes_hut_field(tree, positions[i], i, 0, 5);
+    assert(vec_within(1e-9, actual, expected));
+  }
+  barnes_hut_free(tree);
+  free(positions);
+  free(masses);
+}
+
+// A small opening angle gives a close approximation of the exact sums.
+// Single fields can nearly cancel out, so the errors are compared in total.
+void test_barnes_hut_approximate() {
+  const size_t POINTS = 2000;
+  vector_t *positions = malloc(sizeof(vector_t) * POINTS);
+  double *masses = malloc(sizeof(double) * POINTS);
+  random_points(positions, masses, POINTS);
+
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, POINTS);
+  double total_error = 0, total_field = 0;
+  for (size_t i = 0; i < POINTS; i += 7) {
+    vector_t expected = direct_field(positions, masses, POINTS, positions[i],
+                                     i, 5);
+    vector_t actual = barnes_hut_field(tree, positions[i], i, 0.3, 5);
+    total_error += vec_norm(vec_subtract(actual, expected));
+    total_field += vec_norm(expected);
+  }
+  assert(total_error < 0.01 * total_field);
+  barnes_hut_free(tree);
+  free(positions);
+  free(masses);
+}
+
+// Many points at the same position must not split the tree forever
+void test_barnes_hut_coincident() {
+  const size_t POINTS = 100;
+  vector_t positions[POINTS + 1];
+  double masses[POINTS + 1];
+  for (size_t i = 0; i < POINTS; i++) {
+    positions[i] = (vector_t){1, 1};
+    masses[i] = 1;
+  }
+  positions[POINTS] = (vector_t){11, 1};
+  masses[POINTS] = 1;
+
+  barnes_hut_t *tree = barnes_hut_init();
+  barnes_hut_build(tree, positions, masses, POINTS + 1);
+  assert(vec_isclose(barnes_hut_field(tree, positions[POINTS], POINTS, 0.5, 0),
+                     (vector_t){-1, 0}));
+  assert(vec_isclose(barnes_hut_field(tree, positions[0], 0, 0.5, 0),
+                     (vector_t){0.01, 0}));
+  barnes_hut_free(tree);
+}
+
+// Rebuilding replaces the old points, including with fewer points
+void test_barnes_hut_rebuild() {
+  const size_t POINTS = 300;
+  vector_t *positions = malloc(sizeof(vector_t) * POINTS);
+  double *masses = malloc(sizeof(double) * POINTS);
+  barnes_hut_t *tree = barnes_hut_init();
+  for (size_t count = POINTS; count > 0; count /= 3) {
+    random_points(positions, masses, count);
+    barnes_hut_build(tree, positions, masses, count);
+    assert(barnes_hut_size(tree) == count);
+    vector_t probe = {-100, 500};
+    vector_t expected =
+        direct_field(positions, masses, count, probe, count, 0);
+    assert(vec_within(1e-9, barnes_hut_field(tree, probe, count, 0, 0),
+                      expected));
+  }
+  barnes_hut_free(tree);
+  free(positions);
+  free(masses);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_barnes_hut_empty)
+  DO_TEST(test_barnes_hut_two_points)
+  DO_TEST(test_barnes_hut_exact)
+  DO_TEST(test_barnes_hut_approximate)
+  DO_TEST(test_barnes_hut_coincident)
+  DO_TEST(test_barnes_hut_rebuild)
+
+  puts("barnes_hut_test PASS");
+}
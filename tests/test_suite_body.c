@@ -248,6 +248,344 @@ void test_body_info_freer() {
   body_free(body);
 }
 
+void test_body_polygon() {
+  polygon_t *shape = polygon_init(4);
+  polygon_add(shape, (vector_t){1, 1});
+  polygon_add(shape, (vector_t){2, 1});
+  polygon_add(shape, (vector_t){2, 2});
+  polygon_add(shape, (vector_t){1, 2});
+  body_t *body = body_init_with_polygon(shape, 3, (rgb_color_t){0, 0, 0},
+                                        NULL, NULL);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){1.5, 1.5}));
+  body_set_centroid(body, (vector_t){0, 0});
+  polygon_t *copy = body_get_polygon(body);
+  assert(polygon_size(copy) == 4);
+  assert(vec_isclose(polygon_get(copy, 0), (vector_t){-0.5, -0.5}));
+  assert(vec_isclose(polygon_get(copy, 2), (vector_t){0.5, 0.5}));
+  polygon_free(copy);
+  body_free(body);
+}
+
+void test_body_lazy_shape() {
+  polygon_t *shape = polygon_init(4);
+  polygon_add(shape, (vector_t){-1, -1});
+  polygon_add(shape, (vector_t){+1, -1});
+  polygon_add(shape, (vector_t){+1, +1});
+  polygon_add(shape, (vector_t){-1, +1});
+  body_t *body = body_init_with_polygon(shape, 1, (rgb_color_t){0, 0, 0},
+                                        NULL, NULL);
+
+  // Many small moves are never applied to the vertices one at a time,
+  // so rotating back to 0 recovers the original shape exactly
+  for (int i = 0; i < 1000; i++) {
+    body_set_rotation(body, i * 0.01);
+    body_set_centroid(body, (vector_t){i, 2 * i});
+  }
+  body_set_rotation(body, 0);
+  polygon_t *world = body_get_polygon(body);
+  assert(vec_equal(polygon_get(world, 0), (vector_t){998, 1997}));
+  assert(vec_equal(polygon_get(world, 2), (vector_t){1000, 1999}));
+  polygon_free(world);
+
+  body_set_rotation(body, M_PI / 2);
+  world = body_get_polygon(body);
+  assert(vec_isclose(polygon_get(world, 0), (vector_t){1000, 1997}));
+  polygon_free(world);
+  body_free(body);
+}
+
+void test_body_view_shape() {
+  polygon_t *shape = polygon_init(3);
+  polygon_add(shape, (vector_t){+1, 0});
+  polygon_add(shape, (vector_t){0, +1});
+  polygon_add(shape, (vector_t){-1, 0});
+  body_t *body = body_init_with_polygon(shape, 1, (rgb_color_t){0, 0, 0},
+                                        NULL, NULL);
+  body_set_centroid(body, (vector_t){1, 2});
+  polygon_view_t view = body_view_shape(body);
+  assert(view.size == 3);
+  assert(vec_isclose(view.vertices[0], (vector_t){2, 5.0 / 3.0}));
+  assert(vec_isclose(view.vertices[1], (vector_t){1, 8.0 / 3.0}));
+
+  // A fresh view after moving the body sees the new position
+  body_set_centroid(body, (vector_t){3, 4});
+  view = body_view_shape(body);
+  assert(vec_isclose(view.vertices[2], (vector_t){2, 11.0 / 3.0}));
+  body_free(body);
+}
+
+void test_body_view_normals() {
+  polygon_t *shape = polygon_init(4);
+  polygon_add(shape, (vector_t){0, 0});
+  polygon_add(shape, (vector_t){2, 0});
+  polygon_add(shape, (vector_t){2, 1});
+  polygon_add(shape, (vector_t){0, 1});
+  body_t *body = body_init_with_polygon(shape, 1, (rgb_color_t){0, 0, 0},
+                                        NULL, NULL);
+  polygon_view_t normals = body_view_normals(body);
+  assert(normals.size == 4);
+  assert(vec_isclose(normals.vertices[0], (vector_t){0, 1}));
+  assert(vec_isclose(normals.vertices[1], (vector_t){-1, 0}));
+
+  // Moving the body leaves the normals alone; rotating it rotates them
+  body_set_centroid(body, (vector_t){10, 10});
+  normals = body_view_normals(body);
+  assert(vec_isclose(normals.vertices[0], (vector_t){0, 1}));
+  body_set_rotation(body, M_PI / 2);
+  normals = body_view_normals(body);
+  assert(vec_isclose(normals.vertices[0], (vector_t){-1, 0}));
+  assert(vec_isclose(normals.vertices[1], (vector_t){0, -1}));
+
+  // The normals still match the edges of the rotated shape
+  polygon_view_t view = body_view_shape(body);
+  vector_t expected[4];
+  vertices_edge_normals(view.vertices, view.size, expected);
+  for (size_t i = 0; i < 4; i++) {
+    assert(vec_isclose(normals.vertices[i], expected[i]));
+  }
+  body_free(body);
+}
+
+void test_body_circle() {
+  body_t *body = body_init_circle(2, (vector_t){1, 1}, 3,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(body_is_circle(body));
+  assert(body_get_radius(body) == 2);
+  assert(vec_equal(body_get_centroid(body), (vector_t){1, 1}));
+  assert(body_get_mass(body) == 3);
+  assert(body_view_normals(body).size == 0);
+  aabb_t bounds = body_get_bounds(body);
+  assert(vec_equal(bounds.min, (vector_t){-1, -1}));
+  assert(vec_equal(bounds.max, (vector_t){3, 3}));
+
+  // Asking for the vertices approximates the circle around its center
+  body_set_centroid(body, (vector_t){5, 0});
+  polygon_view_t view = body_view_shape(body);
+  assert(view.size > 8);
+  for (size_t i = 0; i < view.size; i++) {
+    assert(isclose(vec_norm(vec_subtract(view.vertices[i], (vector_t){5, 0})),
+                   2));
+  }
+  body_free(body);
+
+  polygon_t *shape = polygon_init(3);
+  polygon_add(shape, (vector_t){0, 0});
+  polygon_add(shape, (vector_t){1, 0});
+  polygon_add(shape, (vector_t){0, 1});
+  body = body_init_with_polygon(shape, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(!body_is_circle(body));
+  body_free(body);
+}
+
+void test_body_store() {
+  const size_t BODIES = 5;
+  const double DT = 0.1;
+  body_t *plain[BODIES];
+  body_t *stored[BODIES];
+  body_store_t *store = body_store_init();
+  for (size_t i = 0; i < BODIES; i++) {
+    double mass = i == 0 ? INFINITY : i;
+    vector_t center = {i, 2 * i};
+    plain[i] = body_init_circle(1, center, mass, (rgb_color_t){0, 0, 0}, NULL,
+                                NULL);
+    stored[i] = body_init_circle(1, center, mass, (rgb_color_t){0, 0, 0},
+                                 NULL, NULL);
+    body_set_velocity(plain[i], (vector_t){1, -1});
+    body_set_velocity(stored[i], (vector_t){1, -1});
+    body_store_attach(store, stored[i]);
+  }
+  assert(body_store_size(store) == BODIES);
+
+  // Stored bodies move exactly like plain ones, whether ticked one at a time
+  // or all at once, and keep moving the same way after others are detached
+  for (size_t step = 0; step < 20; step++) {
+    for (size_t i = 0; i < BODIES; i++) {
+      vector_t force = {step, i};
+      vector_t impulse = {i, -(double)step};
+      body_add_force(plain[i], force);
+      body_add_impulse(plain[i], impulse);
+      body_add_force(stored[i], force);
+      body_add_impulse(stored[i], impulse);
+      body_tick(plain[i], DT);
+    }
+    if (step % 2 == 0) {
+      body_store_tick(store, DT);
+      if (step > 10) {
+        body_tick(stored[1], DT);
+      }
+    } else {
+      for (size_t i = 0; i < BODIES; i++) {
+        body_tick(stored[i], DT);
+      }
+    }
+    if (step == 10) {
+      body_store_detach(stored[1]);
+      assert(body_store_size(store) == BODIES - 1);
+    }
+    for (size_t i = 0; i < BODIES; i++) {
+      assert(vec_equal(body_get_centroid(stored[i]),
+                       body_get_centroid(plain[i])));
+      assert(vec_equal(body_get_velocity(stored[i]),
+                       body_get_velocity(plain[i])));
+    }
+  }
+  assert(vec_isclose(body_get_centroid(stored[0]), (vector_t){2, -2}));
+
+  // The world shape follows moves made by the store
+  polygon_view_t view = body_view_shape(stored[2]);
+  vector_t centroid = body_get_centroid(stored[2]);
+  assert(isclose(vec_norm(vec_subtract(view.vertices[0], centroid)), 1));
+  body_store_tick(store, DT);
+  view = body_view_shape(stored[2]);
+  assert(!vec_equal(body_get_centroid(stored[2]), centroid));
+  assert(isclose(vec_norm(vec_subtract(view.vertices[0],
+                                       body_get_centroid(stored[2]))),
+                 1));
+
+  // Freeing a body detaches it, and freeing the store detaches the rest
+  body_free(stored[3]);
+  assert(body_store_size(store) == BODIES - 2);
+  vector_t last = body_get_centroid(stored[4]);
+  body_store_free(store);
+  assert(vec_equal(body_get_centroid(stored[4]), last));
+  for (size_t i = 0; i < BODIES; i++) {
+    body_free(plain[i]);
+    if (i != 3) {
+      body_free(stored[i]);
+    }
+  }
+}
+
+// Tests that a store keeps its static bodies out of the slots it ticks,
+// even as bodies change kind or are detached
+void test_body_store_static() {
+  const size_t BODIES = 6;
+  body_store_t *store = body_store_init();
+  body_t *bodies[BODIES];
+  for (size_t i = 0; i < BODIES; i++) {
+    bodies[i] = body_init_circle(1, (vector_t){i, 0}, 1,
+                                 (rgb_color_t){0, 0, 0}, NULL, NULL);
+    body_set_velocity(bodies[i], (vector_t){0, 1});
+    body_set_kind(bodies[i], i % 3 == 0   ? BODY_STATIC
+                             : i % 3 == 1 ? BODY_KINEMATIC
+                                          : BODY_DYNAMIC);
+    body_store_attach(store, bodies[i]);
+  }
+  assert(body_store_size(store) == BODIES);
+  assert(body_store_num_moving(store) == 4);
+
+  body_set_kind(bodies[1], BODY_STATIC);
+  body_set_kind(bodies[3], BODY_DYNAMIC);
+  body_set_velocity(bodies[3], (vector_t){0, 1});
+  body_store_detach(bodies[2]);
+  assert(body_store_num_moving(store) == 3);
+  body_store_tick(store, 1);
+  body_store_tick_range(store, 0, body_store_num_moving(store), 1);
+  for (size_t i = 0; i < BODIES; i++) {
+    double y = i == 1 || i == 2 || i == 0 ? 0 : 2;
+    assert(vec_equal(body_get_centroid(bodies[i]), (vector_t){i, y}));
+  }
+  body_store_free(store);
+  for (size_t i = 0; i < BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+void test_body_interpolation() {
+  body_t *body = body_init_circle(1, (vector_t){1, 2}, 1,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+  // A new body has not moved since its previous transform
+  assert(vec_equal(body_get_interpolated_centroid(body, 0.5),
+                   (vector_t){1, 2}));
+  body_save_transform(body);
+  body_set_centroid(body, (vector_t){3, 6});
+  body_set_rotation(body, 1);
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0),
+                     (vector_t){1, 2}));
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0.25),
+                     (vector_t){1.5, 3}));
+  assert(vec_isclose(body_get_interpolated_centroid(body, 1),
+                     (vector_t){3, 6}));
+  assert(isclose(body_get_interpolated_rotation(body, 0.5), 0.5));
+  body_save_transform(body);
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0),
+                     (vector_t){3, 6}));
+  assert(isclose(body_get_interpolated_rotation(body, 0), 1));
+  body_free(body);
+}
+
+void test_body_sleep() {
+  body_t *body = body_init_circle(1, (vector_t){1, 2}, 1,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(!body_is_sleeping(body));
+  body_set_velocity(body, (vector_t){1, 0});
+  body_set_rest_time(body, 2);
+  body_add_force(body, (vector_t){5, 5});
+  body_sleep(body);
+  assert(body_is_sleeping(body));
+  assert(vec_equal(body_get_velocity(body), VEC_ZERO));
+  assert(vec_equal(body_get_force(body), VEC_ZERO));
+
+  // A sleeping body ignores forces and does not move
+  body_add_force(body, (vector_t){5, 5});
+  body_add_impulse(body, (vector_t){1, 1});
+  body_tick(body, 1);
+  assert(vec_equal(body_get_centroid(body), (vector_t){1, 2}));
+  assert(vec_equal(body_get_force(body), VEC_ZERO));
+  assert(vec_equal(body_get_impulse(body), VEC_ZERO));
+
+  // Setting its velocity wakes it
+  body_set_velocity(body, (vector_t){1, 0});
+  assert(!body_is_sleeping(body));
+  assert(body_get_rest_time(body) == 0);
+  body_tick(body, 1);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){2, 2}));
+
+  // So does setting its rotation
+  body_sleep(body);
+  body_set_rotation(body, 1);
+  assert(!body_is_sleeping(body));
+  body_free(body);
+}
+
+void test_body_kind() {
+  body_t *body = body_init_circle(1, (vector_t){1, 2}, 2,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(body_get_kind(body) == BODY_DYNAMIC);
+  assert(body_get_inverse_mass(body) == 0.5);
+
+  // Kinematic bodies move with their velocity but ignore forces
+  body_set_velocity(body, (vector_t){1, 0});
+  body_add_force(body, (vector_t){3, 3});
+  body_set_kind(body, BODY_KINEMATIC);
+  assert(body_get_inverse_mass(body) == 0);
+  body_add_impulse(body, (vector_t){3, 3});
+  body_tick(body, 1);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){2, 2}));
+  assert(vec_equal(body_get_velocity(body), (vector_t){1, 0}));
+
+  // Static bodies stop and never move
+  body_set_kind(body, BODY_STATIC);
+  assert(vec_equal(body_get_velocity(body), VEC_ZERO));
+  body_set_velocity(body, (vector_t){1, 0});
+  body_add_force(body, (vector_t){3, 3});
+  body_tick(body, 1);
+  assert(vec_equal(body_get_centroid(body), (vector_t){2, 2}));
+  aabb_t bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){1, 1}));
+  assert(vec_isclose(bounds.max, (vector_t){3, 3}));
+
+  // but can still be placed, which updates their bounds
+  body_set_centroid(body, (vector_t){5, 5});
+  bounds = body_get_bounds(body);
+  assert(vec_isclose(bounds.min, (vector_t){4, 4}));
+  body_set_kind(body, BODY_DYNAMIC);
+  body_add_impulse(body, (vector_t){2, 0});
+  body_tick(body, 1);
+  assert(vec_isclose(body_get_velocity(body), (vector_t){1, 0}));
+  body_free(body);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -265,6 +603,16 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_remove)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
+  DO_TEST(test_body_polygon)
+  DO_TEST(test_body_lazy_shape)
+  DO_TEST(test_body_view_shape)
+  DO_TEST(test_body_view_normals)
+  DO_TEST(test_body_circle)
+  DO_TEST(test_body_store)
+  DO_TEST(test_body_store_static)
+  DO_TEST(test_body_interpolation)
+  DO_TEST(test_body_sleep)
+  DO_TEST(test_body_kind)
 
   puts("body_test PASS");
 }
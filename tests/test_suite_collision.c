@@ -1,4 +1,5 @@
 #include "collision.h"
+#include "polygon.h"
 #include "test_util.h"
 
 #include <assert.h>
@@ -35,6 +36,25 @@ void test_pair(bool colliding, vector_t verts1[], size_t num_verts1,
   list_t *shape1 = shape_from_verts(verts1, num_verts1);
   list_t *shape2 = shape_from_verts(verts2, num_verts2);
   assert(find_collision(shape1, shape2).collided == colliding);
+  assert(find_vertices_collision(verts1, num_verts1, verts2, num_verts2)
+             .collided == colliding);
+  vector_t *normals1 = malloc(sizeof(vector_t) * num_verts1);
+  vector_t *normals2 = malloc(sizeof(vector_t) * num_verts2);
+  vertices_edge_normals(verts1, num_verts1, normals1);
+  vertices_edge_normals(verts2, num_verts2, normals2);
+  assert(find_normals_collision(verts1, normals1, num_verts1, verts2, normals2,
+                                num_verts2, NULL)
+             .collided == colliding);
+  // Testing with a cache twice should agree both times
+  separating_axis_cache_t cache = {.has_axis = false};
+  for (int i = 0; i < 2; i++) {
+    assert(find_normals_collision(verts1, normals1, num_verts1, verts2,
+                                  normals2, num_verts2, &cache)
+               .collided == colliding);
+    assert(cache.has_axis);
+  }
+  free(normals1);
+  free(normals2);
   list_free(shape1);
   list_free(shape2);
 }
@@ -61,6 +81,75 @@ void test_noncolliding() {
             NUM_VERTS(NONCOLLIDING_PAIR2_VERTS2));
 }
 
+void test_circles() {
+  collision_info_t info = find_circles_collision((vector_t){0, 0}, 1,
+                                                 (vector_t){1.5, 0}, 1);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){1, 0}));
+  info = find_circles_collision((vector_t){0, 2}, 1, (vector_t){0, 0}, 1.5);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){0, -1}));
+  assert(!find_circles_collision((vector_t){0, 0}, 1, (vector_t){2, 2}, 1)
+              .collided);
+}
+
+void test_circle_polygon() {
+  vector_t square[] = {{0, 0}, {2, 0}, {2, 2}, {0, 2}};
+  vector_t normals[4];
+  vertices_edge_normals(square, 4, normals);
+
+  // Touching the left edge
+  collision_info_t info = find_circle_polygon_collision(
+      (vector_t){-0.5, 1}, 1, square, normals, 4, NULL);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){1, 0}));
+  // Near the corner, but outside it along the diagonal.
+  // The bounding boxes and every edge normal overlap, so only the axis from
+  // the closest vertex separates them.
+  assert(!find_circle_polygon_collision((vector_t){-0.8, -0.8}, 1, square,
+                                        normals, 4, NULL)
+              .collided);
+  // Inside the corner's reach
+  info = find_circle_polygon_collision((vector_t){-0.6, -0.6}, 1, square,
+                                       normals, 4, NULL);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){sqrt(0.5), sqrt(0.5)}));
+  // Far away
+  assert(!find_circle_polygon_collision((vector_t){5, 5}, 1, square, normals,
+                                        4, NULL)
+              .collided);
+}
+
+void test_separating_axis_cache() {
+  vector_t square1[] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  vector_t square2[] = {{3, 0}, {4, 0}, {4, 1}, {3, 1}};
+  vector_t normals1[4], normals2[4];
+  vertices_edge_normals(square1, 4, normals1);
+  vertices_edge_normals(square2, 4, normals2);
+
+  // A separated pair caches an axis that separates it
+  separating_axis_cache_t cache = {.has_axis = false};
+  assert(!find_normals_collision(square1, normals1, 4, square2, normals2, 4,
+                                 &cache)
+              .collided);
+  assert(cache.has_axis);
+  assert(isclose(fabs(cache.axis.x), 1));
+
+  // A stale cached axis must not change the collision axis that is found
+  vector_t overlapping[] = {{0.5, 0.8}, {1.5, 0.8}, {1.5, 1.8}, {0.5, 1.8}};
+  vector_t overlapping_normals[4];
+  vertices_edge_normals(overlapping, 4, overlapping_normals);
+  collision_info_t uncached = find_normals_collision(
+      square1, normals1, 4, overlapping, overlapping_normals, 4, NULL);
+  collision_info_t cached = find_normals_collision(
+      square1, normals1, 4, overlapping, overlapping_normals, 4, &cache);
+  assert(cached.collided && uncached.collided);
+  assert(vec_isclose(cached.axis, uncached.axis));
+  assert(isclose(fabs(cached.axis.y), 1));
+  // The minimum overlap axis is cached for next time
+  assert(vec_isclose(cache.axis, cached.axis));
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -72,6 +161,9 @@ int main(int argc, char *argv[]) {
 
   DO_TEST(test_colliding)
   DO_TEST(test_noncolliding)
+  DO_TEST(test_circles)
+  DO_TEST(test_circle_polygon)
+  DO_TEST(test_separating_axis_cache)
 
   puts("collision_test PASS");
 }
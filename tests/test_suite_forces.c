@@ -92,13 +92,18 @@ body_t *make_triangle_body() {
 }
 
 // Tests that destructive collisions remove bodies from the scene
-void test_collisions() {
+void check_collisions(bool use_grid, bool use_tree) {
   const double DT = 0.1;
   const double V = 1.23;
   const double SEPARATION_AT_COLLISION = 1.5;
   const int TICKS_TO_COLLISION = 10;
 
   scene_t *scene = scene_init();
+  if (use_grid) {
+    scene_enable_grid(scene, 1);
+  } else if (use_tree) {
+    scene_enable_aabb_tree(scene, 0.1);
+  }
   body_t *body1 = make_triangle_body();
   vector_t initial_separation = {
       SEPARATION_AT_COLLISION + V * DT * (TICKS_TO_COLLISION - 0.5), 0};
@@ -129,6 +134,34 @@ void test_collisions() {
   scene_free(scene);
 }
 
+void test_collisions() { check_collisions(false, false); }
+
+// Collisions should happen on the same ticks when the broad phase culls them
+void test_collisions_grid() { check_collisions(true, false); }
+void test_collisions_tree() { check_collisions(false, true); }
+
+// Tests a head-on elastic collision between two equal circles,
+// which should swap their velocities
+void test_circle_collision() {
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *body1 = body_init_circle(1, (vector_t){-2, 0}, 1,
+                                   (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_set_velocity(body1, (vector_t){1, 0});
+  scene_add_body(scene, body1);
+  body_t *body2 = body_init_circle(1, (vector_t){2, 0}, 1,
+                                   (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_set_velocity(body2, (vector_t){-1, 0});
+  scene_add_body(scene, body2);
+  create_physics_collision(scene, 1, body1, body2);
+  for (int i = 0; i < 300; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(vec_isclose(body_get_velocity(body1), (vector_t){-1, 0}));
+  assert(vec_isclose(body_get_velocity(body2), (vector_t){1, 0}));
+  scene_free(scene);
+}
+
 // Tests that force creators properly register their list of affected bodies.
 // If they don't, asan will report a heap-use-after-free failure.
 void test_forces_removed() {
@@ -150,6 +183,391 @@ void test_forces_removed() {
   scene_free(scene);
 }
 
+// Tests that an exact gravity field moves bodies like gravity between
+// every pair, and that it survives bodies being removed
+void test_gravity_field() {
+  const size_t BODIES = 20;
+  const double G = 10;
+  scene_t *pairwise = scene_init();
+  scene_t *field = scene_init();
+  create_gravity_field(field, G, 0);
+  for (size_t i = 0; i < BODIES; i++) {
+    vector_t centroid = {(i * 37) % 100, (i * 61) % 100};
+    body_t *body1 = body_init(make_shape(), 1 + i, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body1, centroid);
+    scene_add_body(pairwise, body1);
+    for (size_t j = 0; j < i; j++) {
+      create_newtonian_gravity(pairwise, G, body1,
+                               scene_get_body(pairwise, j));
+    }
+    body_t *body2 = body_init(make_shape(), 1 + i, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body2, centroid);
+    scene_add_body(field, body2);
+  }
+  // Bodies with infinite mass neither attract nor move
+  body_t *wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(field, wall);
+
+  for (size_t tick = 0; tick < 100; tick++) {
+    if (tick == 50) {
+      scene_remove_body(pairwise, 0);
+      scene_remove_body(field, 0);
+    }
+    scene_tick(pairwise, 0.01);
+    scene_tick(field, 0.01);
+  }
+  assert(scene_bodies(field) == BODIES);
+  for (size_t i = 0; i + 1 < BODIES; i++) {
+    assert(vec_within(1e-9, body_get_centroid(scene_get_body(field, i)),
+                      body_get_centroid(scene_get_body(pairwise, i))));
+  }
+  assert(vec_equal(body_get_centroid(wall), VEC_ZERO));
+  scene_free(pairwise);
+  scene_free(field);
+}
+
+/**
+ * A soft repulsion that fades out linearly to 0 at a distance of 3.
+ */
+vector_t soft_repulsion(body_t *body1, body_t *body2, vector_t offset,
+                        void *aux) {
+  double dist = vec_norm(offset);
+  assert(dist < 3);
+  double strength = *(double *)aux * (3 - dist) / dist;
+  return vec_multiply(-strength, offset);
+}
+
+typedef struct {
+  scene_t *scene;
+  double strength;
+} all_pairs_aux_t;
+
+// Applies soft_repulsion() between every pair of bodies in a scene
+void apply_all_pairs(void *aux) {
+  all_pairs_aux_t *all_pairs = aux;
+  size_t num_bodies = scene_bodies(all_pairs->scene);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body1 = scene_get_body(all_pairs->scene, i);
+    for (size_t j = i + 1; j < num_bodies; j++) {
+      body_t *body2 = scene_get_body(all_pairs->scene, j);
+      vector_t offset =
+          vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+      if (vec_norm(offset) < 3) {
+        vector_t force =
+            soft_repulsion(body1, body2, offset, &all_pairs->strength);
+        body_add_force(body1, force);
+        body_add_force(body2, vec_negate(force));
+      }
+    }
+  }
+}
+
+// Tests that a pair interaction with Verlet lists moves bodies exactly like
+// checking every pair every tick, including after bodies are removed
+void test_pair_interaction() {
+  const size_t BODIES = 200;
+  scene_t *all_pairs = scene_init();
+  all_pairs_aux_t all_pairs_aux = {all_pairs, 5};
+  scene_add_bodies_force_creator(all_pairs, apply_all_pairs, &all_pairs_aux,
+                                 NULL, NULL);
+  scene_t *verlet = scene_init();
+  double *strength = malloc(sizeof(double));
+  *strength = 5;
+  list_t *group = list_init(BODIES, NULL);
+  for (size_t i = 0; i < BODIES; i++) {
+    vector_t centroid = {(i * 37) % 50 * 1.3, (i * 61) % 40 * 1.1};
+    vector_t velocity = {(double)(i % 5) - 2, (double)(i % 3) - 1};
+    body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body1, centroid);
+    body_set_velocity(body1, velocity);
+    scene_add_body(all_pairs, body1);
+    body_t *body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body2, centroid);
+    body_set_velocity(body2, velocity);
+    scene_add_body(verlet, body2);
+    list_add(group, body2);
+  }
+  create_pair_interaction(verlet, group, 3, 0.5, soft_repulsion, strength,
+                          free);
+
+  for (size_t tick = 0; tick < 200; tick++) {
+    if (tick % 50 == 25) {
+      scene_remove_body(all_pairs, tick % BODIES);
+      scene_remove_body(verlet, tick % BODIES);
+    }
+    scene_tick(all_pairs, 0.01);
+    scene_tick(verlet, 0.01);
+  }
+  assert(scene_bodies(verlet) == BODIES - 4);
+  for (size_t i = 0; i < BODIES - 4; i++) {
+    assert(vec_within(1e-9, body_get_centroid(scene_get_body(verlet, i)),
+                      body_get_centroid(scene_get_body(all_pairs, i))));
+  }
+  scene_free(all_pairs);
+  scene_free(verlet);
+}
+
+// Tests that an explicit spring network with no rest length or damping
+// moves a mesh exactly like a create_spring() for every edge
+void test_spring_network_explicit() {
+  const size_t SIDE = 5;
+  const double K = 3;
+  scene_t *springs = scene_init();
+  scene_t *network_scene = scene_init();
+  list_t *group = list_init(SIDE * SIDE, NULL);
+  for (size_t i = 0; i < SIDE * SIDE; i++) {
+    vector_t centroid = {i % SIDE * 2 + i % 3 * 0.1, i / SIDE * 2};
+    double mass = i == 0 ? INFINITY : 1 + i % 4;
+    body_t *body1 = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body1, centroid);
+    scene_add_body(springs, body1);
+    body_t *body2 = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body2, centroid);
+    scene_add_body(network_scene, body2);
+    list_add(group, body2);
+  }
+  spring_network_t *network =
+      create_spring_network(network_scene, group, false);
+  for (size_t i = 0; i < SIDE * SIDE; i++) {
+    size_t neighbors[] = {i % SIDE + 1 < SIDE ? i + 1 : i, i + SIDE};
+    for (size_t j = 0; j < 2; j++) {
+      if (neighbors[j] != i && neighbors[j] < SIDE * SIDE) {
+        create_spring(springs, K, scene_get_body(springs, i),
+                      scene_get_body(springs, neighbors[j]));
+        spring_network_add(network, i, neighbors[j], K, 0, 0);
+      }
+    }
+  }
+  assert(spring_network_size(network) == 2 * SIDE * (SIDE - 1));
+
+  for (size_t tick = 0; tick < 1000; tick++) {
+    scene_tick(springs, 0.001);
+    scene_tick(network_scene, 0.001);
+  }
+  for (size_t i = 0; i < SIDE * SIDE; i++) {
+    assert(vec_within(1e-9, body_get_centroid(scene_get_body(springs, i)),
+                      body_get_centroid(scene_get_body(network_scene, i))));
+  }
+  scene_free(springs);
+  scene_free(network_scene);
+}
+
+/**
+ * Makes a scene holding a stiff hanging chain of bodies with unit rest
+ * lengths, with its bottom body pulled 1 to the side.
+ */
+scene_t *make_stiff_chain(size_t length, bool implicit) {
+  scene_t *scene = scene_init();
+  list_t *group = list_init(length, NULL);
+  for (size_t i = 0; i < length; i++) {
+    double mass = i == 0 ? INFINITY : 1;
+    body_t *body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){i + 1 == length ? 1 : 0, -(double)i});
+    scene_add_body(scene, body);
+    list_add(group, body);
+  }
+  spring_network_t *network = create_spring_network(scene, group, implicit);
+  for (size_t i = 0; i + 1 < length; i++) {
+    spring_network_add(network, i, i + 1, 1e4, 1, 1);
+  }
+  return scene;
+}
+
+// Tests that the implicit solver keeps a stiff chain together at a time step
+// where the explicit solver blows up
+void test_spring_network_implicit() {
+  const size_t LENGTH = 10;
+  const double DT = 0.05;
+  scene_t *explicit_chain = make_stiff_chain(LENGTH, false);
+  scene_t *implicit_chain = make_stiff_chain(LENGTH, true);
+  for (size_t tick = 0; tick < 200; tick++) {
+    scene_tick(explicit_chain, DT);
+    scene_tick(implicit_chain, DT);
+  }
+  body_t *explicit_end = scene_get_body(explicit_chain, LENGTH - 1);
+  assert(!(vec_norm(body_get_centroid(explicit_end)) < 1e3));
+  for (size_t i = 1; i < LENGTH; i++) {
+    vector_t centroid1 = body_get_centroid(scene_get_body(implicit_chain, i));
+    vector_t centroid2 =
+        body_get_centroid(scene_get_body(implicit_chain, i - 1));
+    assert(within(1e-3, vec_dist(centroid1, centroid2), 1));
+  }
+  scene_free(explicit_chain);
+  scene_free(implicit_chain);
+}
+
+// Tests that removing a body drops its springs and renumbers the others
+void test_spring_network_removal() {
+  scene_t *scene = scene_init();
+  list_t *group = list_init(4, NULL);
+  for (size_t i = 0; i < 4; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){i, 0});
+    scene_add_body(scene, body);
+    list_add(group, body);
+  }
+  spring_network_t *network = create_spring_network(scene, group, true);
+  spring_network_add(network, 0, 1, 1, 1, 0);
+  spring_network_add(network, 1, 2, 1, 1, 0);
+  spring_network_add(network, 2, 3, 1, 1, 0);
+  spring_network_add(network, 0, 3, 1, 3, 0);
+  body_t *body2 = scene_get_body(scene, 2);
+
+  scene_remove_body(scene, 1);
+  scene_tick(scene, 0.01);
+  assert(spring_network_size(network) == 2);
+  // The old body 2 is now body 1, and stretching a spring to it pulls it
+  spring_network_add(network, 0, 1, 100, 0, 0);
+  scene_tick(scene, 0.01);
+  assert(body_get_velocity(body2).x < 0);
+  assert(spring_network_size(network) == 3);
+  scene_free(scene);
+}
+
+// Tests that restoring a snapshot from before a body was removed puts its
+// springs back, and that springs added since are dropped with their body
+void test_spring_network_restore() {
+  scene_t *scene = scene_init();
+  list_t *group = list_init(3, NULL);
+  for (size_t i = 0; i < 3; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){i, 0});
+    scene_add_body(scene, body);
+    list_add(group, body);
+  }
+  spring_network_t *network = create_spring_network(scene, group, false);
+  spring_network_add(network, 0, 1, 1, 2, 0);
+  spring_network_add(network, 1, 2, 1, 2, 0);
+  scene_snapshot_t *snapshot = scene_snapshot_init(scene);
+  scene_snapshot(scene, snapshot);
+  scene_tick(scene, 0.01);
+  vector_t velocity = body_get_velocity(scene_get_body(scene, 2));
+
+  scene_remove_body(scene, 1);
+  scene_tick(scene, 0.01);
+  spring_network_add(network, 0, 1, 1, 2, 0);
+  assert(spring_network_size(network) == 1);
+
+  scene_restore(scene, snapshot);
+  assert(spring_network_size(network) == 2);
+  scene_tick(scene, 0.01);
+  assert(vec_equal(body_get_velocity(scene_get_body(scene, 2)), velocity));
+  scene_snapshot_free(snapshot);
+  scene_free(scene);
+}
+
+vector_t uniform_wind(vector_t position, void *aux) {
+  return *(vector_t *)aux;
+}
+
+// Tests that field forces act on exactly the bodies they select
+void test_field_forces() {
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *falling = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(falling, 1, UINT32_MAX);
+  body_t *other = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(other, 2, UINT32_MAX);
+  body_t *wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(wall, 1, UINT32_MAX);
+  scene_add_body(scene, falling);
+  scene_add_body(scene, other);
+  scene_add_body(scene, wall);
+  create_uniform_gravity(scene, (vector_t){0, -10}, 1);
+  vector_t *wind = malloc(sizeof(vector_t));
+  *wind = (vector_t){1, 0};
+  create_wind_field(scene, uniform_wind, 4, wind, free, 2);
+  scene_tick(scene, DT);
+  assert(vec_isclose(body_get_velocity(falling), (vector_t){0, -10 * DT}));
+  assert(vec_isclose(body_get_velocity(other), (vector_t){2 * DT, 0}));
+  assert(vec_equal(body_get_velocity(wall), VEC_ZERO));
+  scene_free(scene);
+
+  // Quadratic drag grows with speed
+  scene = scene_init();
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){3, 4});
+  scene_add_body(scene, body);
+  create_field_drag(scene, 0, 2, 0);
+  scene_tick(scene, DT);
+  assert(vec_isclose(body_get_velocity(body),
+                     (vector_t){3 - 30 * DT, 4 - 40 * DT}));
+  scene_free(scene);
+}
+
+// Tests that linear field drag on every body matches create_drag() on each
+void test_field_drag() {
+  const size_t BODIES = 50;
+  scene_t *per_body = scene_init();
+  scene_t *field = scene_init();
+  create_field_drag(field, 3, 0, 0);
+  for (size_t i = 0; i < BODIES; i++) {
+    vector_t velocity = {(double)i, 10 - (double)i};
+    body_t *body1 = body_init(make_shape(), 1 + i, (rgb_color_t){0, 0, 0});
+    body_set_velocity(body1, velocity);
+    scene_add_body(per_body, body1);
+    create_drag(per_body, 3, body1);
+    body_t *body2 = body_init(make_shape(), 1 + i, (rgb_color_t){0, 0, 0});
+    body_set_velocity(body2, velocity);
+    scene_add_body(field, body2);
+  }
+  for (size_t tick = 0; tick < 100; tick++) {
+    if (tick == 50) {
+      scene_remove_body(per_body, 7);
+      scene_remove_body(field, 7);
+    }
+    scene_tick(per_body, 0.01);
+    scene_tick(field, 0.01);
+  }
+  for (size_t i = 0; i < BODIES - 1; i++) {
+    assert(vec_equal(body_get_centroid(scene_get_body(per_body, i)),
+                     body_get_centroid(scene_get_body(field, i))));
+  }
+  scene_free(per_body);
+  scene_free(field);
+}
+
+// Makes a scene whose bodies get random impulses, and ticks it
+scene_t *make_random_impulse_scene(uint64_t seed) {
+  scene_t *scene = scene_init();
+  scene_set_seed(scene, seed);
+  for (size_t i = 0; i < 10; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, body);
+    create_random_impulse(scene, i == 0 ? 0 : 0.5, 2, body);
+  }
+  for (size_t tick = 0; tick < 20; tick++) {
+    assert(scene_get_tick(scene) == tick);
+    scene_tick(scene, 0.01);
+  }
+  return scene;
+}
+
+// Tests that random impulses are reproducible from the scene's seed
+void test_random_impulse() {
+  scene_t *scene1 = make_random_impulse_scene(1);
+  scene_t *scene2 = make_random_impulse_scene(1);
+  scene_t *scene3 = make_random_impulse_scene(2);
+  assert(scene_get_seed(scene1) == 1);
+
+  // A body with probability 0 is never pushed
+  assert(vec_equal(body_get_velocity(scene_get_body(scene1, 0)), VEC_ZERO));
+  bool any_different = false;
+  for (size_t i = 1; i < 10; i++) {
+    vector_t velocity = body_get_velocity(scene_get_body(scene1, i));
+    assert(vec_equal(velocity, body_get_velocity(scene_get_body(scene2, i))));
+    // Each tick adds at most 2 to each component, and only if it is drawn
+    assert(fabs(velocity.x) <= 40 && fabs(velocity.y) <= 40);
+    assert(!vec_equal(velocity, VEC_ZERO));
+    any_different |=
+        !vec_equal(velocity, body_get_velocity(scene_get_body(scene3, i)));
+  }
+  assert(any_different);
+  scene_free(scene1);
+  scene_free(scene2);
+  scene_free(scene3);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -162,7 +580,19 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_spring_sinusoid)
   DO_TEST(test_energy_conservation)
   DO_TEST(test_collisions)
+  DO_TEST(test_collisions_grid)
+  DO_TEST(test_collisions_tree)
+  DO_TEST(test_circle_collision)
   DO_TEST(test_forces_removed)
+  DO_TEST(test_gravity_field)
+  DO_TEST(test_pair_interaction)
+  DO_TEST(test_spring_network_explicit)
+  DO_TEST(test_spring_network_implicit)
+  DO_TEST(test_spring_network_removal)
+  DO_TEST(test_spring_network_restore)
+  DO_TEST(test_field_forces)
+  DO_TEST(test_field_drag)
+  DO_TEST(test_random_impulse)
 
   puts("forces_test PASS");
 }
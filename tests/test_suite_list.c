@@ -240,6 +240,63 @@ void test_null_values() {
   list_free(l);
 }
 
+int compare_vector_x(const void *v1, const void *v2) {
+  double x1 = (*(vector_t **)v1)->x;
+  double x2 = (*(vector_t **)v2)->x;
+  return (x1 > x2) - (x1 < x2);
+}
+
+void test_list_sort() {
+  list_t *l = list_init(4, free);
+  double xs[] = {3, -1, 2, 0, 5};
+  for (size_t i = 0; i < 5; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = (vector_t){xs[i], i};
+    list_add(l, v);
+  }
+  list_sort(l, compare_vector_x);
+  assert(list_size(l) == 5);
+  assert(vec_equal(*(vector_t *)list_get(l, 0), (vector_t){-1, 1}));
+  assert(vec_equal(*(vector_t *)list_get(l, 1), (vector_t){0, 3}));
+  assert(vec_equal(*(vector_t *)list_get(l, 2), (vector_t){2, 2}));
+  assert(vec_equal(*(vector_t *)list_get(l, 3), (vector_t){3, 0}));
+  assert(vec_equal(*(vector_t *)list_get(l, 4), (vector_t){5, 4}));
+  list_free(l);
+}
+
+bool keep_nonnegative_x(void *v, void *aux) {
+  size_t *calls = aux;
+  (*calls)++;
+  return ((vector_t *)v)->x >= 0;
+}
+
+void test_list_filter() {
+  // The rejected vectors are freed by the list's freer (checked by asan)
+  list_t *l = list_init(4, free);
+  double xs[] = {3, -1, 2, -4, -5, 0};
+  for (size_t i = 0; i < 6; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = (vector_t){xs[i], i};
+    list_add(l, v);
+  }
+  size_t calls = 0;
+  assert(list_filter(l, keep_nonnegative_x, &calls) == 3);
+  assert(calls == 6);
+  assert(list_size(l) == 3);
+  // The kept elements stay in order
+  assert(vec_equal(*(vector_t *)list_get(l, 0), (vector_t){3, 0}));
+  assert(vec_equal(*(vector_t *)list_get(l, 1), (vector_t){2, 2}));
+  assert(vec_equal(*(vector_t *)list_get(l, 2), (vector_t){0, 5}));
+
+  // The list is still usable afterwards
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){-7, 6};
+  list_add(l, v);
+  assert(list_filter(l, keep_nonnegative_x, &calls) == 1);
+  assert(list_size(l) == 3);
+  list_free(l);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -258,6 +315,8 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_full_add)
   DO_TEST(test_empty_remove)
   DO_TEST(test_null_values)
+  DO_TEST(test_list_sort)
+  DO_TEST(test_list_filter)
 
   puts("list_test PASS");
 }
@@ -0,0 +1,86 @@
+#include "pair_table.h"
+#include "test_util.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+void test_pair_table_empty() {
+  pair_table_t *table = pair_table_init(0, free);
+  int a, b;
+  assert(pair_table_size(table) == 0);
+  assert(pair_table_get(table, &a, &b) == NULL);
+  assert(pair_table_remove(table, &a, &b) == NULL);
+  pair_table_free(table);
+}
+
+void test_pair_table_unordered() {
+  pair_table_t *table = pair_table_init(4, NULL);
+  int a, b, c;
+  int value1 = 1, value2 = 2;
+  pair_table_put(table, &a, &b, &value1);
+  assert(pair_table_size(table) == 1);
+  assert(pair_table_get(table, &a, &b) == &value1);
+  assert(pair_table_get(table, &b, &a) == &value1);
+  assert(pair_table_get(table, &a, &c) == NULL);
+
+  // Putting the reversed pair replaces the value
+  pair_table_put(table, &b, &a, &value2);
+  assert(pair_table_size(table) == 1);
+  assert(pair_table_get(table, &a, &b) == &value2);
+  assert(pair_table_remove(table, &b, &a) == &value2);
+  assert(pair_table_size(table) == 0);
+  assert(pair_table_get(table, &a, &b) == NULL);
+  pair_table_free(table);
+}
+
+void test_pair_table_many() {
+  const size_t KEYS = 200;
+  int keys[KEYS];
+  pair_table_t *table = pair_table_init(0, free);
+
+  // Insert every pair (i, j) with i < j, growing the table many times
+  for (size_t i = 0; i < KEYS; i++) {
+    for (size_t j = i + 1; j < KEYS; j++) {
+      size_t *value = malloc(sizeof(*value));
+      *value = i * KEYS + j;
+      pair_table_put(table, &keys[j], &keys[i], value);
+    }
+  }
+  assert(pair_table_size(table) == KEYS * (KEYS - 1) / 2);
+
+  // Remove every pair with an even first key, then check what is left
+  for (size_t i = 0; i < KEYS; i += 2) {
+    for (size_t j = i + 1; j < KEYS; j++) {
+      size_t *value = pair_table_remove(table, &keys[i], &keys[j]);
+      assert(*value == i * KEYS + j);
+      free(value);
+    }
+  }
+  for (size_t i = 0; i < KEYS; i++) {
+    for (size_t j = i + 1; j < KEYS; j++) {
+      size_t *value = pair_table_get(table, &keys[i], &keys[j]);
+      if (i % 2 == 0) {
+        assert(value == NULL);
+      } else {
+        assert(*value == i * KEYS + j);
+      }
+    }
+  }
+  pair_table_free(table);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_pair_table_empty)
+  DO_TEST(test_pair_table_unordered)
+  DO_TEST(test_pair_table_many)
+
+  puts("pair_table_test PASS");
+}
@@ -219,6 +219,53 @@ void test_weird_rotate() {
   list_free(w);
 }
 
+void test_contiguous_polygon() {
+  list_t *w = make_weird();
+  polygon_t *polygon = polygon_from_list(w);
+  assert(polygon_size(polygon) == 5);
+  for (size_t i = 0; i < 5; i++) {
+    assert(vec_equal(polygon_get(polygon, i), *(vector_t *)list_get(w, i)));
+  }
+  vector_t *vertices = polygon_vertices(polygon);
+  assert(isclose(vertices_area(vertices, 5), 23));
+  assert(vec_isclose(vertices_centroid(vertices, 5),
+                     (vector_t){-223.0 / 138.0, -51.0 / 46.0}));
+
+  // Rotate 90 degrees around (0, 2), as in test_weird_rotate()
+  vertices_rotate(vertices, 5, M_PI / 2, (vector_t){0, 2});
+  assert(vec_isclose(polygon_get(polygon, 1), (vector_t){1, 6}));
+  assert(vec_isclose(polygon_get(polygon, 4), (vector_t){10, 1}));
+  vertices_translate(vertices, 5, (vector_t){-1, -1});
+  assert(vec_isclose(polygon_get(polygon, 0), (vector_t){1, 1}));
+  range_t proj = vertices_proj(vertices, 5, (vector_t){2, 0}, true);
+  assert(isclose(proj.min, -4) && isclose(proj.max, 9));
+
+  // The list adapter and the copies see the same vertices
+  list_t *copy_list = polygon_to_list(polygon);
+  polygon_t *copy = polygon_copy(polygon);
+  for (size_t i = 0; i < 5; i++) {
+    assert(vec_equal(*(vector_t *)list_get(copy_list, i),
+                     polygon_get(polygon, i)));
+    assert(vec_equal(polygon_get(copy, i), polygon_get(polygon, i)));
+  }
+  list_free(copy_list);
+  polygon_free(copy);
+  polygon_free(polygon);
+  list_free(w);
+}
+
+void test_polygon_add() {
+  polygon_t *polygon = polygon_init(0);
+  for (size_t i = 0; i < 100; i++) {
+    polygon_add(polygon, (vector_t){i, -(double)i});
+  }
+  assert(polygon_size(polygon) == 100);
+  for (size_t i = 0; i < 100; i++) {
+    assert(vec_equal(polygon_get(polygon, i), (vector_t){i, -(double)i}));
+  }
+  polygon_free(polygon);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests? True if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -240,6 +287,8 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_weird_area_centroid)
   DO_TEST(test_weird_translate)
   DO_TEST(test_weird_rotate)
+  DO_TEST(test_contiguous_polygon)
+  DO_TEST(test_polygon_add)
 
   puts("polygon_test PASS");
 }
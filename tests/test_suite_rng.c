@@ -0,0 +1,89 @@
+#include "rng.h"
+#include "test_util.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_rng_known_answers() {
+  // Philox4x32-10 test vectors from the Random123 library. rng_bits() packs
+  // the counter into the low words and the stream into the high words.
+  assert(rng_bits(0, 0, 0) == 0xe169c58d6627e8d5ull);
+  assert(rng_bits(UINT64_MAX, UINT64_MAX, UINT64_MAX) ==
+         0x41c83b0e408f276dull);
+  assert(rng_bits(0x299f31d0a4093822ull, 0x0370734413198a2eull,
+                  0x85a308d3243f6a88ull) == 0x94fdccebd16cfe09ull);
+}
+
+void test_rng_reproducible() {
+  rng_t rng = rng_init(42, 7);
+  for (uint64_t i = 0; i < 100; i++) {
+    rng_t copy = rng;
+    uint64_t bits = rng_next(&rng);
+    assert(bits == rng_bits(42, 7, i));
+    assert(rng_next(&copy) == bits);
+  }
+  assert(rng.counter == 100);
+
+  // Changing any of the seed, stream or counter changes the numbers
+  uint64_t bits = rng_bits(1, 2, 3);
+  assert(rng_bits(0, 2, 3) != bits);
+  assert(rng_bits(1, 0, 3) != bits);
+  assert(rng_bits(1, 2, 0) != bits);
+  assert(rng_bits(2, 1, 3) != bits);
+}
+
+void test_rng_uniform() {
+  const size_t DRAWS = 100000;
+  const size_t BUCKETS = 10;
+  size_t counts[10] = {0};
+  double sum = 0;
+  rng_t rng = rng_init(3, 0);
+  for (size_t i = 0; i < DRAWS; i++) {
+    double x = rng_next_double(&rng);
+    assert(0 <= x && x < 1);
+    sum += x;
+    counts[(size_t)(x * BUCKETS)]++;
+  }
+  assert(fabs(sum / DRAWS - 0.5) < 0.01);
+  for (size_t i = 0; i < BUCKETS; i++) {
+    assert(fabs((double)counts[i] / DRAWS - 1.0 / BUCKETS) < 0.01);
+  }
+}
+
+void test_rng_range_and_index() {
+  rng_t rng = rng_init(5, 1);
+  for (size_t i = 0; i < 1000; i++) {
+    double x = rng_next_range(&rng, -3, 2);
+    assert(-3 <= x && x < 2);
+  }
+  assert(rng_next_range(&rng, 4, 4) == 4);
+
+  size_t counts[3] = {0};
+  for (size_t i = 0; i < 30000; i++) {
+    size_t index = rng_next_index(&rng, 3);
+    assert(index < 3);
+    counts[index]++;
+  }
+  for (size_t i = 0; i < 3; i++) {
+    assert(counts[i] > 9000 && counts[i] < 11000);
+  }
+  assert(rng_next_index(&rng, 1) == 0);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_rng_known_answers)
+  DO_TEST(test_rng_reproducible)
+  DO_TEST(test_rng_uniform)
+  DO_TEST(test_rng_range_and_index)
+
+  puts("rng_test PASS");
+}
@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 void scene_get_first(void *scene) { scene_get_body(scene, 0); }
 void scene_remove_first(void *scene) { scene_remove_body(scene, 0); }
@@ -229,6 +230,1092 @@ void test_reaping() {
   scene_free(scene);
 }
 
+/*
+    This test checks that with a broad phase, a contact force is only
+    called while its bodies' bounding boxes overlap, and that its separator
+    is called once when they stop overlapping.
+*/
+typedef struct {
+  int contacts;
+  int separations;
+} contact_aux_t;
+
+void count_contact(void *aux) { ((contact_aux_t *)aux)->contacts++; }
+void count_separation(void *aux) { ((contact_aux_t *)aux)->separations++; }
+
+void check_contact_force(bool use_tree) {
+  scene_t *scene = scene_init();
+  if (use_tree) {
+    scene_enable_aabb_tree(scene, 0.5);
+  } else {
+    scene_enable_grid(scene, 2);
+  }
+  body_t *fixed = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, fixed);
+  body_t *moving = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(moving, (vector_t){-10, 0});
+  body_set_velocity(moving, (vector_t){1, 0});
+  scene_add_body(scene, moving);
+
+  contact_aux_t *contact_aux = malloc(sizeof(*contact_aux));
+  contact_aux->contacts = 0;
+  contact_aux->separations = 0;
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, fixed);
+  list_add(bodies, moving);
+  scene_add_contact_force_creator(scene, count_contact, count_separation,
+                                  contact_aux, bodies, free);
+
+  // The bounding boxes (with radius sqrt(2)) overlap while |x| < 2 sqrt(2)
+  for (int i = 0; i < 20; i++) {
+    double x = body_get_centroid(moving).x;
+    bool near = fabs(x) < 2 * sqrt(2);
+    int contacts = contact_aux->contacts;
+    scene_tick(scene, 1);
+    assert(contact_aux->contacts == contacts + (near ? 1 : 0));
+  }
+  assert(contact_aux->contacts == 5);
+  assert(contact_aux->separations == 1);
+
+  // Without a broad phase, the force runs every tick
+  scene_disable_broad_phase(scene);
+  scene_tick(scene, 1);
+  assert(contact_aux->contacts == 6);
+  scene_free(scene);
+}
+
+void test_contact_force_grid() { check_contact_force(false); }
+void test_contact_force_tree() { check_contact_force(true); }
+
+/*
+    This test removes many bodies in one tick and checks that the survivors
+    keep their order and that the broad phase still tracks them.
+*/
+void test_mass_removal() {
+  const size_t BODIES = 100;
+  scene_t *scene = scene_init();
+  scene_enable_aabb_tree(scene, 0.1);
+  for (size_t i = 0; i < BODIES; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){3 * i, 0});
+    scene_add_body(scene, body);
+  }
+  // A contact force between two bodies that survive, made to touch
+  contact_aux_t *contact_aux = malloc(sizeof(*contact_aux));
+  contact_aux->contacts = 0;
+  contact_aux->separations = 0;
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, scene_get_body(scene, 1));
+  list_add(bodies, scene_get_body(scene, 3));
+  scene_add_contact_force_creator(scene, count_contact, count_separation,
+                                  contact_aux, bodies, free);
+  body_set_centroid(scene_get_body(scene, 3), (vector_t){4, 0});
+
+  for (size_t i = 0; i < BODIES; i += 2) {
+    scene_remove_body(scene, i);
+  }
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == BODIES / 2);
+  assert(contact_aux->contacts == 1);
+  for (size_t i = 0; i < BODIES / 2; i++) {
+    vector_t expected = {3 * (2 * i + 1), 0};
+    if (i == 1) {
+      expected.x = 4;
+    }
+    assert(vec_isclose(body_get_centroid(scene_get_body(scene, i)), expected));
+  }
+  scene_tick(scene, 1);
+  assert(contact_aux->contacts == 2);
+  scene_free(scene);
+}
+
+/*
+    This test checks that removing a body only removes the forces acting on
+    it, including ones added after other forces on the body were removed.
+*/
+void count_ticks(void *aux) { (*(int *)aux)++; }
+
+void test_remove_body_forces() {
+  scene_t *scene = scene_init();
+  body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+
+  int *counts = calloc(3, sizeof(int));
+  list_t *bodies = list_init(1, NULL);
+  list_add(bodies, body1);
+  scene_add_bodies_force_creator(scene, count_ticks, &counts[0], bodies, NULL);
+  bodies = list_init(1, NULL);
+  list_add(bodies, body2);
+  scene_add_bodies_force_creator(scene, count_ticks, &counts[1], bodies, NULL);
+  // A force on both bodies
+  bodies = list_init(2, NULL);
+  list_add(bodies, body2);
+  list_add(bodies, body1);
+  scene_add_bodies_force_creator(scene, count_ticks, &counts[2], bodies, NULL);
+
+  scene_tick(scene, 1);
+  scene_remove_body(scene, 0);
+  for (int i = 0; i < 3; i++) {
+    scene_tick(scene, 1);
+  }
+  // The removed body's forces ran on the tick it was removed, then stopped
+  assert(counts[0] == 2);
+  assert(counts[2] == 2);
+  assert(counts[1] == 4);
+  assert(scene_bodies(scene) == 1);
+
+  // body2's remaining force is still removed along with it
+  scene_remove_body(scene, 0);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(counts[1] == 5);
+  assert(scene_bodies(scene) == 0);
+  free(counts);
+  scene_free(scene);
+}
+
+void test_body_store() {
+  const size_t BODIES = 20;
+  const double DT = 1e-2;
+  const int STEPS = 200;
+  scene_t *scenes[2];
+  for (size_t s = 0; s < 2; s++) {
+    scenes[s] = scene_init();
+    if (s == 1) {
+      scene_enable_body_store(scenes[s]);
+    }
+    for (size_t i = 0; i < BODIES; i++) {
+      body_t *body = body_init(make_shape(), i + 1, (rgb_color_t){0, 0, 0});
+      body_set_centroid(body, (vector_t){3 * i, 0});
+      body_set_velocity(body, (vector_t){i, 1});
+      scene_add_body(scenes[s], body);
+    }
+    force_aux_t *gravity_aux = malloc(sizeof(*gravity_aux));
+    gravity_aux->scene = scenes[s];
+    gravity_aux->coefficient = 9.8;
+    scene_add_force_creator(scenes[s], constant_gravity, gravity_aux, free);
+    force_aux_t *drag_aux = malloc(sizeof(*drag_aux));
+    drag_aux->scene = scenes[s];
+    drag_aux->coefficient = 0.3;
+    scene_add_force_creator(scenes[s], air_drag, drag_aux, free);
+  }
+
+  // Bodies move exactly the same with and without the store,
+  // including as bodies are removed and added
+  for (int step = 0; step < STEPS; step++) {
+    for (size_t s = 0; s < 2; s++) {
+      if (step % 20 == 5) {
+        scene_remove_body(scenes[s], step % scene_bodies(scenes[s]));
+      }
+      if (step % 20 == 15) {
+        body_t *body = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+        body_set_velocity(body, (vector_t){1, 0});
+        scene_add_body(scenes[s], body);
+      }
+      scene_tick(scenes[s], DT);
+    }
+    if (step == STEPS / 2) {
+      // Enabling the store mid-run changes nothing either
+      scene_enable_body_store(scenes[0]);
+    }
+    assert(scene_bodies(scenes[0]) == scene_bodies(scenes[1]));
+    for (size_t i = 0; i < scene_bodies(scenes[0]); i++) {
+      body_t *body1 = scene_get_body(scenes[0], i);
+      body_t *body2 = scene_get_body(scenes[1], i);
+      assert(vec_equal(body_get_centroid(body1), body_get_centroid(body2)));
+      assert(vec_equal(body_get_velocity(body1), body_get_velocity(body2)));
+    }
+  }
+  scene_free(scenes[0]);
+  scene_free(scenes[1]);
+}
+
+void test_body_handles() {
+  const size_t BODIES = 10;
+  scene_t *scene = scene_init();
+  body_handle_t handles[BODIES];
+  for (size_t i = 0; i < BODIES; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    handles[i] = scene_add_body(scene, body);
+    assert(scene_get_body_by_handle(scene, handles[i]) == body);
+  }
+
+  // Handles keep referring to the same bodies as indices shift
+  scene_remove_body_by_handle(scene, handles[0]);
+  scene_remove_body(scene, 5);
+  body_t *body7 = scene_get_body(scene, 7);
+  assert(scene_get_body_by_handle(scene, handles[0]) != NULL);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == BODIES - 2);
+  assert(scene_get_body_by_handle(scene, handles[0]) == NULL);
+  assert(scene_get_body_by_handle(scene, handles[5]) == NULL);
+  assert(scene_get_body_by_handle(scene, handles[7]) == body7);
+  assert(scene_get_body(scene, 5) == body7);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_handle_t handle = scene_get_handle(scene, i);
+    assert(scene_get_body_by_handle(scene, handle) == scene_get_body(scene, i));
+  }
+
+  // Removing a stale handle does nothing, even once its slot is reused
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_handle_t handle = scene_add_body(scene, body);
+  scene_remove_body_by_handle(scene, handles[0]);
+  scene_remove_body_by_handle(scene, handles[5]);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == BODIES - 1);
+  assert(scene_get_body_by_handle(scene, handle) == body);
+  assert(scene_get_handle(scene, BODIES - 2).index == handle.index);
+  scene_free(scene);
+}
+
+typedef struct {
+  body_t *body1;
+  body_t *body2;
+  double k;
+} pair_aux_t;
+
+// A spring between two bodies, which only touches those bodies
+void pair_spring(void *aux) {
+  pair_aux_t *spring = aux;
+  vector_t stretch = vec_subtract(body_get_centroid(spring->body2),
+                                  body_get_centroid(spring->body1));
+  body_add_force(spring->body1, vec_multiply(spring->k, stretch));
+  body_add_force(spring->body2, vec_multiply(-spring->k, stretch));
+}
+
+/**
+ * Builds a chain of bodies joined by thread-safe springs, with a serial
+ * gravity force in the middle of the force list.
+ */
+scene_t *make_spring_chain(size_t bodies, size_t threads, bool use_store) {
+  scene_t *scene = scene_init();
+  scene_set_threads(scene, threads);
+  if (use_store) {
+    scene_enable_body_store(scene);
+  }
+  for (size_t i = 0; i < bodies; i++) {
+    body_t *body = body_init(make_shape(), 1 + i % 3, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){3 * i, i % 5});
+    scene_add_body(scene, body);
+  }
+  for (size_t i = 0; i + 1 < bodies; i++) {
+    if (i == bodies / 2) {
+      force_aux_t *gravity_aux = malloc(sizeof(*gravity_aux));
+      gravity_aux->scene = scene;
+      gravity_aux->coefficient = 9.8;
+      scene_add_force_creator(scene, constant_gravity, gravity_aux, free);
+    }
+    pair_aux_t *aux = malloc(sizeof(*aux));
+    aux->body1 = scene_get_body(scene, i);
+    aux->body2 = scene_get_body(scene, i + 1);
+    aux->k = 0.5;
+    list_t *bodies_list = list_init(2, NULL);
+    list_add(bodies_list, aux->body1);
+    list_add(bodies_list, aux->body2);
+    scene_add_parallel_force_creator(scene, pair_spring, aux, bodies_list,
+                                     free);
+  }
+  return scene;
+}
+
+void test_parallel_tick() {
+  const size_t BODIES = 3000;
+  const double DT = 1e-3;
+  const int STEPS = 50;
+  for (size_t use_store = 0; use_store < 2; use_store++) {
+    scene_t *serial = make_spring_chain(BODIES, 1, use_store);
+    scene_t *two = make_spring_chain(BODIES, 2, use_store);
+    scene_t *four = make_spring_chain(BODIES, 4, use_store);
+
+    // Bodies move exactly the same for any number of threads, and up to
+    // rounding the same as on one thread, including as bodies are removed
+    for (int step = 0; step < STEPS; step++) {
+      if (step % 10 == 3) {
+        scene_remove_body(serial, step);
+        scene_remove_body(two, step);
+        scene_remove_body(four, step);
+      }
+      scene_tick(serial, DT);
+      scene_tick(two, DT);
+      scene_tick(four, DT);
+      assert(scene_bodies(serial) == scene_bodies(four));
+      assert(scene_bodies(two) == scene_bodies(four));
+      for (size_t i = 0; i < scene_bodies(serial); i++) {
+        body_t *body1 = scene_get_body(serial, i);
+        body_t *body2 = scene_get_body(two, i);
+        body_t *body4 = scene_get_body(four, i);
+        assert(vec_equal(body_get_centroid(body2), body_get_centroid(body4)));
+        assert(vec_equal(body_get_velocity(body2), body_get_velocity(body4)));
+        assert(vec_isclose(body_get_centroid(body1), body_get_centroid(body4)));
+      }
+    }
+    scene_free(serial);
+    scene_free(two);
+    scene_free(four);
+  }
+}
+
+void test_fixed_step() {
+  const double STEP = 0.1;
+  scene_t *scene = scene_init();
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, (vector_t){5, 0});
+  body_set_velocity(body, (vector_t){1, 0});
+  scene_add_body(scene, body);
+
+  // Without a fixed step, every frame is one tick
+  assert(scene_advance(scene, 0.25) == 1);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){5.25, 0}));
+  assert(scene_get_interpolation(scene) == 1);
+
+  // Frame times are split into whole steps, carrying the remainder over
+  scene_set_fixed_step(scene, STEP, 4);
+  assert(scene_advance(scene, 0.05) == 0);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){5.25, 0}));
+  assert(isclose(scene_get_interpolation(scene), 0.5));
+  assert(scene_advance(scene, 0.2) == 2);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){5.45, 0}));
+  assert(isclose(scene_get_interpolation(scene), 0.5));
+  // The body is drawn between its last two steps
+  assert(vec_isclose(body_get_interpolated_centroid(body, 0.5),
+                     (vector_t){5.4, 0}));
+
+  // A long frame takes at most 4 steps and drops the rest of the time
+  assert(scene_advance(scene, 10) == 4);
+  assert(vec_isclose(body_get_centroid(body), (vector_t){5.85, 0}));
+  assert(scene_get_interpolation(scene) < 1);
+  scene_free(scene);
+}
+
+/*
+    This test checks that a spring-linked pair falls asleep only once both
+    bodies rest, that a body on its own island stays asleep while the pair is
+    disturbed, and that disturbing one body of the pair wakes both.
+*/
+void test_sleeping() {
+  const double DT = 0.1;
+  scene_t *scene = scene_init();
+  scene_enable_sleeping(scene, 0.01, 0.45);
+  for (size_t i = 0; i < 3; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){10 * i, 0});
+    scene_add_body(scene, body);
+  }
+  body_t *body1 = scene_get_body(scene, 0);
+  body_t *body2 = scene_get_body(scene, 1);
+  body_t *lone = scene_get_body(scene, 2);
+  pair_aux_t *aux = malloc(sizeof(*aux));
+  aux->body1 = body1;
+  aux->body2 = body2;
+  aux->k = 0;
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body1);
+  list_add(bodies, body2);
+  scene_add_bodies_force_creator(scene, pair_spring, aux, bodies, free);
+
+  // body2 keeps the pair awake while it moves
+  body_set_velocity(body2, (vector_t){1, 0});
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(!body_is_sleeping(body1));
+  assert(!body_is_sleeping(body2));
+  assert(body_is_sleeping(lone));
+
+  // Once body2 stops, the pair falls asleep after the delay
+  body_set_velocity(body2, VEC_ZERO);
+  for (int i = 0; i < 4; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(!body_is_sleeping(body1));
+  scene_tick(scene, DT);
+  assert(body_is_sleeping(body1));
+  assert(body_is_sleeping(body2));
+  vector_t rest = body_get_centroid(body2);
+  scene_tick(scene, DT);
+  assert(vec_equal(body_get_centroid(body2), rest));
+
+  // An impulse on body2 wakes the whole island, but not the lone body
+  body_add_impulse(body2, (vector_t){1, 0});
+  scene_tick(scene, DT);
+  assert(!body_is_sleeping(body1));
+  assert(!body_is_sleeping(body2));
+  assert(body_is_sleeping(lone));
+  assert(vec_isclose(body_get_centroid(body2),
+                     vec_add(rest, (vector_t){0.05, 0})));
+
+  scene_disable_sleeping(scene);
+  assert(!body_is_sleeping(lone));
+  scene_free(scene);
+}
+
+/*
+    This test checks that a contact force between sleeping bodies is skipped
+    without separating them.
+*/
+void test_sleeping_contact() {
+  scene_t *scene = scene_init();
+  scene_enable_grid(scene, 2);
+  scene_enable_sleeping(scene, 0.01, 0.45);
+  body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body1);
+  body_t *body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body2, (vector_t){1, 0});
+  scene_add_body(scene, body2);
+  contact_aux_t *contact_aux = malloc(sizeof(*contact_aux));
+  contact_aux->contacts = 0;
+  contact_aux->separations = 0;
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body1);
+  list_add(bodies, body2);
+  scene_add_contact_force_creator(scene, count_contact, count_separation,
+                                  contact_aux, bodies, free);
+
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, 0.1);
+  }
+  assert(body_is_sleeping(body1));
+  assert(body_is_sleeping(body2));
+  assert(contact_aux->contacts == 5);
+  assert(contact_aux->separations == 0);
+
+  // Waking either body runs the contact again
+  body_set_velocity(body1, (vector_t){0.5, 0});
+  scene_tick(scene, 0.1);
+  assert(contact_aux->contacts == 6);
+  assert(!body_is_sleeping(body1));
+  assert(body_is_sleeping(body2));
+  scene_free(scene);
+}
+
+/*
+    This test checks that a kinematic body moving slower than the sleep
+    threshold never falls asleep and keeps its velocity.
+*/
+void test_sleeping_kinematic() {
+  const double DT = 0.1;
+  scene_t *scene = scene_init();
+  scene_enable_sleeping(scene, 0.01, 0.45);
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_kind(body, BODY_KINEMATIC);
+  body_set_velocity(body, (vector_t){0.005, 0});
+  scene_add_body(scene, body);
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(!body_is_sleeping(body));
+  assert(vec_equal(body_get_velocity(body), (vector_t){0.005, 0}));
+  assert(vec_isclose(body_get_centroid(body), (vector_t){0.005, 0}));
+
+  // Putting it to sleep directly does nothing either
+  body_sleep(body);
+  assert(!body_is_sleeping(body));
+  assert(vec_equal(body_get_velocity(body), (vector_t){0.005, 0}));
+  scene_free(scene);
+}
+
+/*
+    This test checks that static bodies are never integrated, even in a body
+    store, and that contacts between two static bodies are never checked.
+*/
+void test_static_bodies() {
+  for (size_t use_store = 0; use_store < 2; use_store++) {
+    scene_t *scene = scene_init();
+    scene_enable_aabb_tree(scene, 0.5);
+    if (use_store) {
+      scene_enable_body_store(scene);
+    }
+    body_t *wall1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_kind(wall1, BODY_STATIC);
+    scene_add_body(scene, wall1);
+    body_t *wall2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(wall2, (vector_t){1, 0});
+    body_set_kind(wall2, BODY_STATIC);
+    scene_add_body(scene, wall2);
+    body_t *ball = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(ball, (vector_t){0, 1});
+    scene_add_body(scene, ball);
+
+    contact_aux_t *walls_aux = calloc(1, sizeof(*walls_aux));
+    list_t *bodies = list_init(2, NULL);
+    list_add(bodies, wall1);
+    list_add(bodies, wall2);
+    scene_add_contact_force_creator(scene, count_contact, count_separation,
+                                    walls_aux, bodies, free);
+    contact_aux_t *ball_aux = calloc(1, sizeof(*ball_aux));
+    bodies = list_init(2, NULL);
+    list_add(bodies, wall1);
+    list_add(bodies, ball);
+    scene_add_contact_force_creator(scene, count_contact, count_separation,
+                                    ball_aux, bodies, free);
+    force_aux_t *gravity_aux = malloc(sizeof(*gravity_aux));
+    gravity_aux->scene = scene;
+    gravity_aux->coefficient = 1;
+    scene_add_force_creator(scene, constant_gravity, gravity_aux, free);
+
+    scene_tick(scene, 0.1);
+    assert(walls_aux->contacts == 0);
+    assert(ball_aux->contacts == 1);
+    assert(vec_equal(body_get_centroid(wall1), VEC_ZERO));
+    assert(vec_equal(body_get_centroid(wall2), (vector_t){1, 0}));
+    assert(body_get_centroid(ball).y < 1);
+
+    // Without a broad phase, the force is skipped the same way
+    scene_disable_broad_phase(scene);
+    scene_tick(scene, 0.1);
+    assert(walls_aux->contacts == 0);
+    assert(ball_aux->contacts == 2);
+    scene_free(scene);
+  }
+}
+
+/*
+    This test registers collision handlers by category and checks that each
+    runs once per collision, with its bodies in the registered order, only
+    for pairs whose filters allow it, and never for two static bodies.
+*/
+typedef struct {
+  size_t calls;
+  body_t *last_body1;
+  vector_t last_axis;
+} handler_aux_t;
+
+void count_collision(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  handler_aux_t *handler_aux = aux;
+  handler_aux->calls++;
+  handler_aux->last_body1 = body1;
+  handler_aux->last_axis = axis;
+}
+
+void check_collision_handlers(int broad_phase) {
+  const uint32_t SHIPS = 1 << 0, ROCKS = 1 << 1, GHOSTS = 1 << 2;
+  scene_t *scene = scene_init();
+  if (broad_phase == 1) {
+    scene_enable_grid(scene, 2);
+  } else if (broad_phase == 2) {
+    scene_enable_aabb_tree(scene, 0.5);
+  }
+  body_t *ship = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(ship, SHIPS, UINT32_MAX);
+  scene_add_body(scene, ship);
+  body_t *rock = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(rock, (vector_t){-1.5, 0});
+  body_set_collision_filter(rock, ROCKS, UINT32_MAX);
+  scene_add_body(scene, rock);
+  // The ghost overlaps the ship, but its mask ignores ships
+  body_t *ghost = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_collision_filter(ghost, GHOSTS, ROCKS);
+  scene_add_body(scene, ghost);
+  // Two overlapping static rocks are never tested
+  for (size_t i = 0; i < 2; i++) {
+    body_t *wall = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(wall, (vector_t){20, i});
+    body_set_kind(wall, BODY_STATIC);
+    body_set_collision_filter(wall, ROCKS, UINT32_MAX);
+    scene_add_body(scene, wall);
+  }
+
+  handler_aux_t *ship_rock = calloc(1, sizeof(*ship_rock));
+  handler_aux_t *ghost_ship = calloc(1, sizeof(*ghost_ship));
+  handler_aux_t *rock_rock = calloc(1, sizeof(*rock_rock));
+  scene_add_collision_handler(scene, SHIPS, ROCKS, count_collision, ship_rock,
+                              free);
+  scene_add_collision_handler(scene, GHOSTS, SHIPS, count_collision,
+                              ghost_ship, free);
+  scene_add_collision_handler(scene, ROCKS, ROCKS, count_collision, rock_rock,
+                              free);
+
+  // The rock is added after the ship, but the ship is still passed first
+  scene_tick(scene, 0.1);
+  assert(ship_rock->calls == 1);
+  assert(ship_rock->last_body1 == ship);
+  assert(vec_isclose(ship_rock->last_axis, (vector_t){-1, 0}));
+  // Staying in contact does not call the handler again
+  scene_tick(scene, 0.1);
+  assert(ship_rock->calls == 1);
+
+  // Separating and touching again does
+  body_set_centroid(rock, (vector_t){-2.5, 0});
+  scene_tick(scene, 0.1);
+  assert(ship_rock->calls == 1);
+  body_set_centroid(rock, (vector_t){-1.5, 0});
+  scene_tick(scene, 0.1);
+  assert(ship_rock->calls == 2);
+  assert(ghost_ship->calls == 0);
+  assert(rock_rock->calls == 0);
+
+  // Removing a body forgets its contacts
+  body_remove(rock);
+  scene_tick(scene, 0.1);
+  assert(ship_rock->calls == 2);
+  scene_free(scene);
+}
+
+void test_collision_handlers() {
+  for (int broad_phase = 0; broad_phase < 3; broad_phase++) {
+    check_collision_handlers(broad_phase);
+  }
+}
+
+/*
+    This test checks the begin, persist and end events of a contact, and that
+    every pair is tested before any handler runs: a handler that removes a
+    body suppresses that body's later events in the same tick.
+*/
+typedef struct {
+  char log[64];
+  size_t length;
+} event_log_t;
+
+void log_event(body_t *body1, body_t *body2, collision_event_t event,
+               vector_t axis, void *aux) {
+  event_log_t *event_log = aux;
+  char code = event == COLLISION_BEGIN     ? 'b'
+              : event == COLLISION_PERSIST ? 'p'
+                                           : 'e';
+  event_log->log[event_log->length++] = code;
+  event_log->log[event_log->length] = '\0';
+}
+
+void remove_first(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  body_remove(body1);
+  (*(size_t *)aux)++;
+}
+
+void check_collision_events(size_t threads) {
+  const uint32_t SHIPS = 1 << 0, ROCKS = 1 << 1;
+  scene_t *scene = scene_init();
+  scene_set_threads(scene, threads);
+  scene_enable_aabb_tree(scene, 0.1);
+  body_t *ship = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(ship, (vector_t){-2.9, 0});
+  body_set_collision_filter(ship, SHIPS, UINT32_MAX);
+  body_set_velocity(ship, (vector_t){1, 0});
+  scene_add_body(scene, ship);
+  body_t *rock = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(rock, (vector_t){2.5, 0});
+  body_set_kind(rock, BODY_STATIC);
+  body_set_collision_filter(rock, ROCKS, UINT32_MAX);
+  scene_add_body(scene, rock);
+  event_log_t *event_log = calloc(1, sizeof(*event_log));
+  scene_add_collision_event_handler(scene, SHIPS, ROCKS,
+                                    COLLISION_BEGIN | COLLISION_PERSIST |
+                                        COLLISION_END,
+                                    log_event, event_log, free);
+
+  // The ship touches the rock while 0.5 < x < 4.5, which is true of the
+  // positions tested on 8 ticks
+  for (int i = 0; i < 20; i++) {
+    scene_tick(scene, 0.5);
+  }
+  assert(strcmp(event_log->log, "bpppppppe") == 0);
+  scene_free(scene);
+
+  // Two ships hit a mine in the same tick; the first handler removes the
+  // mine, so the second ship's event is dropped
+  scene = scene_init();
+  scene_set_threads(scene, threads);
+  scene_enable_grid(scene, 2);
+  for (size_t i = 0; i < 3; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){1.5 * i, 0});
+    body_set_collision_filter(body, i == 1 ? ROCKS : SHIPS, UINT32_MAX);
+    scene_add_body(scene, body);
+  }
+  size_t *removals = calloc(1, sizeof(*removals));
+  scene_add_collision_handler(scene, ROCKS, SHIPS, remove_first, removals,
+                              free);
+  scene_tick(scene, 0.1);
+  assert(*removals == 1);
+  assert(scene_bodies(scene) == 2);
+  scene_free(scene);
+}
+
+void test_collision_events() {
+  check_collision_events(1);
+  check_collision_events(4);
+}
+
+typedef struct {
+  list_t *bodies;
+  size_t sizes[4];
+  size_t calls;
+  bool freed;
+} group_aux_t;
+
+void record_group_size(void *aux) {
+  group_aux_t *group = aux;
+  assert(group->calls < 4);
+  group->sizes[group->calls++] = list_size(group->bodies);
+}
+
+void mark_group_freed(void *aux) { ((group_aux_t *)aux)->freed = true; }
+
+// Tests that a group force outlives its removed bodies, dropping each one at
+// the end of the tick it was removed in, and goes away with the last body
+void test_group_force() {
+  scene_t *scene = scene_init();
+  list_t *bodies = list_init(3, NULL);
+  for (size_t i = 0; i < 3; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, body);
+    list_add(bodies, body);
+  }
+  group_aux_t group = {bodies, {0}, 0, false};
+  scene_add_group_force_creator(scene, record_group_size, &group, bodies,
+                                mark_group_freed);
+
+  scene_tick(scene, 1);
+  scene_remove_body(scene, 1);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(!group.freed);
+  assert(list_get(bodies, 0) == scene_get_body(scene, 0));
+  assert(list_get(bodies, 1) == scene_get_body(scene, 1));
+
+  scene_remove_body(scene, 0);
+  scene_remove_body(scene, 1);
+  scene_tick(scene, 1);
+  assert(group.freed);
+  scene_tick(scene, 1);
+  assert(group.calls == 4);
+  assert(group.sizes[0] == 3 && group.sizes[1] == 3);
+  assert(group.sizes[2] == 2 && group.sizes[3] == 2);
+  assert(scene_bodies(scene) == 0);
+  scene_free(scene);
+}
+
+// Pushes each record's bodies along x by its constants
+void push_records(scene_t *scene, force_record_t *records, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    force_record_t *record = &records[i];
+    if (force_record_is_idle(record)) {
+      continue;
+    }
+    body_add_force(record->body1, (vector_t){record->constants[0], 0});
+    if (record->body2 != NULL) {
+      body_add_force(record->body2, (vector_t){record->constants[1], 0});
+    }
+  }
+}
+
+// Tests that force records run every tick until one of their bodies is
+// removed, and that they link their bodies into one island for sleeping
+void test_force_records() {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < 3; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){10 * i, 0});
+    scene_add_body(scene, body);
+  }
+  body_t *body0 = scene_get_body(scene, 0);
+  body_t *body1 = scene_get_body(scene, 1);
+  body_t *body2 = scene_get_body(scene, 2);
+  scene_add_force_record(scene, push_records,
+                         (force_record_t){.body1 = body0, .constants = {1}});
+  scene_add_force_record(
+      scene, push_records,
+      (force_record_t){.body1 = body1, .body2 = body2, .constants = {2, 3}});
+  scene_add_force_record(
+      scene, push_records,
+      (force_record_t){.body1 = body2, .body2 = body0, .constants = {0, 0}});
+
+  scene_tick(scene, 1);
+  assert(vec_equal(body_get_velocity(body0), (vector_t){1, 0}));
+  assert(vec_equal(body_get_velocity(body1), (vector_t){2, 0}));
+  assert(vec_equal(body_get_velocity(body2), (vector_t){3, 0}));
+
+  // body1's record still runs on the tick it is removed, then stops
+  scene_remove_body(scene, 1);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 2);
+  assert(vec_equal(body_get_velocity(body0), (vector_t){3, 0}));
+  assert(vec_equal(body_get_velocity(body2), (vector_t){6, 0}));
+  scene_free(scene);
+
+  // Removing a body moves the last record into its record's place, and that
+  // record is still dropped with its own body
+  scene = scene_init();
+  body_t *bodies[4];
+  for (size_t i = 0; i < 4; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, bodies[i]);
+  }
+  force_record_t pair = {
+      .body1 = bodies[0], .body2 = bodies[1], .constants = {1, 1}};
+  scene_add_force_record(scene, push_records, pair);
+  for (size_t i = 2; i < 4; i++) {
+    force_record_t single = {.body1 = bodies[i], .constants = {1}};
+    scene_add_force_record(scene, push_records, single);
+  }
+  scene_remove_body(scene, 0);
+  scene_tick(scene, 1);
+  scene_remove_body(scene, 2);
+  scene_tick(scene, 1);
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == 2);
+  assert(vec_equal(body_get_velocity(bodies[1]), (vector_t){1, 0}));
+  assert(vec_equal(body_get_velocity(bodies[2]), (vector_t){3, 0}));
+  scene_free(scene);
+
+  // Two bodies sharing a record that applies no force sleep and wake together
+  scene = scene_init();
+  scene_enable_sleeping(scene, 0.01, 0.45);
+  body0 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body0);
+  scene_add_body(scene, body1);
+  scene_add_force_record(
+      scene, push_records,
+      (force_record_t){.body1 = body0, .body2 = body1, .constants = {0, 0}});
+  for (int i = 0; i < 5; i++) {
+    scene_tick(scene, 0.1);
+  }
+  assert(body_is_sleeping(body0) && body_is_sleeping(body1));
+  body_add_impulse(body0, (vector_t){1, 0});
+  scene_tick(scene, 0.1);
+  assert(!body_is_sleeping(body0) && !body_is_sleeping(body1));
+  scene_free(scene);
+}
+
+bool handles_equal(body_handle_t handle1, body_handle_t handle2) {
+  return handle1.index == handle2.index &&
+         handle1.generation == handle2.generation;
+}
+
+// Tests that restoring a snapshot rewinds bodies, contact state and
+// registered force state, bringing back a body removed since
+void test_snapshot_restore() {
+  const uint32_t SHIPS = 1 << 0, ROCKS = 1 << 1;
+  scene_t *scene = scene_init();
+  scene_enable_aabb_tree(scene, 0.1);
+  body_t *ship = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(ship, (vector_t){-2.9, 0});
+  body_set_collision_filter(ship, SHIPS, UINT32_MAX);
+  body_set_velocity(ship, (vector_t){1, 0});
+  scene_add_body(scene, ship);
+  body_t *rock = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(rock, (vector_t){2.5, 0});
+  body_set_kind(rock, BODY_STATIC);
+  body_set_collision_filter(rock, ROCKS, UINT32_MAX);
+  scene_add_body(scene, rock);
+  event_log_t *event_log = calloc(1, sizeof(*event_log));
+  scene_add_collision_event_handler(scene, SHIPS, ROCKS,
+                                    COLLISION_BEGIN | COLLISION_PERSIST |
+                                        COLLISION_END,
+                                    log_event, event_log, free);
+  int ticks = 0;
+  scene_add_force_creator(scene, count_ticks, &ticks, NULL);
+  scene_add_force_state(scene, &ticks, &ticks, sizeof(ticks));
+
+  scene_snapshot_t *before = scene_snapshot_init(scene);
+  scene_snapshot_t *touching = scene_snapshot_init(scene);
+  for (int i = 0; i < 3; i++) {
+    scene_tick(scene, 0.5);
+  }
+  scene_snapshot(scene, before);
+  // The ship starts touching the rock on the 8th tick
+  for (int i = 0; i < 9; i++) {
+    scene_tick(scene, 0.5);
+  }
+  assert(strcmp(event_log->log, "bpppp") == 0);
+  vector_t centroid = body_get_centroid(ship);
+  scene_snapshot(scene, touching);
+
+  scene_restore(scene, before);
+  assert(scene_get_tick(scene) == 3);
+  assert(ticks == 3);
+  assert(vec_equal(body_get_centroid(ship), (vector_t){-1.4, 0}));
+  event_log->length = 0;
+  for (int i = 0; i < 9; i++) {
+    scene_tick(scene, 0.5);
+  }
+  assert(strcmp(event_log->log, "bpppp") == 0);
+  assert(vec_equal(body_get_centroid(ship), centroid));
+
+  // The restored pair is still touching, so the contact persists rather
+  // than beginning again
+  for (int i = 0; i < 4; i++) {
+    scene_tick(scene, 0.5);
+  }
+  assert(strcmp(event_log->log, "bpppppppe") == 0);
+  scene_restore(scene, touching);
+  event_log->length = 0;
+  scene_tick(scene, 0.5);
+  assert(strcmp(event_log->log, "p") == 0);
+
+  // A removed body comes back with its handle, and contacts it again
+  body_handle_t rock_handle = scene_get_handle(scene, 1);
+  scene_remove_body(scene, 1);
+  scene_tick(scene, 0.5);
+  assert(scene_bodies(scene) == 1);
+  assert(scene_get_body_by_handle(scene, rock_handle) == NULL);
+  scene_restore(scene, before);
+  assert(scene_bodies(scene) == 2);
+  assert(scene_get_body(scene, 1) == rock);
+  assert(handles_equal(scene_get_handle(scene, 1), rock_handle));
+  assert(scene_get_body_by_handle(scene, rock_handle) == rock);
+  assert(ticks == 3);
+  event_log->length = 0;
+  for (int i = 0; i < 9; i++) {
+    scene_tick(scene, 0.5);
+  }
+  assert(strcmp(event_log->log, "bpppp") == 0);
+
+  // A snapshot may outlive its scene
+  scene_snapshot_free(before);
+  scene_free(scene);
+  scene_snapshot_free(touching);
+}
+
+// Tests that freeing a scene frees the removed bodies and forces a snapshot
+// is keeping alive, whether the snapshot is freed before or after it
+void test_snapshot_free_retained() {
+  for (int snapshot_first = 0; snapshot_first < 2; snapshot_first++) {
+    scene_t *scene = scene_init();
+    body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_t *body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, body1);
+    scene_add_body(scene, body2);
+    list_t *bodies = list_init(1, NULL);
+    list_add(bodies, body1);
+    scene_add_bodies_force_creator(scene, count_ticks, calloc(1, sizeof(int)),
+                                   bodies, free);
+    bodies = list_init(2, NULL);
+    list_add(bodies, body1);
+    list_add(bodies, body2);
+    scene_add_bodies_force_creator(scene, count_ticks, calloc(1, sizeof(int)),
+                                   bodies, free);
+    scene_snapshot_t *snapshot = scene_snapshot_init(scene);
+    scene_snapshot(scene, snapshot);
+
+    body_remove(body1);
+    scene_tick(scene, 1);
+    assert(scene_bodies(scene) == 1);
+    if (snapshot_first) {
+      scene_snapshot_free(snapshot);
+      scene_free(scene);
+    } else {
+      scene_free(scene);
+      scene_snapshot_free(snapshot);
+    }
+  }
+}
+
+typedef struct {
+  event_log_t events;
+  // The ship in each event
+  body_t *ships[64];
+} contact_log_t;
+
+void log_contact(body_t *body1, body_t *body2, collision_event_t event,
+                 vector_t axis, void *aux) {
+  contact_log_t *contact_log = aux;
+  contact_log->ships[contact_log->events.length] = body1;
+  log_event(body1, body2, event, axis, &contact_log->events);
+}
+
+body_t *add_ship(scene_t *scene, vector_t centroid, vector_t velocity) {
+  body_t *ship = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(ship, centroid);
+  body_set_velocity(ship, velocity);
+  body_set_collision_filter(ship, 1 << 0, UINT32_MAX);
+  scene_add_body(scene, ship);
+  return ship;
+}
+
+// Tests that restoring across a body being added and another removed drops
+// the new body and brings back the removed one with its handle and force
+// record, so the same changes replay the same positions, handles and events
+void test_snapshot_restore_spawns() {
+  const uint32_t ROCKS = 1 << 1;
+  scene_t *scene = scene_init();
+  scene_enable_grid(scene, 2);
+  body_t *ships[3];
+  ships[0] = add_ship(scene, (vector_t){-2.9, 0}, (vector_t){1, 0});
+  ships[1] = add_ship(scene, (vector_t){-2.9, 5}, (vector_t){1, 0});
+  for (int i = 0; i < 2; i++) {
+    body_t *rock = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(rock, (vector_t){2.5, 5 * i});
+    body_set_kind(rock, BODY_STATIC);
+    body_set_collision_filter(rock, ROCKS, UINT32_MAX);
+    scene_add_body(scene, rock);
+  }
+  scene_add_force_record(scene, push_records,
+                         (force_record_t){.body1 = ships[1], .constants = {1}});
+  contact_log_t *contact_log = calloc(1, sizeof(*contact_log));
+  scene_add_collision_event_handler(scene, 1 << 0, ROCKS,
+                                    COLLISION_BEGIN | COLLISION_PERSIST |
+                                        COLLISION_END,
+                                    log_contact, contact_log, free);
+  body_handle_t handles[4];
+  for (size_t i = 0; i < 4; i++) {
+    handles[i] = scene_get_handle(scene, i);
+  }
+
+  scene_snapshot_t *snapshot = scene_snapshot_init(scene);
+  for (int i = 0; i < 3; i++) {
+    scene_tick(scene, 0.5);
+  }
+  scene_snapshot(scene, snapshot);
+
+  // A new ship rises into the lower rock while the upper ship is destroyed
+  scene_tick(scene, 0.5);
+  vector_t pushed = body_get_velocity(ships[1]);
+  ships[2] = add_ship(scene, (vector_t){2.5, -4.4}, (vector_t){0, 1});
+  body_handle_t new_handle = scene_get_handle(scene, 4);
+  scene_remove_body(scene, 1);
+  for (int i = 0; i < 8; i++) {
+    scene_tick(scene, 0.5);
+  }
+  contact_log_t first = *contact_log;
+  assert(strcmp(first.events.log, "bpbppppp") == 0);
+  assert(scene_bodies(scene) == 4);
+  vector_t centroids[4];
+  for (size_t i = 0; i < 4; i++) {
+    centroids[i] = body_get_centroid(scene_get_body(scene, i));
+  }
+
+  scene_restore(scene, snapshot);
+  assert(scene_get_tick(scene) == 3);
+  assert(scene_bodies(scene) == 4);
+  for (size_t i = 0; i < 4; i++) {
+    assert(handles_equal(scene_get_handle(scene, i), handles[i]));
+    body_t *body = scene_get_body(scene, i);
+    assert(scene_get_body_by_handle(scene, handles[i]) == body);
+  }
+  assert(scene_get_body(scene, 1) == ships[1]);
+  assert(scene_get_body_by_handle(scene, new_handle) == NULL);
+
+  // The upper ship's record was brought back with it
+  contact_log->events.length = 0;
+  scene_tick(scene, 0.5);
+  assert(vec_equal(body_get_velocity(ships[1]), pushed));
+  ships[2] = add_ship(scene, (vector_t){2.5, -4.4}, (vector_t){0, 1});
+  assert(handles_equal(scene_get_handle(scene, 4), new_handle));
+  scene_remove_body(scene, 1);
+  for (int i = 0; i < 8; i++) {
+    scene_tick(scene, 0.5);
+  }
+  assert(strcmp(contact_log->events.log, first.events.log) == 0);
+  for (size_t i = 0; i < 4; i++) {
+    assert(vec_equal(body_get_centroid(scene_get_body(scene, i)),
+                     centroids[i]));
+  }
+  assert(scene_get_body(scene, 3) == ships[2]);
+  assert(handles_equal(scene_get_handle(scene, 3), new_handle));
+  for (size_t i = 0; i < first.events.length; i++) {
+    body_t *ship = first.ships[i] == ships[0] ? ships[0] : ships[2];
+    assert(contact_log->ships[i] == ship);
+  }
+
+  scene_snapshot_free(snapshot);
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -243,6 +1330,25 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_contact_force_grid)
+  DO_TEST(test_contact_force_tree)
+  DO_TEST(test_mass_removal)
+  DO_TEST(test_remove_body_forces)
+  DO_TEST(test_body_store)
+  DO_TEST(test_body_handles)
+  DO_TEST(test_parallel_tick)
+  DO_TEST(test_fixed_step)
+  DO_TEST(test_sleeping)
+  DO_TEST(test_sleeping_contact)
+  DO_TEST(test_sleeping_kinematic)
+  DO_TEST(test_static_bodies)
+  DO_TEST(test_collision_handlers)
+  DO_TEST(test_collision_events)
+  DO_TEST(test_group_force)
+  DO_TEST(test_force_records)
+  DO_TEST(test_snapshot_restore)
+  DO_TEST(test_snapshot_restore_spawns)
+  DO_TEST(test_snapshot_free_retained)
 
   puts("scene_test PASS");
 }
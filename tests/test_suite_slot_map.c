@@ -0,0 +1,118 @@
+#include "slot_map.h"
+#include "test_util.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+void test_slot_map_empty() {
+  slot_map_t *map = slot_map_init(0);
+  assert(slot_map_size(map) == 0);
+  slot_handle_t none = {0, 0};
+  assert(slot_map_get(map, none) == NULL);
+  assert(slot_map_remove(map, none) == NULL);
+  slot_map_free(map);
+}
+
+void test_slot_map_stale() {
+  slot_map_t *map = slot_map_init(1);
+  int a, b;
+  slot_handle_t handle_a = slot_map_insert(map, &a);
+  assert(slot_map_size(map) == 1);
+  assert(slot_map_get(map, handle_a) == &a);
+  assert(slot_map_remove(map, handle_a) == &a);
+  assert(slot_map_size(map) == 0);
+  assert(slot_map_get(map, handle_a) == NULL);
+  assert(slot_map_remove(map, handle_a) == NULL);
+
+  // The freed slot is reused, but the old handle stays stale
+  slot_handle_t handle_b = slot_map_insert(map, &b);
+  assert(handle_b.index == handle_a.index);
+  assert(slot_map_get(map, handle_b) == &b);
+  assert(slot_map_get(map, handle_a) == NULL);
+  assert(slot_map_remove(map, handle_a) == NULL);
+  assert(slot_map_size(map) == 1);
+  slot_handle_t none = {0, 0};
+  assert(slot_map_get(map, none) == NULL);
+  slot_map_free(map);
+}
+
+void test_slot_map_many() {
+  const size_t VALUES = 1000;
+  size_t values[VALUES];
+  slot_handle_t handles[VALUES];
+  slot_map_t *map = slot_map_init(0);
+
+  // Insert every value, growing the map many times
+  for (size_t i = 0; i < VALUES; i++) {
+    values[i] = i;
+    handles[i] = slot_map_insert(map, &values[i]);
+  }
+  assert(slot_map_size(map) == VALUES);
+
+  // Remove every third value, then refill the freed slots
+  for (size_t i = 0; i < VALUES; i += 3) {
+    assert(slot_map_remove(map, handles[i]) == &values[i]);
+  }
+  for (size_t i = 0; i < VALUES; i++) {
+    size_t *value = slot_map_get(map, handles[i]);
+    if (i % 3 == 0) {
+      assert(value == NULL);
+    } else {
+      assert(*value == i);
+    }
+  }
+  for (size_t i = 0; i < VALUES; i += 3) {
+    handles[i] = slot_map_insert(map, &values[i]);
+  }
+  assert(slot_map_size(map) == VALUES);
+  for (size_t i = 0; i < VALUES; i++) {
+    assert(*(size_t *)slot_map_get(map, handles[i]) == i);
+  }
+  slot_map_free(map);
+}
+
+void test_slot_map_copy() {
+  slot_map_t *map = slot_map_init(1);
+  slot_map_t *copy = slot_map_init(0);
+  int a, b, c;
+  slot_handle_t handle_a = slot_map_insert(map, &a);
+  slot_handle_t handle_b = slot_map_insert(map, &b);
+  slot_map_remove(map, handle_a);
+  slot_map_copy(copy, map);
+
+  // Changing the original leaves the copy alone
+  slot_handle_t handle_c = slot_map_insert(map, &c);
+  slot_map_remove(map, handle_b);
+  assert(slot_map_size(copy) == 1);
+  assert(slot_map_get(copy, handle_a) == NULL);
+  assert(slot_map_get(copy, handle_b) == &b);
+  assert(slot_map_get(copy, handle_c) == NULL);
+
+  // Copying back restores the handles, and reuses slots in the same order
+  slot_map_copy(map, copy);
+  assert(slot_map_size(map) == 1);
+  assert(slot_map_get(map, handle_b) == &b);
+  assert(slot_map_get(map, handle_c) == NULL);
+  slot_handle_t again = slot_map_insert(map, &c);
+  assert(again.index == handle_c.index &&
+         again.generation == handle_c.generation);
+  slot_map_free(map);
+  slot_map_free(copy);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_slot_map_empty)
+  DO_TEST(test_slot_map_stale)
+  DO_TEST(test_slot_map_many)
+  DO_TEST(test_slot_map_copy)
+
+  puts("slot_map_test PASS");
+}
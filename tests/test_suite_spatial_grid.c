@@ -0,0 +1,92 @@
+#include "spatial_grid.h"
+#include "test_util.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * Records the pairs reported by spatial_grid_pairs() in a matrix.
+ */
+typedef struct {
+  size_t num_boxes;
+  int *counts;
+} pair_counts_t;
+
+void count_pair(size_t id1, size_t id2, void *aux) {
+  pair_counts_t *pairs = aux;
+  // Pairs should be reported with the earlier-inserted box first
+  assert(id1 < id2);
+  pairs->counts[id1 * pairs->num_boxes + id2]++;
+}
+
+void count_query(size_t id, void *aux) { ((int *)aux)[id]++; }
+
+aabb_t make_box(double x, double y, double width, double height) {
+  return (aabb_t){{x, y}, {x + width, y + height}};
+}
+
+void test_grid_empty() {
+  spatial_grid_t *grid = spatial_grid_init(1);
+  assert(spatial_grid_size(grid) == 0);
+  pair_counts_t pairs = {0, NULL};
+  spatial_grid_pairs(grid, count_pair, &pairs);
+  spatial_grid_free(grid);
+}
+
+// Compares the grid against checking every pair of boxes
+void test_grid_pairs() {
+  const size_t BOXES = 300;
+  const double CELL_SIZE = 10;
+  aabb_t boxes[BOXES];
+  spatial_grid_t *grid = spatial_grid_init(CELL_SIZE);
+  // Run twice to check that clearing the grid forgets the old boxes
+  for (int round = 0; round < 2; round++) {
+    spatial_grid_clear(grid);
+    for (size_t i = 0; i < BOXES; i++) {
+      double x = (double)rand() / RAND_MAX * 400 - 200;
+      double y = (double)rand() / RAND_MAX * 400 - 200;
+      double size = (double)rand() / RAND_MAX * 3 * CELL_SIZE;
+      boxes[i] = make_box(x, y, size, size);
+      // A few boxes large enough to skip the cells
+      if (i % 100 == 0) {
+        boxes[i] = make_box(x, y, 400, 400);
+      }
+      spatial_grid_insert(grid, i, boxes[i]);
+    }
+    assert(spatial_grid_size(grid) == BOXES);
+
+    pair_counts_t pairs = {BOXES, calloc(BOXES * BOXES, sizeof(int))};
+    spatial_grid_pairs(grid, count_pair, &pairs);
+    for (size_t i = 0; i < BOXES; i++) {
+      for (size_t j = i + 1; j < BOXES; j++) {
+        int expected = aabb_overlap(boxes[i], boxes[j]) ? 1 : 0;
+        assert(pairs.counts[i * BOXES + j] == expected);
+      }
+    }
+    free(pairs.counts);
+
+    aabb_t query = make_box(-25, -25, 50, 50);
+    int *hits = calloc(BOXES, sizeof(int));
+    spatial_grid_query(grid, query, count_query, hits);
+    for (size_t i = 0; i < BOXES; i++) {
+      assert(hits[i] == (aabb_overlap(query, boxes[i]) ? 1 : 0));
+    }
+    free(hits);
+  }
+  spatial_grid_free(grid);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_grid_empty)
+  DO_TEST(test_grid_pairs)
+
+  puts("spatial_grid_test PASS");
+}
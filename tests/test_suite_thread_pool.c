@@ -0,0 +1,96 @@
+#include "test_util.h"
+#include "thread_pool.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+typedef struct {
+  size_t *counts;
+  size_t grain;
+} count_aux_t;
+
+void count_iterations(void *aux, size_t start, size_t end) {
+  count_aux_t *count_aux = aux;
+  assert(start < end && end - start <= count_aux->grain);
+  for (size_t i = start; i < end; i++) {
+    count_aux->counts[i]++;
+  }
+}
+
+/**
+ * Checks that a loop runs every iteration exactly once.
+ */
+void check_loop(thread_pool_t *pool, size_t count, size_t grain) {
+  size_t *counts = calloc(count + 1, sizeof(size_t));
+  count_aux_t aux = {counts, grain};
+  thread_pool_for(pool, count, grain, count_iterations, &aux);
+  for (size_t i = 0; i < count; i++) {
+    assert(counts[i] == 1);
+  }
+  free(counts);
+}
+
+void test_thread_pool_serial() {
+  thread_pool_t *pool = thread_pool_init(1);
+  assert(thread_pool_threads(pool) == 1);
+  check_loop(pool, 0, 1);
+  check_loop(pool, 1, 1);
+  check_loop(pool, 1000, 7);
+  thread_pool_free(pool);
+}
+
+void test_thread_pool_loops() {
+  thread_pool_t *pool = thread_pool_init(4);
+  assert(thread_pool_threads(pool) == 4);
+  check_loop(pool, 0, 1);
+  check_loop(pool, 3, 1);
+  check_loop(pool, 10, 100);
+  // Many loops in a row reuse the same threads
+  for (size_t count = 0; count < 500; count++) {
+    check_loop(pool, count, 1 + count % 13);
+  }
+  thread_pool_free(pool);
+}
+
+void uneven_work(void *aux, size_t start, size_t end) {
+  double *results = aux;
+  for (size_t i = start; i < end; i++) {
+    // Later iterations take much longer, so threads must steal them
+    double sum = 0;
+    for (size_t j = 0; j < i * 100; j++) {
+      sum += 1.0 / (j + 1);
+    }
+    results[i] = sum;
+  }
+}
+
+void test_thread_pool_uneven() {
+  const size_t COUNT = 200;
+  thread_pool_t *pool = thread_pool_init(3);
+  double *results = malloc(sizeof(double) * COUNT);
+  thread_pool_for(pool, COUNT, 1, uneven_work, results);
+  double *expected = malloc(sizeof(double) * COUNT);
+  uneven_work(expected, 0, COUNT);
+  for (size_t i = 0; i < COUNT; i++) {
+    assert(results[i] == expected[i]);
+  }
+  free(results);
+  free(expected);
+  thread_pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_thread_pool_serial)
+  DO_TEST(test_thread_pool_loops)
+  DO_TEST(test_thread_pool_uneven)
+
+  puts("thread_pool_test PASS");
+}